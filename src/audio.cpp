@@ -0,0 +1,269 @@
+/**
+ * @file audio.cpp
+ * @brief Handles audio output
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "audio.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <SDL2/SDL.h>
+#include "fmt/core.h"
+#include "logger.hpp"
+#include "pacer.hpp"
+#include "emu/spscqueue.hpp"
+
+struct AudioFrame
+{
+    int16_t left;
+    int16_t right;
+};
+
+static_assert(sizeof(AudioFrame) == 2 * sizeof(int16_t));
+
+/**
+ * @brief Lets the pacer read the ring's fill level.
+ */
+class RingAudioClock : public AudioClockSource
+{
+public:
+    size_t getBufferedFrames(void) const noexcept override;
+    size_t getTargetFrames(void) const noexcept override;
+    int getSampleRate(void) const noexcept override;
+    uint64_t getUnderruns(void) const noexcept override;
+};
+
+SDL_AudioDeviceID audioDevice = 0;
+int deviceSampleRate = 0;
+
+// Written by the emulation thread, read by SDL's audio callback thread.
+// Neither side ever waits on the other.
+std::unique_ptr<SPSCQueue<AudioFrame>> audioRing;
+std::atomic<uint64_t> underruns{ 0 };
+
+size_t targetFrames = 0;
+bool playRequested = false;
+bool devicePlaying = false;
+
+RingAudioClock ringClock;
+
+void audioCallback(void* userdata, Uint8* stream, int length) noexcept;
+
+/**
+ * @brief Opens the default audio device, and attaches it to the pacer as
+ * the audio clock.
+ * @param sample_rate Requested rate. The device may pick another.
+ * @param latency_ms Buffered audio to aim for. The ring holds twice this.
+ * @returns false if no audio device could be opened.
+ */
+bool audioInit(int sample_rate, int latency_ms) noexcept
+{
+    if(audioIsOpen()) { audioExit(); }
+
+    if(SDL_InitSubSystem(SDL_INIT_AUDIO) != 0)
+    {
+        logMessage(fmt::format(
+            "Cannot initialize audio! Error: {}", SDL_GetError()
+        ), LOG_ERRORS);
+        return false;
+    }
+
+    // Device buffer of about a quarter of the latency, as a power of two
+    int device_frames = 256;
+    while(device_frames < 4096
+          && device_frames * 2 <= (sample_rate * latency_ms) / 4000)
+    {
+        device_frames *= 2;
+    }
+
+    SDL_AudioSpec desired{};
+    desired.freq = sample_rate;
+    desired.format = AUDIO_S16SYS;
+    desired.channels = 2;
+    desired.samples = static_cast<Uint16>(device_frames);
+    desired.callback = audioCallback;
+
+    SDL_AudioSpec obtained{};
+    audioDevice = SDL_OpenAudioDevice(
+        nullptr, 0, &desired, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE
+    );
+
+    if(audioDevice == 0)
+    {
+        logMessage(fmt::format(
+            "Cannot open audio device! Error: {}", SDL_GetError()
+        ), LOG_ERRORS);
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return false;
+    }
+
+    deviceSampleRate = obtained.freq;
+
+    // The device buffer is part of the latency, the ring makes up the rest.
+    size_t latency_frames =
+        static_cast<size_t>(deviceSampleRate) * latency_ms / 1000;
+    targetFrames = (latency_frames > obtained.samples * 2u)
+        ? latency_frames - obtained.samples
+        : obtained.samples;
+
+    audioRing = std::make_unique<SPSCQueue<AudioFrame>>(
+        (targetFrames * 2) + obtained.samples
+    );
+    underruns = 0;
+    playRequested = false;
+    devicePlaying = false;
+
+    pacerSetAudioClock(&ringClock);
+
+    logMessage(fmt::format(
+        "Audio opened. Rate: {} Hz - Device buffer: {} frames - "
+        "Target: {} frames ({}ms)",
+        deviceSampleRate, obtained.samples, targetFrames, latency_ms
+    ), LOG_INFO);
+
+    return true;
+}
+
+
+
+/**
+ * @brief Closes the audio device and detaches it from the pacer.
+ */
+void audioExit(void) noexcept
+{
+    if(!audioIsOpen()) { return; }
+
+    pacerSetAudioClock(nullptr);
+
+    // Closing waits for the callback to finish, so the ring can go after.
+    SDL_CloseAudioDevice(audioDevice);
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    audioDevice = 0;
+    deviceSampleRate = 0;
+    audioRing.reset();
+
+    logMessage("Audio closed.", LOG_INFO);
+}
+
+
+
+bool audioIsOpen(void) noexcept
+{
+    return audioDevice != 0;
+}
+
+
+
+/**
+ * @brief Stops or starts playback, e.g. while emulation is paused.
+ * Paused playback doesn't count underruns.
+ * @param paused
+ */
+void audioSetPaused(bool paused) noexcept
+{
+    if(!audioIsOpen()) { return; }
+
+    // Playback starts once the ring reaches its target, not straight away,
+    // so it doesn't begin with an underrun.
+    playRequested = !paused;
+    if(paused && devicePlaying)
+    {
+        SDL_PauseAudioDevice(audioDevice, 1);
+        devicePlaying = false;
+    }
+}
+
+
+
+/**
+ * @brief Queues interleaved 16-bit stereo frames for playback. Frames that
+ * don't fit are dropped. Never blocks.
+ * @param samples frames * 2 samples
+ * @param frames
+ * @returns Number of frames queued.
+ */
+size_t audioQueueFrames(const int16_t* samples, size_t frames) noexcept
+{
+    if(!audioIsOpen()) { return 0; }
+
+    size_t queued = audioRing->pushBulk(
+        reinterpret_cast<const AudioFrame*>(samples), frames
+    );
+
+    if(playRequested && !devicePlaying && audioRing->size() >= targetFrames)
+    {
+        SDL_PauseAudioDevice(audioDevice, 0);
+        devicePlaying = true;
+    }
+
+    return queued;
+}
+
+
+
+/**
+ * @brief Returns the device's actual sample rate, 0 if not open.
+ */
+int audioGetSampleRate(void) noexcept
+{
+    return deviceSampleRate;
+}
+
+
+
+/**
+ * @brief Returns the number of times playback ran out of queued audio.
+ */
+uint64_t audioGetUnderruns(void) noexcept
+{
+    return underruns.load(std::memory_order_relaxed);
+}
+
+
+
+/**
+ * @brief Fills SDL's buffer from the ring. Runs on SDL's audio thread, so
+ * it only touches the consumer side of the ring.
+ */
+void audioCallback(void* userdata, Uint8* stream, int length) noexcept
+{
+    AudioFrame* out = reinterpret_cast<AudioFrame*>(stream);
+    size_t frames = length / sizeof(AudioFrame);
+
+    size_t read = audioRing->popBulk(out, frames);
+    if(read < frames)
+    {
+        std::fill(out + read, out + frames, AudioFrame{ 0, 0 });
+        underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+
+
+size_t RingAudioClock::getBufferedFrames(void) const noexcept
+{
+    return (audioRing != nullptr) ? audioRing->size() : 0;
+}
+
+
+
+size_t RingAudioClock::getTargetFrames(void) const noexcept
+{
+    return targetFrames;
+}
+
+
+
+int RingAudioClock::getSampleRate(void) const noexcept
+{
+    return deviceSampleRate;
+}
+
+
+
+uint64_t RingAudioClock::getUnderruns(void) const noexcept
+{
+    return audioGetUnderruns();
+}
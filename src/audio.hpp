@@ -0,0 +1,55 @@
+/**
+ * @file audio.hpp
+ * @brief Handles audio output
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr int IMGBE_DEFAULT_AUDIO_LATENCY_MS = 50;
+
+/**
+ * @brief Opens the default audio device, and attaches it to the pacer as
+ * the audio clock.
+ * @param sample_rate Requested rate. The device may pick another.
+ * @param latency_ms Buffered audio to aim for. The ring holds twice this.
+ * @returns false if no audio device could be opened.
+ */
+bool audioInit(int sample_rate, int latency_ms) noexcept;
+
+/**
+ * @brief Closes the audio device and detaches it from the pacer.
+ */
+void audioExit(void) noexcept;
+
+bool audioIsOpen(void) noexcept;
+
+/**
+ * @brief Stops or starts playback, e.g. while emulation is paused.
+ * Paused playback doesn't count underruns.
+ * @param paused
+ */
+void audioSetPaused(bool paused) noexcept;
+
+/**
+ * @brief Queues interleaved 16-bit stereo frames for playback. Frames that
+ * don't fit are dropped. Never blocks.
+ * @param samples frames * 2 samples
+ * @param frames
+ * @returns Number of frames queued.
+ */
+size_t audioQueueFrames(const int16_t* samples, size_t frames) noexcept;
+
+/**
+ * @brief Returns the device's actual sample rate, 0 if not open.
+ */
+int audioGetSampleRate(void) noexcept;
+
+/**
+ * @brief Returns the number of times playback ran out of queued audio.
+ */
+uint64_t audioGetUnderruns(void) noexcept;
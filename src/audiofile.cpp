@@ -0,0 +1,270 @@
+/**
+ * @file audiofile.cpp
+ * @brief Writes audio output to WAV or raw PCM files
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "audiofile.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fmt/core.h>
+
+// Output frames per file write, 256 KiB
+constexpr size_t WRITE_BLOCK_FRAMES = 1 << 16;
+// Decimation filter length per unit of decimation
+constexpr unsigned int TAPS_PER_PHASE = 16;
+constexpr size_t WAV_HEADER_SIZE = 44;
+
+/**
+ * @brief Opens the output file.
+ * @param file_path
+ * @param sample_rate Rate of the written file, Hz.
+ * @param decimation Input is sample_rate * decimation Hz. 1 disables.
+ * @throws std::ios_base::failure on file error.
+ */
+AudioFileWriter::AudioFileWriter(
+    const std::filesystem::path& file_path,
+    int sample_rate,
+    unsigned int decimation
+) :
+    isWAV(file_path.extension() == ".wav" || file_path.extension() == ".WAV"),
+    sampleRate(sample_rate),
+    decimation(std::max(decimation, 1u))
+{
+    file.open(file_path, std::ios_base::out | std::ios_base::binary);
+    if(!file.is_open())
+    {
+        throw std::ios_base::failure(fmt::format(
+            "Cannot open file {}!", file_path.string()
+        ));
+    }
+
+    // Sizes are filled in on close.
+    if(isWAV) { writeWAVHeader(0); }
+
+    buffer.reserve(WRITE_BLOCK_FRAMES * 2);
+
+    if(this->decimation == 1) { return; }
+
+    // Windowed-sinc lowpass at 90% of the output Nyquist frequency
+    constexpr double PI = 3.14159265358979323846;
+    size_t tap_count = this->decimation * TAPS_PER_PHASE;
+    double cutoff = 0.45 / this->decimation;
+    double sum = 0;
+
+    taps.resize(tap_count);
+    for(size_t i = 0; i < tap_count; i++)
+    {
+        double x = i - ((tap_count - 1) / 2.0);
+        double sinc = (x == 0)
+            ? 1.0
+            : std::sin(2 * PI * cutoff * x) / (2 * PI * cutoff * x);
+        double window = 0.42
+            - (0.5 * std::cos((2 * PI * i) / (tap_count - 1)))
+            + (0.08 * std::cos((4 * PI * i) / (tap_count - 1)));
+
+        taps[i] = static_cast<float>(sinc * window);
+        sum += taps[i];
+    }
+
+    for(float& tap : taps)
+    {
+        tap = static_cast<float>(tap / sum);
+    }
+
+    for(auto& side : history)
+    {
+        side.assign(tap_count * 2, 0.0f);
+    }
+}
+
+AudioFileWriter::~AudioFileWriter()
+{
+    try
+    {
+        close();
+    } catch(std::exception&)
+    {}
+}
+
+
+
+/**
+ * @brief Adds interleaved stereo frames at the input rate.
+ * @param samples frames * 2 samples
+ * @param frames
+ * @throws std::ios_base::failure on file error.
+ */
+void AudioFileWriter::write(const int16_t* samples, size_t frames)
+{
+    if(!file.is_open()) { return; }
+
+    if(decimation == 1)
+    {
+        for(size_t i = 0; i < frames; i++)
+        {
+            pushFrame(samples[i * 2], samples[(i * 2) + 1]);
+        }
+        return;
+    }
+
+    size_t tap_count = taps.size();
+
+    for(size_t i = 0; i < frames; i++)
+    {
+        for(int side = 0; side < 2; side++)
+        {
+            float sample = samples[(i * 2) + side];
+            history[side][historyPos] = sample;
+            history[side][historyPos + tap_count] = sample;
+        }
+        historyPos = (historyPos + 1) % tap_count;
+
+        // Only every Nth output is ever needed, so only those get computed.
+        if(++phase < decimation) { continue; }
+        phase = 0;
+
+        int16_t out[2];
+        for(int side = 0; side < 2; side++)
+        {
+            const float* window = history[side].data() + historyPos;
+
+            // Independent sums let the adds pipeline.
+            // tap_count is always a multiple of 4.
+            float acc[4] = { 0, 0, 0, 0 };
+            for(size_t j = 0; j < tap_count; j += 4)
+            {
+                acc[0] += taps[j] * window[j];
+                acc[1] += taps[j + 1] * window[j + 1];
+                acc[2] += taps[j + 2] * window[j + 2];
+                acc[3] += taps[j + 3] * window[j + 3];
+            }
+
+            float sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+            out[side] = static_cast<int16_t>(
+                std::clamp(std::lround(sum), -32768L, 32767L)
+            );
+        }
+
+        pushFrame(out[0], out[1]);
+    }
+}
+
+
+
+/**
+ * @brief Writes anything buffered and finishes the WAV header. Called by the
+ * destructor if not called before.
+ * @throws std::ios_base::failure on file error.
+ */
+void AudioFileWriter::close(void)
+{
+    if(!file.is_open()) { return; }
+
+    flushBuffer();
+
+    if(isWAV)
+    {
+        file.seekp(0);
+        writeWAVHeader(static_cast<uint32_t>(std::min<uint64_t>(
+            framesWritten * 4, UINT32_MAX - WAV_HEADER_SIZE
+        )));
+    }
+
+    file.close();
+}
+
+
+
+/**
+ * @brief Returns the number of frames written to the file so far.
+ */
+uint64_t AudioFileWriter::getFramesWritten(void) const noexcept
+{
+    return framesWritten + (buffer.size() / 2);
+}
+
+
+
+void AudioFileWriter::pushFrame(int16_t left, int16_t right)
+{
+    buffer.push_back(left);
+    buffer.push_back(right);
+
+    if(buffer.size() >= WRITE_BLOCK_FRAMES * 2) { flushBuffer(); }
+}
+
+
+
+/**
+ * @brief Writes the buffered frames as little-endian 16-bit PCM.
+ * @throws std::ios_base::failure on file error.
+ */
+void AudioFileWriter::flushBuffer(void)
+{
+    if(buffer.empty()) { return; }
+
+    std::vector<char> bytes(buffer.size() * 2);
+    for(size_t i = 0; i < buffer.size(); i++)
+    {
+        uint16_t value = static_cast<uint16_t>(buffer[i]);
+        bytes[i * 2] = static_cast<char>(value & 0xFF);
+        bytes[(i * 2) + 1] = static_cast<char>(value >> 8);
+    }
+
+    file.write(bytes.data(), bytes.size());
+    if(!file)
+    {
+        throw std::ios_base::failure("Cannot write audio file!");
+    }
+
+    framesWritten += buffer.size() / 2;
+    buffer.clear();
+}
+
+
+
+/**
+ * @brief Writes a 44-byte PCM WAV header for 16-bit stereo.
+ * @param data_bytes Size of the sample data.
+ */
+void AudioFileWriter::writeWAVHeader(uint32_t data_bytes)
+{
+    char header[WAV_HEADER_SIZE];
+    size_t pos = 0;
+
+    auto put_tag = [&header, &pos](const char* tag)
+    {
+        std::copy(tag, tag + 4, header + pos);
+        pos += 4;
+    };
+
+    auto put_le = [&header, &pos](uint32_t value, int bytes)
+    {
+        for(int i = 0; i < bytes; i++)
+        {
+            header[pos++] = static_cast<char>((value >> (i * 8)) & 0xFF);
+        }
+    };
+
+    constexpr uint16_t CHANNELS = 2;
+    constexpr uint16_t BITS = 16;
+    constexpr uint16_t BLOCK_ALIGN = CHANNELS * (BITS / 8);
+
+    put_tag("RIFF");
+    put_le(static_cast<uint32_t>(WAV_HEADER_SIZE - 8) + data_bytes, 4);
+    put_tag("WAVE");
+    put_tag("fmt ");
+    put_le(16, 4);                                   // fmt chunk size
+    put_le(1, 2);                                    // PCM
+    put_le(CHANNELS, 2);
+    put_le(static_cast<uint32_t>(sampleRate), 4);
+    put_le(static_cast<uint32_t>(sampleRate) * BLOCK_ALIGN, 4);
+    put_le(BLOCK_ALIGN, 2);
+    put_le(BITS, 2);
+    put_tag("data");
+    put_le(data_bytes, 4);
+
+    file.write(header, sizeof(header));
+}
@@ -0,0 +1,80 @@
+/**
+ * @file audiofile.hpp
+ * @brief Writes audio output to WAV or raw PCM files
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+/**
+ * @brief Streams 16-bit stereo audio to a file, optionally decimating by an
+ * integer factor first. Files ending in .wav get a WAV header, anything
+ * else is written as raw little-endian PCM.
+ */
+class AudioFileWriter
+{
+public:
+    /**
+     * @brief Opens the output file.
+     * @param file_path
+     * @param sample_rate Rate of the written file, Hz.
+     * @param decimation Input is sample_rate * decimation Hz. 1 disables.
+     * @throws std::ios_base::failure on file error.
+     */
+    AudioFileWriter(
+        const std::filesystem::path& file_path,
+        int sample_rate,
+        unsigned int decimation = 1
+    );
+    ~AudioFileWriter();
+
+    AudioFileWriter(const AudioFileWriter&) = delete;
+    AudioFileWriter& operator=(const AudioFileWriter&) = delete;
+
+    /**
+     * @brief Adds interleaved stereo frames at the input rate.
+     * @param samples frames * 2 samples
+     * @param frames
+     * @throws std::ios_base::failure on file error.
+     */
+    void write(const int16_t* samples, size_t frames);
+
+    /**
+     * @brief Writes anything buffered and finishes the WAV header. Called
+     * by the destructor if not called before.
+     * @throws std::ios_base::failure on file error.
+     */
+    void close(void);
+
+    /**
+     * @brief Returns the number of frames written to the file so far.
+     */
+    uint64_t getFramesWritten(void) const noexcept;
+
+private:
+    std::ofstream file;
+    bool isWAV;
+    int sampleRate;
+    unsigned int decimation;
+
+    // Output frames are collected here and written in large blocks.
+    std::vector<int16_t> buffer;
+    uint64_t framesWritten = 0;
+
+    // Polyphase decimator: the FIR is only evaluated once per output
+    // frame, over a history duplicated so reads never wrap.
+    std::vector<float> taps;
+    std::vector<float> history[2];
+    size_t historyPos = 0;
+    unsigned int phase = 0;
+
+    void pushFrame(int16_t left, int16_t right);
+    void flushBuffer(void);
+    void writeWAVHeader(uint32_t data_bytes);
+};
@@ -0,0 +1,366 @@
+/**
+ * @file batch.cpp
+ * @brief Runs a manifest of headless jobs across every core in one process
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "batch.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <fmt/core.h>
+#include "logger.hpp"
+#include "workpool.hpp"
+
+namespace
+{
+
+// The log of the job running on this thread, if any
+thread_local std::ofstream* jobLog = nullptr;
+
+uint64_t parseManifestCount(const std::string& text)
+{
+    if(text.empty()
+       || text.find_first_not_of("0123456789") != std::string::npos)
+    {
+        throw std::invalid_argument(fmt::format("{} isn't a count", text));
+    }
+
+    try
+    {
+        return std::stoull(text);
+    } catch(std::out_of_range&)
+    {
+        throw std::out_of_range(fmt::format("{} is too large", text));
+    }
+}
+
+// Names of files and directories written under a job's directory, never a
+// path out of it.
+void checkPlainName(const char* what, const std::string& value)
+{
+    if(value == "." || value.find("..") != std::string::npos
+       || value.find_first_of("/\\:") != std::string::npos)
+    {
+        throw std::invalid_argument(fmt::format(
+            "{} {} must not be a path", what, value
+        ));
+    }
+}
+
+std::filesystem::path resolvePath(
+    const std::filesystem::path& base_dir,
+    const std::string& text
+)
+{
+    std::filesystem::path path = text;
+    return path.is_relative() ? base_dir / path : path;
+}
+
+/**
+ * @brief Sends messages logged while a job runs to that job's log, and
+ * everything else to the console.
+ */
+void logToJob(const std::string& msg, LOG_LEVELS level)
+{
+    if(jobLog != nullptr)
+    {
+        *jobLog << fmt::format("[{}] {}\n", getTimestamp(), msg);
+    } else if(level == LOG_ERRORS)
+    {
+        std::cerr << msg << std::endl;
+    } else
+    {
+        std::cout << msg << std::endl;
+    }
+}
+
+} // namespace
+
+
+
+/**
+ * @brief Reads a manifest of jobs, one per line:
+ *
+ *     <rom> <input file, or -> <frames> [key=value...]
+ *
+ * Keys are dump=N to write every Nth frame, audio=file and state=file to
+ * write audio or the final state into the job's directory, load=file to
+ * start from a save state, link=rom to link a second ROM, and name=dir to
+ * name the job's directory. Audio, state, and name must be plain names, not
+ * paths.
+ * Relative paths are from the manifest's directory, and paths with spaces
+ * can be quoted. '#' starts a comment line.
+ * @param manifest_path
+ * @param output_dir Where jobs' directories go.
+ * @throws std::ios_base::failure on file error.
+ * @throws std::runtime_error on invalid file contents.
+ */
+std::vector<BatchJob> loadManifest(
+    const std::filesystem::path& manifest_path,
+    const std::filesystem::path& output_dir
+)
+{
+    std::ifstream file(manifest_path);
+    if(!file.is_open())
+    {
+        throw std::ios_base::failure(fmt::format(
+            "Cannot open file {}!", manifest_path.string()
+        ));
+    }
+
+    std::filesystem::path base_dir = manifest_path.parent_path();
+    std::vector<BatchJob> jobs;
+    std::set<std::string> names;
+    std::string line;
+    size_t line_number = 0;
+
+    while(std::getline(file, line))
+    {
+        line_number++;
+
+        size_t start = line.find_first_not_of(" \t\r");
+        if(start == std::string::npos || line[start] == '#') { continue; }
+
+        std::istringstream fields(line);
+        std::string rom_text;
+        std::string input_text;
+        std::string frames_text;
+        fields
+            >> std::quoted(rom_text)
+            >> std::quoted(input_text)
+            >> std::quoted(frames_text);
+
+        try
+        {
+            if(frames_text.empty())
+            {
+                throw std::invalid_argument(
+                    "expected <rom> <input file, or -> <frames>"
+                );
+            }
+
+            BatchJob job;
+            HeadlessOptions& options = job.options;
+            options.romPath = resolvePath(base_dir, rom_text);
+            if(input_text != "-")
+            {
+                options.inputPath = resolvePath(base_dir, input_text);
+            }
+
+            // Every job needs an end, or one stuck game holds up the batch.
+            options.frames = parseManifestCount(frames_text);
+            if(options.frames == 0)
+            {
+                throw std::invalid_argument("frames must be at least 1");
+            }
+
+            job.name = fmt::format(
+                "{:04d}-{}", jobs.size() + 1, options.romPath.stem().string()
+            );
+
+            std::string state_name;
+            std::string field;
+            while(fields >> std::quoted(field))
+            {
+                size_t split = field.find('=');
+                if(split == std::string::npos || split + 1 == field.size())
+                {
+                    throw std::invalid_argument(fmt::format(
+                        "expected key=value, not {}", field
+                    ));
+                }
+
+                std::string key = field.substr(0, split);
+                std::string value = field.substr(split + 1);
+
+                if(key == "dump")
+                {
+                    uint64_t interval = parseManifestCount(value);
+                    if(interval > UINT32_MAX)
+                    {
+                        throw std::out_of_range("dump interval is too large");
+                    }
+                    options.dumpInterval = static_cast<unsigned int>(interval);
+                } else if(key == "audio")
+                {
+                    checkPlainName("audio file", value);
+                    options.audioPath = value;
+                } else if(key == "state")
+                {
+                    checkPlainName("state file", value);
+                    state_name = value;
+                } else if(key == "load")
+                {
+                    options.loadStatePath = resolvePath(base_dir, value);
+                } else if(key == "link")
+                {
+                    options.linkROMPath = resolvePath(base_dir, value);
+                } else if(key == "name")
+                {
+                    checkPlainName("job name", value);
+                    job.name = value;
+                } else
+                {
+                    throw std::invalid_argument(fmt::format(
+                        "unknown key {}", key
+                    ));
+                }
+            }
+
+            if(!names.insert(job.name).second)
+            {
+                throw std::invalid_argument(fmt::format(
+                    "job name {} is already used", job.name
+                ));
+            }
+
+            options.outputDir = output_dir / job.name;
+            if(!state_name.empty())
+            {
+                options.saveStatePath = options.outputDir / state_name;
+            }
+
+            jobs.push_back(std::move(job));
+        } catch(std::logic_error& ex)
+        {
+            throw std::runtime_error(fmt::format(
+                "Invalid manifest {} at line {}: {}",
+                manifest_path.string(), line_number, ex.what()
+            ));
+        }
+    }
+
+    return jobs;
+}
+
+
+
+/**
+ * @brief Runs every job, longest first, on a work-stealing pool. Each job
+ * logs to log.txt in its own directory.
+ * @param jobs
+ * @param thread_count 0 for one per core.
+ * @returns One result per job, in the same order.
+ */
+std::vector<BatchResult> runBatch(
+    const std::vector<BatchJob>& jobs,
+    unsigned int thread_count
+)
+{
+    std::vector<BatchResult> results(jobs.size());
+
+    // Starting the longest jobs first keeps one from starting last and
+    // running on alone while the other threads sit idle.
+    std::vector<size_t> order(jobs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+    {
+        return jobs[a].options.frames > jobs[b].options.frames;
+    });
+
+    WorkPool pool(thread_count);
+    logMessage(fmt::format(
+        "Running {} jobs on {} threads...",
+        jobs.size(), pool.getThreadCount()
+    ),
+        LOG_INFO
+    );
+
+    setLogSink(logToJob);
+
+    pool.run(jobs.size(), [&](size_t task)
+    {
+        const BatchJob& job = jobs[order[task]];
+        BatchResult& result = results[order[task]];
+
+        std::ofstream log_file;
+        try
+        {
+            std::filesystem::create_directories(job.options.outputDir);
+            log_file.open(job.options.outputDir / "log.txt");
+        } catch(std::filesystem::filesystem_error&)
+        {
+            // runHeadless reports it.
+        }
+        if(log_file.is_open()) { jobLog = &log_file; }
+
+        result.status = runHeadless(job.options, &result.run);
+        jobLog = nullptr;
+
+        const HeadlessResult& run = result.run;
+        if(result.status == 0)
+        {
+            logMessage(fmt::format(
+                "{}: {} frames in {:.3f}s ({:.1f} FPS)",
+                job.name, run.frames, run.seconds,
+                (run.seconds > 0) ? run.frames / run.seconds : 0.0
+            ),
+                LOG_INFO
+            );
+        } else
+        {
+            logMessage(fmt::format(
+                "{}: failed. {}", job.name, run.error
+            ),
+                LOG_ERRORS
+            );
+        }
+    });
+
+    setLogSink(nullptr);
+    return results;
+}
+
+
+
+/**
+ * @brief Writes one tab-separated line per job with its status, runtime,
+ * and emulated frames per second.
+ * @param file_path
+ * @param jobs
+ * @param results
+ * @throws std::ios_base::failure on file error.
+ */
+void writeSummary(
+    const std::filesystem::path& file_path,
+    const std::vector<BatchJob>& jobs,
+    const std::vector<BatchResult>& results
+)
+{
+    std::ofstream file(file_path);
+    if(!file.is_open())
+    {
+        throw std::ios_base::failure(fmt::format(
+            "Cannot open file {}!", file_path.string()
+        ));
+    }
+
+    file << "job\trom\tstatus\tframes\tcycles\tseconds\tfps\terror\n";
+
+    for(size_t i = 0; i < jobs.size(); i++)
+    {
+        const HeadlessResult& run = results[i].run;
+
+        // Keep each job on one line of its own columns.
+        std::string error = run.error;
+        std::replace_if(error.begin(), error.end(), [](char c)
+        {
+            return c == '\t' || c == '\n' || c == '\r';
+        }, ' ');
+
+        file << fmt::format(
+            "{}\t{}\t{}\t{}\t{}\t{:.3f}\t{:.1f}\t{}\n",
+            jobs[i].name, jobs[i].options.romPath.string(),
+            results[i].status, run.frames, run.cycles, run.seconds,
+            (run.seconds > 0) ? run.frames / run.seconds : 0.0,
+            error
+        );
+    }
+}
@@ -0,0 +1,75 @@
+/**
+ * @file batch.hpp
+ * @brief Runs a manifest of headless jobs across every core in one process
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "headless.hpp"
+
+struct BatchJob
+{
+    // Directory under the batch's output directory, unique per manifest
+    std::string name = "";
+    HeadlessOptions options;
+};
+
+struct BatchResult
+{
+    // Exit status of the run, as a headless process would have returned
+    int status = 1;
+    HeadlessResult run;
+};
+
+/**
+ * @brief Reads a manifest of jobs, one per line:
+ *
+ *     <rom> <input file, or -> <frames> [key=value...]
+ *
+ * Keys are dump=N to write every Nth frame, audio=file and state=file to
+ * write audio or the final state into the job's directory, load=file to
+ * start from a save state, link=rom to link a second ROM, and name=dir to
+ * name the job's directory. Audio, state, and name must be plain names, not
+ * paths.
+ * Relative paths are from the manifest's directory, and paths with spaces
+ * can be quoted. '#' starts a comment line.
+ * @param manifest_path
+ * @param output_dir Where jobs' directories go.
+ * @throws std::ios_base::failure on file error.
+ * @throws std::runtime_error on invalid file contents.
+ */
+std::vector<BatchJob> loadManifest(
+    const std::filesystem::path& manifest_path,
+    const std::filesystem::path& output_dir
+);
+
+/**
+ * @brief Runs every job, longest first, on a work-stealing pool. Each job
+ * logs to log.txt in its own directory.
+ * @param jobs
+ * @param thread_count 0 for one per core.
+ * @returns One result per job, in the same order.
+ */
+std::vector<BatchResult> runBatch(
+    const std::vector<BatchJob>& jobs,
+    unsigned int thread_count
+);
+
+/**
+ * @brief Writes one tab-separated line per job with its status, runtime,
+ * and emulated frames per second.
+ * @param file_path
+ * @param jobs
+ * @param results
+ * @throws std::ios_base::failure on file error.
+ */
+void writeSummary(
+    const std::filesystem::path& file_path,
+    const std::vector<BatchJob>& jobs,
+    const std::vector<BatchResult>& results
+);
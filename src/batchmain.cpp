@@ -0,0 +1,183 @@
+/**
+ * @file batchmain.cpp
+ * @brief Entry point for imgbe-batch, which runs a manifest of headless
+ * jobs, e.g. nightly regression sweeps, in one process
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <fmt/core.h>
+#include "batch.hpp"
+#include "logger.hpp"
+
+namespace
+{
+
+struct BatchArguments
+{
+    std::filesystem::path manifestPath = "";
+    std::filesystem::path outputDir = ".";
+    // Empty for summary.tsv in outputDir
+    std::filesystem::path summaryPath = "";
+    unsigned int threads = 0;
+    LOG_LEVELS logLevel = LOG_INFO;
+};
+
+const char* USAGE =
+    "Usage: imgbe-batch <manifest> [--output=dir] [--summary=file]\n"
+    "                   [--threads=N] [-l=level]\n";
+
+void throwInvalidArgument(const std::string& argument)
+{
+    throw std::invalid_argument(fmt::format(
+        "Invalid program argument: {}\n{}", argument, USAGE
+    ));
+}
+
+uint64_t parseCount(const std::string& argument, const std::string& value)
+{
+    if(value.empty()
+       || value.find_first_not_of("0123456789") != std::string::npos)
+    {
+        throwInvalidArgument(argument);
+    }
+
+    try
+    {
+        return std::stoull(value);
+    } catch(std::logic_error&) // Too large
+    {
+        throwInvalidArgument(argument);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Reads the program's arguments.
+ * @throws std::invalid_argument if an argument is invalid.
+ */
+BatchArguments handleArguments(int argc, char** argv)
+{
+    BatchArguments arguments;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+
+        if(argument.empty() || argument[0] != '-')
+        {
+            if(!arguments.manifestPath.empty())
+            {
+                throwInvalidArgument(argument);
+            }
+            arguments.manifestPath = argument;
+            continue;
+        }
+
+        size_t split = argument.find('=');
+        if(split == std::string::npos) { throwInvalidArgument(argument); }
+        std::string name = argument.substr(0, split);
+        std::string value = argument.substr(split + 1);
+
+        if(name == "--output")
+        {
+            arguments.outputDir = value;
+        } else if(name == "--summary")
+        {
+            arguments.summaryPath = value;
+        } else if(name == "--threads")
+        {
+            uint64_t threads = parseCount(argument, value);
+            if(threads > 1024) { throwInvalidArgument(argument); }
+            arguments.threads = static_cast<unsigned int>(threads);
+        } else if(name == "-l")
+        {
+            uint64_t level = parseCount(argument, value);
+            if(level > LOG_DEBUG) { throwInvalidArgument(argument); }
+            arguments.logLevel = static_cast<LOG_LEVELS>(level);
+        } else
+        {
+            throwInvalidArgument(argument);
+        }
+    }
+
+    if(arguments.manifestPath.empty())
+    {
+        throw std::invalid_argument(USAGE);
+    }
+
+    if(arguments.summaryPath.empty())
+    {
+        arguments.summaryPath = arguments.outputDir / "summary.tsv";
+    }
+
+    return arguments;
+}
+
+} // namespace
+
+
+
+int main(int argc, char** argv)
+{
+    BatchArguments arguments;
+    try
+    {
+        arguments = handleArguments(argc, argv);
+    } catch(std::invalid_argument& ex)
+    {
+        std::cerr << ex.what();
+        return 1;
+    }
+
+    loggerInit(arguments.logLevel, "", true);
+
+    try
+    {
+        std::vector<BatchJob> jobs = loadManifest(
+            arguments.manifestPath, arguments.outputDir
+        );
+
+        auto start_time = std::chrono::steady_clock::now();
+        std::vector<BatchResult> results = runBatch(jobs, arguments.threads);
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start_time
+        ).count();
+
+        std::filesystem::create_directories(arguments.outputDir);
+        writeSummary(arguments.summaryPath, jobs, results);
+
+        size_t failed = 0;
+        uint64_t frames = 0;
+        for(const BatchResult& result : results)
+        {
+            if(result.status != 0) { failed++; }
+            frames += result.run.frames;
+        }
+
+        logMessage(fmt::format(
+            "Batch finished. Jobs: {} - Failed: {} - Time: {:.3f}s - "
+            "Emulated FPS: {:.1f} - Summary: {}",
+            jobs.size(), failed, seconds,
+            (seconds > 0) ? frames / seconds : 0.0,
+            arguments.summaryPath.string()
+        ),
+            failed != 0 ? LOG_ERRORS : LOG_INFO
+        );
+
+        loggerExit();
+        return failed != 0 ? 1 : 0;
+    } catch(std::exception& ex)
+    {
+        logMessage(fmt::format("Batch failed. Error: {}", ex.what()),
+                   LOG_ERRORS);
+        loggerExit();
+        return 1;
+    }
+}
@@ -0,0 +1,1161 @@
+/**
+ * @file emu/emuapu.cpp
+ * @brief Implements the system's Audio Processing Unit
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "emuapu.hpp"
+#include <algorithm>
+#include <cmath>
+#include "emustate.hpp"
+#include "emusys.hpp"
+
+constexpr uint64_t APU_CLOCK_RATE = 4194304;
+// Frame sequencer runs at 512 Hz
+constexpr uint64_t SEQUENCER_PERIOD = APU_CLOCK_RATE / 512;
+
+// Band-limited step kernel. Each step is spread over BLIP_WIDTH samples,
+// with BLIP_PHASES sub-sample positions.
+constexpr int BLIP_WIDTH = 16;
+constexpr int BLIP_PHASE_BITS = 6;
+constexpr int BLIP_PHASES = 1 << BLIP_PHASE_BITS;
+constexpr int BLIP_SCALE_BITS = 15;
+
+// Removes DC offset, cutoff is around 15 Hz at 48 kHz.
+constexpr int HIGH_PASS_SHIFT = 9;
+// Mixer levels peak at 15 * 4 channels * 8 volume = 480. Scale to about
+// 30720 (480 << 6) so four loud channels nearly fill an int16.
+constexpr int OUTPUT_SHIFT = BLIP_SCALE_BITS - 6;
+
+constexpr double MAX_RATE_ADJUST = 1.1;
+constexpr int MAX_BUFFERED_SECONDS = 1;
+
+constexpr uint8_t DUTY_PATTERNS[4] =
+{
+    0b00000001, // 12.5%
+    0b10000001, // 25%
+    0b10000111, // 50%
+    0b01111110, // 75%
+};
+
+// OR'd into reads, unreadable and unused bits read as 1.
+constexpr uint8_t READ_MASKS[APU_REG_END - APU_REG_START + 1] =
+{
+    0x80, 0x3F, 0x00, 0xFF, 0xBF,                   // NR10-NR14
+    0xFF, 0x3F, 0x00, 0xFF, 0xBF,                   // ----, NR21-NR24
+    0x7F, 0xFF, 0x9F, 0xFF, 0xBF,                   // NR30-NR34
+    0xFF, 0xFF, 0x00, 0x00, 0xBF,                   // ----, NR41-NR44
+    0x00, 0x00, 0x70,                               // NR50-NR52
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Wave RAM
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+using BlipKernel = std::array<std::array<int32_t, BLIP_WIDTH>, BLIP_PHASES>;
+
+const BlipKernel& getBlipKernel(void) noexcept;
+
+
+
+EmuAPU::EmuAPU(RegisterSet* registers, EmuSys* parent_sys)
+{
+    regs = registers;
+    sys = parent_sys;
+    setSampleRate(APU_DEFAULT_SAMPLE_RATE);
+}
+
+EmuAPU::~EmuAPU()
+{}
+
+
+
+void EmuAPU::setRegisters(RegisterSet* registers)
+{
+    regs = registers;
+}
+
+
+
+void EmuAPU::setParentSysPtr(EmuSys* parent_sys)
+{
+    sys = parent_sys;
+}
+
+
+
+/**
+ * @brief Resets all channels and drops buffered audio.
+ */
+void EmuAPU::reset(void) noexcept
+{
+    uint64_t cycle = getCurrentCycle();
+
+    state = State{};
+    state.lastCycle = cycle;
+    state.nextSequencerCycle = cycle + SEQUENCER_PERIOD;
+    state.noise.lfsr = 0x7FFF;
+
+    // Drops buffered audio and restarts the delta buffers at this cycle.
+    setSampleRate(sampleRate);
+}
+
+
+
+/**
+ * @brief Reads a sound register, catching up first.
+ * @param address $FF10-$FF3F
+ * @returns Register value with unreadable bits set.
+ */
+uint8_t EmuAPU::readRegister(uint16_t address) noexcept
+{
+    if(regs == nullptr || address < APU_REG_START || address > APU_REG_END)
+    {
+        return 0xFF;
+    }
+
+    catchUp(getCurrentCycle());
+
+    // NR52's low bits are channel status, not stored values.
+    if(address == 0xFF26)
+    {
+        return (regs->mem.sound.nr52 & 0x80)
+            | READ_MASKS[address - APU_REG_START]
+            | (state.square1.enabled << 0)
+            | (state.square2.enabled << 1)
+            | (state.wave.enabled << 2)
+            | (state.noise.enabled << 3);
+    }
+
+    uint8_t* register_ptr = regs->getRegisterPtr(address);
+    if(register_ptr == nullptr) { return 0xFF; }
+
+    return *register_ptr | READ_MASKS[address - APU_REG_START];
+}
+
+
+
+/**
+ * @brief Writes a sound register, catching up first so the old value
+ * applies to everything before this cycle.
+ * @param address $FF10-$FF3F
+ * @param value
+ */
+void EmuAPU::writeRegister(uint16_t address, uint8_t value) noexcept
+{
+    if(regs == nullptr || address < APU_REG_START || address > APU_REG_END)
+    {
+        return;
+    }
+
+    uint64_t cycle = getCurrentCycle();
+    catchUp(cycle);
+
+    auto& sound = regs->mem.sound;
+
+    // Wave RAM stays accessible with the APU off.
+    if(address >= 0xFF30)
+    {
+        sound.wave[address - 0xFF30] = value;
+        return;
+    }
+
+    if(address == 0xFF26)
+    {
+        bool was_powered = isPowered();
+        sound.nr52 = value & 0x80;
+
+        if(was_powered && !isPowered())
+        {
+            powerOff(cycle);
+        } else if(!was_powered && isPowered())
+        {
+            state.sequencerStep = 0;
+            state.nextSequencerCycle = cycle + SEQUENCER_PERIOD;
+        }
+        return;
+    }
+
+    // Registers are read-only while powered off.
+    if(!isPowered()) { return; }
+
+    uint8_t* register_ptr = regs->getRegisterPtr(address);
+    if(register_ptr == nullptr) { return; }
+    *register_ptr = value;
+
+    switch(address)
+    {
+    case 0xFF11: state.square1.length = 64 - (value & 0x3F); break;
+    case 0xFF16: state.square2.length = 64 - (value & 0x3F); break;
+    case 0xFF1B: state.wave.length = 256 - value; break;
+    case 0xFF20: state.noise.length = 64 - (value & 0x3F); break;
+
+    // Turning a DAC off also turns off its channel.
+    case 0xFF12:
+    {
+        if(!isDACEnabled(0)) { state.square1.enabled = false; }
+        updateOutput(0, cycle);
+        break;
+    }
+
+    case 0xFF17:
+    {
+        if(!isDACEnabled(1)) { state.square2.enabled = false; }
+        updateOutput(1, cycle);
+        break;
+    }
+
+    case 0xFF1A:
+    {
+        if(!isDACEnabled(2)) { state.wave.enabled = false; }
+        updateOutput(2, cycle);
+        break;
+    }
+
+    case 0xFF21:
+    {
+        if(!isDACEnabled(3)) { state.noise.enabled = false; }
+        updateOutput(3, cycle);
+        break;
+    }
+
+    case 0xFF1C: updateOutput(2, cycle); break;
+
+    case 0xFF14: if(value & 0x80) { trigger(0, cycle); } break;
+    case 0xFF19: if(value & 0x80) { trigger(1, cycle); } break;
+    case 0xFF1E: if(value & 0x80) { trigger(2, cycle); } break;
+    case 0xFF23: if(value & 0x80) { trigger(3, cycle); } break;
+
+    case 0xFF24:
+    case 0xFF25:
+    {
+        updateAllOutputs(cycle);
+        break;
+    }
+
+    default: break;
+    }
+}
+
+
+
+/**
+ * @brief Catches up to the current cycle and converts everything
+ * synthesized so far into output samples.
+ */
+void EmuAPU::endFrame(void) noexcept
+{
+    uint64_t cycle = getCurrentCycle();
+    catchUp(cycle);
+    flush(cycle);
+}
+
+
+
+/**
+ * @brief Sets the output sample rate. Drops buffered audio.
+ * @param sample_rate Hz
+ */
+void EmuAPU::setSampleRate(int sample_rate) noexcept
+{
+    sampleRate = std::clamp(sample_rate, 8000, 192000);
+    updateSampleStep();
+
+    // Catch-up runs at most one sequencer period between flush checks.
+    size_t chunk_samples = static_cast<size_t>(std::ceil(
+        SEQUENCER_PERIOD * sampleRate * MAX_RATE_ADJUST / APU_CLOCK_RATE
+    )) + 1;
+    flushThreshold = chunk_samples;
+
+    for(auto& buffer : deltaBuffers)
+    {
+        buffer.assign((chunk_samples * 3) + (BLIP_WIDTH * 2), 0);
+    }
+    integrators.fill(0);
+    highPass.fill(0);
+    samples.clear();
+    readIndex = 0;
+
+    baseTime = 0;
+    baseCycle = state.lastCycle;
+
+    // The buffers start from silence, so re-emit every channel's level.
+    std::fill(std::begin(state.outputLeft), std::end(state.outputLeft), 0);
+    std::fill(std::begin(state.outputRight), std::end(state.outputRight), 0);
+    if(regs != nullptr) { updateAllOutputs(state.lastCycle); }
+}
+
+
+
+/**
+ * @brief Restores a saved state. Drops buffered audio, and restarts output
+ * from the saved cycle.
+ * @param saved
+ */
+void EmuAPU::setState(const State& saved) noexcept
+{
+    state = saved;
+    setSampleRate(sampleRate);
+}
+
+
+
+/**
+ * @brief Checks a saved state read from a file before it is set.
+ * @param saved
+ * @throws std::runtime_error if a field is out of range.
+ */
+void EmuAPU::checkState(const State& saved)
+{
+    StateReader::checkBool("APU ", "square 1 enabled", saved.square1.enabled);
+    StateReader::checkBool("APU ", "sweep enabled", saved.sweep.enabled);
+    StateReader::checkBool("APU ", "square 2 enabled", saved.square2.enabled);
+    StateReader::checkBool("APU ", "wave enabled", saved.wave.enabled);
+    StateReader::checkBool("APU ", "noise enabled", saved.noise.enabled);
+
+    // Shift counts and indices
+    StateReader::checkRange(
+        "APU ", "square 1 duty position", saved.square1.dutyPos, 8
+    );
+    StateReader::checkRange(
+        "APU ", "square 2 duty position", saved.square2.dutyPos, 8
+    );
+    StateReader::checkRange(
+        "APU ", "wave position", saved.wave.position, 32
+    );
+    StateReader::checkRange(
+        "APU ", "sequencer step", saved.sequencerStep, 8
+    );
+}
+
+
+
+/**
+ * @brief Copies the output in progress.
+ * @param output Reuses its memory.
+ */
+void EmuAPU::getOutput(Output& output) const
+{
+    output.rateChanged = rateChanged;
+    output.samplesPerCycle = samplesPerCycle;
+    output.baseTime = baseTime;
+    output.baseCycle = baseCycle;
+    output.deltaBuffers = deltaBuffers;
+    output.integrators = integrators;
+    output.highPass = highPass;
+    std::copy(
+        std::begin(state.outputLeft), std::end(state.outputLeft),
+        output.outputLeft.begin()
+    );
+    std::copy(
+        std::begin(state.outputRight), std::end(state.outputRight),
+        output.outputRight.begin()
+    );
+    output.samples.assign(samples.begin() + readIndex, samples.end());
+}
+
+
+
+/**
+ * @brief Puts back output copied with getOutput, after restoring the state
+ * it was copied with. Audio carries on as if nothing since ran.
+ * @param output
+ */
+void EmuAPU::setOutput(const Output& output)
+{
+    rateChanged = output.rateChanged;
+    samplesPerCycle = output.samplesPerCycle;
+    baseTime = output.baseTime;
+    baseCycle = output.baseCycle;
+    deltaBuffers = output.deltaBuffers;
+    integrators = output.integrators;
+    highPass = output.highPass;
+    std::copy(
+        output.outputLeft.begin(), output.outputLeft.end(),
+        std::begin(state.outputLeft)
+    );
+    std::copy(
+        output.outputRight.begin(), output.outputRight.end(),
+        std::begin(state.outputRight)
+    );
+    samples = output.samples;
+    readIndex = 0;
+}
+
+
+
+int EmuAPU::getSampleRate(void) const noexcept
+{
+    return sampleRate;
+}
+
+
+
+/**
+ * @brief Scales the number of samples produced per emulated second, for
+ * dynamic rate control. Takes effect at the next frame end.
+ * @param ratio Around 1.0.
+ */
+void EmuAPU::setRateAdjust(double ratio) noexcept
+{
+    ratio = std::clamp(ratio, 2.0 - MAX_RATE_ADJUST, MAX_RATE_ADJUST);
+    if(ratio == rateAdjust) { return; }
+
+    rateAdjust = ratio;
+    rateChanged = true;
+}
+
+
+
+/**
+ * @brief Enables or disables sample synthesis. Channels keep running
+ * either way, only output is skipped.
+ * @param enabled
+ */
+void EmuAPU::setSynthesisEnabled(bool enabled) noexcept
+{
+    if(enabled == synthesisEnabled) { return; }
+
+    // Levels that changed while disabled are emitted as single steps.
+    synthesisEnabled = enabled;
+    if(enabled && regs != nullptr) { updateAllOutputs(state.lastCycle); }
+}
+
+
+
+bool EmuAPU::isSynthesisEnabled(void) const noexcept
+{
+    return synthesisEnabled;
+}
+
+
+
+/**
+ * @brief Returns the number of stereo frames ready to be read.
+ */
+size_t EmuAPU::getAvailableFrames(void) const noexcept
+{
+    return (samples.size() - readIndex) / 2;
+}
+
+
+
+/**
+ * @brief Moves up to max_frames interleaved stereo frames into dest.
+ * @param dest Room for max_frames * 2 samples.
+ * @param max_frames
+ * @returns Number of frames read.
+ */
+size_t EmuAPU::readSamples(int16_t* dest, size_t max_frames) noexcept
+{
+    size_t frames = std::min(max_frames, getAvailableFrames());
+
+    auto first = samples.begin() + readIndex;
+    std::copy(first, first + (frames * 2), dest);
+    readIndex += frames * 2;
+
+    // Reading everything empties the buffer without moving anything.
+    if(readIndex == samples.size()) { discardSamples(); }
+
+    return frames;
+}
+
+
+
+/**
+ * @brief Returns the frames ready to be read, interleaved, in place.
+ * Valid until the APU next runs or is read.
+ */
+const int16_t* EmuAPU::getSamples(void) const noexcept
+{
+    return samples.data() + readIndex;
+}
+
+
+
+/**
+ * @brief Drops the frames ready to be read, keeping the buffer's memory.
+ */
+void EmuAPU::discardSamples(void) noexcept
+{
+    samples.clear();
+    readIndex = 0;
+}
+
+
+
+uint64_t EmuAPU::getCurrentCycle(void) const noexcept
+{
+    return (sys != nullptr) ? sys->getCycleCount() : state.lastCycle;
+}
+
+
+
+/**
+ * @brief Runs every channel up to a cycle, splitting at frame sequencer
+ * clocks so length, envelope, and sweep changes land on the right cycle.
+ * @param cycle
+ */
+void EmuAPU::catchUp(uint64_t cycle) noexcept
+{
+    if(regs == nullptr) { return; }
+
+    while(state.lastCycle < cycle)
+    {
+        uint64_t end = std::min(cycle, state.nextSequencerCycle);
+
+        if(isPowered())
+        {
+            runSquare(state.square1, 0, end);
+            runSquare(state.square2, 1, end);
+            runWave(end);
+            runNoise(end);
+        }
+
+        state.lastCycle = end;
+
+        if(end == state.nextSequencerCycle)
+        {
+            clockSequencer(end);
+            state.nextSequencerCycle += SEQUENCER_PERIOD;
+        }
+
+        uint64_t time = baseTime + ((end - baseCycle) * samplesPerCycle);
+        if((time >> 32) >= flushThreshold) { flush(end); }
+    }
+}
+
+
+
+/**
+ * @brief Integrates every completed sample up to a cycle into output.
+ * @param cycle Must already be caught up to.
+ */
+void EmuAPU::flush(uint64_t cycle) noexcept
+{
+    uint64_t time = baseTime + ((cycle - baseCycle) * samplesPerCycle);
+    size_t count = time >> 32;
+
+    // Read samples are only moved out once they're at least half the
+    // buffer, so each sample is moved at most once on average.
+    if(readIndex != 0 && readIndex >= samples.size() / 2)
+    {
+        samples.erase(samples.begin(), samples.begin() + readIndex);
+        readIndex = 0;
+    }
+
+    size_t first = samples.size();
+    if(synthesisEnabled) { samples.resize(first + (count * 2)); }
+
+    for(int side = 0; side < 2; side++)
+    {
+        std::vector<int32_t>& buffer = deltaBuffers[side];
+        int32_t integrator = integrators[side];
+        int32_t high_pass = highPass[side];
+
+        // Integrate even when not synthesizing so the level stays in sync.
+        for(size_t i = 0; i < count; i++)
+        {
+            integrator += buffer[i];
+            high_pass += (integrator - high_pass) >> HIGH_PASS_SHIFT;
+
+            if(synthesisEnabled)
+            {
+                int32_t sample = (integrator - high_pass) >> OUTPUT_SHIFT;
+                samples[first + (i * 2) + side] = static_cast<int16_t>(
+                    std::clamp(sample, INT16_MIN, INT16_MAX)
+                );
+            }
+        }
+
+        integrators[side] = integrator;
+        highPass[side] = high_pass;
+
+        // Kernel tails past the last sample carry over.
+        std::copy(buffer.begin() + count, buffer.end(), buffer.begin());
+        std::fill(buffer.end() - count, buffer.end(), 0);
+    }
+
+    baseTime = time - (static_cast<uint64_t>(count) << 32);
+    baseCycle = cycle;
+
+    if(rateChanged) { updateSampleStep(); }
+
+    // Nobody is reading; keep only the newest audio.
+    size_t max_samples = static_cast<size_t>(sampleRate)
+        * MAX_BUFFERED_SECONDS * 2;
+    if(samples.size() - readIndex > max_samples)
+    {
+        readIndex = samples.size() - max_samples;
+    }
+}
+
+
+
+void EmuAPU::updateSampleStep(void) noexcept
+{
+    double step = (sampleRate * rateAdjust) / APU_CLOCK_RATE;
+    samplesPerCycle = static_cast<uint64_t>(std::ldexp(step, 32) + 0.5);
+    rateChanged = false;
+}
+
+
+
+/**
+ * @brief Advances a square channel's duty position up to a cycle.
+ * @param channel
+ * @param index 0 or 1
+ * @param end
+ */
+void EmuAPU::runSquare(State::Square& channel, int index, uint64_t end) noexcept
+{
+    if(channel.nextEdge >= end) { return; }
+
+    const auto& sound = regs->mem.sound;
+    uint8_t nrx3 = (index == 0) ? sound.nr13 : sound.nr23;
+    uint8_t nrx4 = (index == 0) ? sound.nr14 : sound.nr24;
+    uint64_t period = (2048 - (nrx3 | ((nrx4 & 0b111) << 8))) * 4;
+
+    // Level can't change, so skip straight to the end.
+    if(!synthesisEnabled || !channel.enabled || channel.volume == 0)
+    {
+        uint64_t steps = (end - channel.nextEdge + period - 1) / period;
+        channel.dutyPos = (channel.dutyPos + steps) & 0b111;
+        channel.nextEdge += steps * period;
+        return;
+    }
+
+    while(channel.nextEdge < end)
+    {
+        channel.dutyPos = (channel.dutyPos + 1) & 0b111;
+        updateOutput(index, channel.nextEdge);
+        channel.nextEdge += period;
+    }
+}
+
+
+
+/**
+ * @brief Advances the wave channel's sample position up to a cycle.
+ * @param end
+ */
+void EmuAPU::runWave(uint64_t end) noexcept
+{
+    State::Wave& channel = state.wave;
+    if(channel.nextEdge >= end) { return; }
+
+    const auto& sound = regs->mem.sound;
+    uint64_t period = (2048 - (sound.nr33 | ((sound.nr34 & 0b111) << 8))) * 2;
+
+    auto read_sample = [&sound](uint8_t position)
+    {
+        uint8_t byte = sound.wave[position / 2];
+        return static_cast<uint8_t>(
+            (position & 1) ? (byte & 0x0F) : (byte >> 4)
+        );
+    };
+
+    if(!synthesisEnabled || !channel.enabled)
+    {
+        uint64_t steps = (end - channel.nextEdge + period - 1) / period;
+        channel.position = (channel.position + steps) & 31;
+        channel.sample = read_sample(channel.position);
+        channel.nextEdge += steps * period;
+        return;
+    }
+
+    while(channel.nextEdge < end)
+    {
+        channel.position = (channel.position + 1) & 31;
+        channel.sample = read_sample(channel.position);
+        updateOutput(2, channel.nextEdge);
+        channel.nextEdge += period;
+    }
+}
+
+
+
+/**
+ * @brief Clocks the noise channel's LFSR up to a cycle.
+ * @param end
+ */
+void EmuAPU::runNoise(uint64_t end) noexcept
+{
+    State::Noise& channel = state.noise;
+    if(channel.nextEdge >= end) { return; }
+
+    uint8_t nr43 = regs->mem.sound.nr43;
+    uint8_t shift = nr43 >> 4;
+    uint64_t divisor = (nr43 & 0b111) ? (nr43 & 0b111) * 16 : 8;
+    uint64_t period = divisor << shift;
+
+    // Shifts of 14 and 15 stop the LFSR. Triggering resets it anyway.
+    if(shift >= 14 || !channel.enabled)
+    {
+        uint64_t steps = (end - channel.nextEdge + period - 1) / period;
+        channel.nextEdge += steps * period;
+        return;
+    }
+
+    bool short_mode = nr43 & 0b1000;
+    bool audible = synthesisEnabled && channel.volume != 0;
+
+    while(channel.nextEdge < end)
+    {
+        uint16_t bit = (channel.lfsr ^ (channel.lfsr >> 1)) & 1;
+        channel.lfsr = (channel.lfsr >> 1) | (bit << 14);
+        if(short_mode)
+        {
+            channel.lfsr = (channel.lfsr & ~(1 << 6)) | (bit << 6);
+        }
+
+        if(audible) { updateOutput(3, channel.nextEdge); }
+        channel.nextEdge += period;
+    }
+}
+
+
+
+/**
+ * @brief Runs one 512 Hz frame sequencer step.
+ * @param cycle
+ */
+void EmuAPU::clockSequencer(uint64_t cycle) noexcept
+{
+    if(!isPowered()) { return; }
+
+    switch(state.sequencerStep)
+    {
+    case 0:
+    case 4:
+    {
+        clockLength(cycle);
+        break;
+    }
+
+    case 2:
+    case 6:
+    {
+        clockLength(cycle);
+        clockSweep(cycle);
+        break;
+    }
+
+    case 7:
+    {
+        clockEnvelope(cycle);
+        break;
+    }
+
+    default: break;
+    }
+
+    state.sequencerStep = (state.sequencerStep + 1) & 0b111;
+}
+
+
+
+void EmuAPU::clockLength(uint64_t cycle) noexcept
+{
+    const auto& sound = regs->mem.sound;
+
+    auto clock = [this, cycle](bool& enabled, uint16_t& length,
+                               uint8_t nrx4, int index)
+    {
+        if(!(nrx4 & 0x40) || length == 0) { return; }
+
+        length--;
+        if(length == 0)
+        {
+            enabled = false;
+            updateOutput(index, cycle);
+        }
+    };
+
+    clock(state.square1.enabled, state.square1.length, sound.nr14, 0);
+    clock(state.square2.enabled, state.square2.length, sound.nr24, 1);
+    clock(state.wave.enabled, state.wave.length, sound.nr34, 2);
+    clock(state.noise.enabled, state.noise.length, sound.nr44, 3);
+}
+
+
+
+void EmuAPU::clockEnvelope(uint64_t cycle) noexcept
+{
+    const auto& sound = regs->mem.sound;
+
+    auto clock = [this, cycle](bool enabled, uint8_t& volume, uint8_t& timer,
+                               uint8_t nrx2, int index)
+    {
+        uint8_t period = nrx2 & 0b111;
+        if(!enabled || period == 0) { return; }
+
+        if(timer > 0) { timer--; }
+        if(timer != 0) { return; }
+
+        timer = period;
+        if((nrx2 & 0b1000) && volume < 15)
+        {
+            volume++;
+            updateOutput(index, cycle);
+        } else if(!(nrx2 & 0b1000) && volume > 0)
+        {
+            volume--;
+            updateOutput(index, cycle);
+        }
+    };
+
+    clock(state.square1.enabled, state.square1.volume,
+          state.square1.envelopeTimer, sound.nr12, 0);
+    clock(state.square2.enabled, state.square2.volume,
+          state.square2.envelopeTimer, sound.nr22, 1);
+    clock(state.noise.enabled, state.noise.volume,
+          state.noise.envelopeTimer, sound.nr42, 3);
+}
+
+
+
+void EmuAPU::clockSweep(uint64_t cycle) noexcept
+{
+    auto& sound = regs->mem.sound;
+    State::Sweep& sweep = state.sweep;
+
+    if(sweep.timer > 0) { sweep.timer--; }
+    if(sweep.timer != 0) { return; }
+
+    uint8_t period = (sound.nr10 >> 4) & 0b111;
+    sweep.timer = (period != 0) ? period : 8;
+
+    if(!sweep.enabled || period == 0) { return; }
+
+    uint16_t frequency = calculateSweep(cycle);
+    if(frequency <= 2047 && (sound.nr10 & 0b111) != 0)
+    {
+        sweep.shadowFreq = frequency;
+        sound.nr13 = frequency & 0xFF;
+        sound.nr14 = (sound.nr14 & ~0b111) | ((frequency >> 8) & 0b111);
+
+        // The new frequency is checked for overflow again, but not used.
+        calculateSweep(cycle);
+    }
+}
+
+
+
+/**
+ * @brief Calculates the next sweep frequency, disabling square 1 on
+ * overflow.
+ * @param cycle
+ */
+uint16_t EmuAPU::calculateSweep(uint64_t cycle) noexcept
+{
+    uint8_t nr10 = regs->mem.sound.nr10;
+    uint16_t shadow = state.sweep.shadowFreq;
+    uint16_t delta = shadow >> (nr10 & 0b111);
+
+    uint16_t frequency = (nr10 & 0b1000) ? shadow - delta : shadow + delta;
+    if(frequency > 2047)
+    {
+        state.square1.enabled = false;
+        updateOutput(0, cycle);
+    }
+
+    return frequency;
+}
+
+
+
+/**
+ * @brief Restarts a channel, as when bit 7 of NRx4 is written.
+ * @param index
+ * @param cycle
+ */
+void EmuAPU::trigger(int index, uint64_t cycle) noexcept
+{
+    const auto& sound = regs->mem.sound;
+
+    switch(index)
+    {
+    case 0:
+    case 1:
+    {
+        State::Square& channel = (index == 0) ? state.square1 : state.square2;
+        uint8_t nrx2 = (index == 0) ? sound.nr12 : sound.nr22;
+        uint8_t nrx3 = (index == 0) ? sound.nr13 : sound.nr23;
+        uint8_t nrx4 = (index == 0) ? sound.nr14 : sound.nr24;
+        uint16_t frequency = nrx3 | ((nrx4 & 0b111) << 8);
+
+        channel.enabled = isDACEnabled(index);
+        if(channel.length == 0) { channel.length = 64; }
+        channel.volume = nrx2 >> 4;
+        channel.envelopeTimer = nrx2 & 0b111;
+        channel.nextEdge = cycle + ((2048 - frequency) * 4);
+
+        if(index == 0)
+        {
+            uint8_t period = (sound.nr10 >> 4) & 0b111;
+            uint8_t shift = sound.nr10 & 0b111;
+
+            state.sweep.shadowFreq = frequency;
+            state.sweep.timer = (period != 0) ? period : 8;
+            state.sweep.enabled = period != 0 || shift != 0;
+            if(shift != 0) { calculateSweep(cycle); }
+        }
+        break;
+    }
+
+    case 2:
+    {
+        State::Wave& channel = state.wave;
+        uint16_t frequency = sound.nr33 | ((sound.nr34 & 0b111) << 8);
+
+        channel.enabled = isDACEnabled(2);
+        if(channel.length == 0) { channel.length = 256; }
+        channel.position = 0;
+        channel.nextEdge = cycle + ((2048 - frequency) * 2);
+        break;
+    }
+
+    case 3:
+    {
+        State::Noise& channel = state.noise;
+        uint8_t shift = sound.nr43 >> 4;
+        uint64_t divisor = (sound.nr43 & 0b111) ? (sound.nr43 & 0b111) * 16 : 8;
+
+        channel.enabled = isDACEnabled(3);
+        if(channel.length == 0) { channel.length = 64; }
+        channel.volume = sound.nr42 >> 4;
+        channel.envelopeTimer = sound.nr42 & 0b111;
+        channel.lfsr = 0x7FFF;
+        channel.nextEdge = cycle + (divisor << shift);
+        break;
+    }
+
+    default: return;
+    }
+
+    updateOutput(index, cycle);
+}
+
+
+
+/**
+ * @brief Clears every sound register except wave RAM and stops all
+ * channels, as when NR52 bit 7 is cleared.
+ * @param cycle
+ */
+void EmuAPU::powerOff(uint64_t cycle) noexcept
+{
+    auto& sound = regs->mem.sound;
+
+    sound.nr10 = sound.nr11 = sound.nr12 = sound.nr13 = sound.nr14 = 0;
+    sound.nr21 = sound.nr22 = sound.nr23 = sound.nr24 = 0;
+    sound.nr30 = sound.nr31 = sound.nr32 = sound.nr33 = sound.nr34 = 0;
+    sound.nr41 = sound.nr42 = sound.nr43 = sound.nr44 = 0;
+    sound.nr50 = sound.nr51 = 0;
+
+    state.square1.enabled = false;
+    state.square2.enabled = false;
+    state.wave.enabled = false;
+    state.noise.enabled = false;
+    state.sweep.enabled = false;
+
+    updateAllOutputs(cycle);
+}
+
+
+
+bool EmuAPU::isPowered(void) const noexcept
+{
+    return regs->mem.sound.nr52 & 0x80;
+}
+
+
+
+bool EmuAPU::isDACEnabled(int index) const noexcept
+{
+    const auto& sound = regs->mem.sound;
+
+    switch(index)
+    {
+    case 0: return sound.nr12 & 0xF8;
+    case 1: return sound.nr22 & 0xF8;
+    case 2: return sound.nr30 & 0x80;
+    case 3: return sound.nr42 & 0xF8;
+    default: return false;
+    }
+}
+
+
+
+/**
+ * @brief Returns a channel's digital output, 0-15.
+ * @param index
+ */
+int EmuAPU::getChannelLevel(int index) const noexcept
+{
+    const auto& sound = regs->mem.sound;
+
+    switch(index)
+    {
+    case 0:
+    case 1:
+    {
+        const State::Square& channel = (index == 0)
+            ? state.square1
+            : state.square2;
+        uint8_t duty = ((index == 0) ? sound.nr11 : sound.nr21) >> 6;
+
+        if(!channel.enabled) { return 0; }
+        return ((DUTY_PATTERNS[duty] >> channel.dutyPos) & 1)
+            ? channel.volume
+            : 0;
+    }
+
+    case 2:
+    {
+        // Volume codes: mute, 100%, 50%, 25%
+        constexpr int WAVE_SHIFTS[4] = { 4, 0, 1, 2 };
+
+        if(!state.wave.enabled) { return 0; }
+        return state.wave.sample >> WAVE_SHIFTS[(sound.nr32 >> 5) & 0b11];
+    }
+
+    case 3:
+    {
+        if(!state.noise.enabled) { return 0; }
+        return (state.noise.lfsr & 1) ? 0 : state.noise.volume;
+    }
+
+    default: return 0;
+    }
+}
+
+
+
+/**
+ * @brief Mixes a channel's current level into both sides, and writes any
+ * change as a step at the given cycle.
+ * @param index
+ * @param cycle
+ */
+void EmuAPU::updateOutput(int index, uint64_t cycle) noexcept
+{
+    if(!synthesisEnabled) { return; }
+
+    const auto& sound = regs->mem.sound;
+
+    // The DAC maps 0-15 to a signed level; off DACs output nothing.
+    int32_t level = isDACEnabled(index) ? (getChannelLevel(index) * 2) - 15 : 0;
+
+    int32_t left = ((sound.nr51 >> (index + 4)) & 1)
+        ? level * (((sound.nr50 >> 4) & 0b111) + 1)
+        : 0;
+    int32_t right = ((sound.nr51 >> index) & 1)
+        ? level * ((sound.nr50 & 0b111) + 1)
+        : 0;
+
+    if(left != state.outputLeft[index])
+    {
+        addDelta(0, cycle, left - state.outputLeft[index]);
+        state.outputLeft[index] = left;
+    }
+
+    if(right != state.outputRight[index])
+    {
+        addDelta(1, cycle, right - state.outputRight[index]);
+        state.outputRight[index] = right;
+    }
+}
+
+
+
+void EmuAPU::updateAllOutputs(uint64_t cycle) noexcept
+{
+    for(int i = 0; i < 4; i++)
+    {
+        updateOutput(i, cycle);
+    }
+}
+
+
+
+/**
+ * @brief Adds a band-limited step to a delta buffer.
+ * @param side 0 for left, 1 for right
+ * @param cycle
+ * @param delta
+ */
+void EmuAPU::addDelta(int side, uint64_t cycle, int32_t delta) noexcept
+{
+    const BlipKernel& kernel = getBlipKernel();
+
+    uint64_t time = baseTime + ((cycle - baseCycle) * samplesPerCycle);
+    size_t index = time >> 32;
+    int phase = (time >> (32 - BLIP_PHASE_BITS)) & (BLIP_PHASES - 1);
+
+    int32_t* out = deltaBuffers[side].data() + index;
+    for(int i = 0; i < BLIP_WIDTH; i++)
+    {
+        out[i] += delta * kernel[phase][i];
+    }
+}
+
+
+
+/**
+ * @brief Returns windowed-sinc impulses for each sub-sample phase. Each
+ * phase sums to exactly 1 << BLIP_SCALE_BITS, so integrating the delta
+ * buffer settles on the exact level with no drift.
+ */
+const BlipKernel& getBlipKernel(void) noexcept
+{
+    static const BlipKernel kernel = []()
+    {
+        constexpr double PI = 3.14159265358979323846;
+        // Fraction of Nyquist kept, leaving room for the window's rolloff
+        constexpr double CUTOFF = 0.9;
+
+        BlipKernel result{};
+
+        for(int phase = 0; phase < BLIP_PHASES; phase++)
+        {
+            double offset = static_cast<double>(phase) / BLIP_PHASES;
+            std::array<double, BLIP_WIDTH> taps{};
+            double sum = 0;
+
+            for(int i = 0; i < BLIP_WIDTH; i++)
+            {
+                double x = i - ((BLIP_WIDTH / 2) - 1) - offset;
+                double sinc = (x == 0)
+                    ? 1.0
+                    : std::sin(PI * CUTOFF * x) / (PI * CUTOFF * x);
+
+                // Blackman window across the kernel
+                double w = (x + (BLIP_WIDTH / 2)) / BLIP_WIDTH;
+                double window = 0.42 - (0.5 * std::cos(2 * PI * w))
+                    + (0.08 * std::cos(4 * PI * w));
+
+                taps[i] = sinc * window;
+                sum += taps[i];
+            }
+
+            int32_t total = 0;
+            for(int i = 0; i < BLIP_WIDTH; i++)
+            {
+                result[phase][i] = static_cast<int32_t>(std::lround(
+                    (taps[i] / sum) * (1 << BLIP_SCALE_BITS)
+                ));
+                total += result[phase][i];
+            }
+
+            // Put any rounding error on the centre tap.
+            result[phase][BLIP_WIDTH / 2]
+                += (1 << BLIP_SCALE_BITS) - total;
+        }
+
+        return result;
+    }();
+
+    return kernel;
+}
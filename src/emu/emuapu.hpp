@@ -0,0 +1,261 @@
+/**
+ * @file emu/emuapu.hpp
+ * @brief Implements the system's Audio Processing Unit
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "emuregisters.hpp"
+
+class EmuSys;
+
+// Sound registers and wave RAM, $FF10-$FF3F
+constexpr uint16_t APU_REG_START = 0xFF10;
+constexpr uint16_t APU_REG_END = 0xFF3F;
+
+constexpr int APU_DEFAULT_SAMPLE_RATE = 48000;
+
+/**
+ * @brief Emulates the four sound channels lazily. Nothing runs per cycle;
+ * channels are caught up to the current cycle when a sound register is
+ * accessed or a frame ends, and level changes are written as band-limited
+ * steps into a delta buffer that is integrated into 16-bit stereo samples.
+ */
+class EmuAPU
+{
+public:
+    EmuAPU(RegisterSet* registers = nullptr, EmuSys* parent_sys = nullptr);
+    ~EmuAPU();
+
+    void setRegisters(RegisterSet* registers);
+    void setParentSysPtr(EmuSys* parent_sys);
+
+    /**
+     * @brief Resets all channels and drops buffered audio.
+     */
+    void reset(void) noexcept;
+
+    /**
+     * @brief Reads a sound register, catching up first.
+     * @param address $FF10-$FF3F
+     * @returns Register value with unreadable bits set.
+     */
+    uint8_t readRegister(uint16_t address) noexcept;
+
+    /**
+     * @brief Writes a sound register, catching up first so the old value
+     * applies to everything before this cycle.
+     * @param address $FF10-$FF3F
+     * @param value
+     */
+    void writeRegister(uint16_t address, uint8_t value) noexcept;
+
+    /**
+     * @brief Catches up to the current cycle and converts everything
+     * synthesized so far into output samples.
+     */
+    void endFrame(void) noexcept;
+
+    /**
+     * @brief Sets the output sample rate. Drops buffered audio.
+     * @param sample_rate Hz
+     */
+    void setSampleRate(int sample_rate) noexcept;
+
+    int getSampleRate(void) const noexcept;
+
+    /**
+     * @brief Scales the number of samples produced per emulated second, for
+     * dynamic rate control. Takes effect at the next frame end.
+     * @param ratio Around 1.0.
+     */
+    void setRateAdjust(double ratio) noexcept;
+
+    /**
+     * @brief Enables or disables sample synthesis. Channels keep running
+     * either way, only output is skipped.
+     * @param enabled
+     */
+    void setSynthesisEnabled(bool enabled) noexcept;
+
+    bool isSynthesisEnabled(void) const noexcept;
+
+    /**
+     * @brief Returns the number of stereo frames ready to be read.
+     */
+    size_t getAvailableFrames(void) const noexcept;
+
+    /**
+     * @brief Moves up to max_frames interleaved stereo frames into dest.
+     * @param dest Room for max_frames * 2 samples.
+     * @param max_frames
+     * @returns Number of frames read.
+     */
+    size_t readSamples(int16_t* dest, size_t max_frames) noexcept;
+
+    /**
+     * @brief Returns the frames ready to be read, interleaved, in place.
+     * Valid until the APU next runs or is read.
+     */
+    const int16_t* getSamples(void) const noexcept;
+
+    /**
+     * @brief Drops the frames ready to be read, keeping the buffer's memory.
+     */
+    void discardSamples(void) noexcept;
+
+    // Everything needed to resume emulation exactly. Buffered samples are
+    // output, not state.
+    struct State
+    {
+        struct Square
+        {
+            bool enabled;
+            uint8_t dutyPos;
+            uint8_t volume;
+            uint8_t envelopeTimer;
+            uint16_t length;
+            uint64_t nextEdge;
+        };
+
+        struct Sweep
+        {
+            bool enabled;
+            uint8_t timer;
+            uint16_t shadowFreq;
+        };
+
+        struct Wave
+        {
+            bool enabled;
+            uint8_t position;
+            uint8_t sample;
+            uint16_t length;
+            uint64_t nextEdge;
+        };
+
+        struct Noise
+        {
+            bool enabled;
+            uint8_t volume;
+            uint8_t envelopeTimer;
+            uint16_t length;
+            uint16_t lfsr;
+            uint64_t nextEdge;
+        };
+
+        Square square1;
+        Sweep sweep;
+        Square square2;
+        Wave wave;
+        Noise noise;
+
+        uint8_t sequencerStep;
+        uint64_t nextSequencerCycle;
+        uint64_t lastCycle;
+
+        // Last level written to the delta buffers, per channel
+        int32_t outputLeft[4];
+        int32_t outputRight[4];
+    };
+
+    State state{};
+
+    /**
+     * @brief Restores a saved state. Drops buffered audio, and restarts
+     * output from the saved cycle.
+     * @param saved
+     */
+    void setState(const State& saved) noexcept;
+
+    /**
+     * @brief Checks a saved state read from a file before it is set.
+     * @param saved
+     * @throws std::runtime_error if a field is out of range.
+     */
+    static void checkState(const State& saved);
+
+    // Output in progress, which save states leave out
+    struct Output
+    {
+        bool rateChanged;
+        uint64_t samplesPerCycle;
+        uint64_t baseTime;
+        uint64_t baseCycle;
+        std::array<std::vector<int32_t>, 2> deltaBuffers;
+        std::array<int32_t, 2> integrators;
+        std::array<int32_t, 2> highPass;
+        std::array<int32_t, 4> outputLeft;
+        std::array<int32_t, 4> outputRight;
+        std::vector<int16_t> samples;
+    };
+
+    /**
+     * @brief Copies the output in progress.
+     * @param output Reuses its memory.
+     */
+    void getOutput(Output& output) const;
+
+    /**
+     * @brief Puts back output copied with getOutput, after restoring the
+     * state it was copied with. Audio carries on as if nothing since ran.
+     * @param output
+     */
+    void setOutput(const Output& output);
+
+private:
+    RegisterSet* regs;
+    EmuSys* sys;
+
+    int sampleRate = APU_DEFAULT_SAMPLE_RATE;
+    double rateAdjust = 1.0;
+    bool rateChanged = false;
+    bool synthesisEnabled = true;
+
+    // Output samples per cycle, 32.32 fixed point
+    uint64_t samplesPerCycle = 0;
+    // Buffer position of baseCycle, 32.32 fixed point
+    uint64_t baseTime = 0;
+    uint64_t baseCycle = 0;
+
+    // Delta buffers are flushed once they hold this many samples
+    size_t flushThreshold = 0;
+    std::array<std::vector<int32_t>, 2> deltaBuffers;
+    std::array<int32_t, 2> integrators{};
+    std::array<int32_t, 2> highPass{};
+
+    // Output ready to be read starts at readIndex. Reads only move the
+    // index, and flushes drop what's been read once it's worth moving.
+    std::vector<int16_t> samples;
+    size_t readIndex = 0;
+
+    uint64_t getCurrentCycle(void) const noexcept;
+    void catchUp(uint64_t cycle) noexcept;
+    void flush(uint64_t cycle) noexcept;
+    void updateSampleStep(void) noexcept;
+
+    void runSquare(State::Square& channel, int index, uint64_t end) noexcept;
+    void runWave(uint64_t end) noexcept;
+    void runNoise(uint64_t end) noexcept;
+
+    void clockSequencer(uint64_t cycle) noexcept;
+    void clockLength(uint64_t cycle) noexcept;
+    void clockEnvelope(uint64_t cycle) noexcept;
+    void clockSweep(uint64_t cycle) noexcept;
+    uint16_t calculateSweep(uint64_t cycle) noexcept;
+
+    void trigger(int index, uint64_t cycle) noexcept;
+    void powerOff(uint64_t cycle) noexcept;
+
+    bool isPowered(void) const noexcept;
+    bool isDACEnabled(int index) const noexcept;
+    int getChannelLevel(int index) const noexcept;
+    void updateOutput(int index, uint64_t cycle) noexcept;
+    void updateAllOutputs(uint64_t cycle) noexcept;
+    void addDelta(int side, uint64_t cycle, int32_t delta) noexcept;
+};
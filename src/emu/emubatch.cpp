@@ -0,0 +1,326 @@
+/**
+ * @file emu/emubatch.cpp
+ * @brief Steps many independent systems at once on a pool of threads
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "emubatch.hpp"
+#include <algorithm>
+#include "emusys.hpp"
+
+/**
+ * @brief Starts the pool's threads.
+ * @param thread_count Threads to step on, counting the caller's. 0 for one
+ * per core.
+ */
+EmuBatch::EmuBatch(unsigned int thread_count)
+{
+    if(thread_count == 0)
+    {
+        thread_count = std::thread::hardware_concurrency();
+    }
+    thread_count = std::max(thread_count, 1u);
+
+    shares.assign(thread_count + 1, 0);
+    poolFrames.resize(thread_count);
+
+    try
+    {
+        workers.reserve(thread_count - 1);
+        for(unsigned int thread = 1; thread < thread_count; thread++)
+        {
+            workers.emplace_back(&EmuBatch::work, this, thread);
+        }
+    } catch(...)
+    {
+        stopWorkers();
+        throw;
+    }
+}
+
+/**
+ * @brief Stops the pool's threads, and gives the systems back their input
+ * sources.
+ */
+EmuBatch::~EmuBatch()
+{
+    stopWorkers();
+    releaseSystems();
+}
+
+
+
+/**
+ * @brief Sets the systems to step, which must outlive the batch or the next
+ * call. Each takes its input from the batch until then, and threaded
+ * rendering is turned off, since the pool is the parallelism.
+ * @param systems
+ */
+void EmuBatch::setSystems(const std::vector<EmuSys*>& systems)
+{
+    releaseSystems();
+
+    this->systems = systems;
+    inputs.assign(systems.size(), HeldInput());
+    previousInputs.resize(systems.size());
+
+    for(size_t i = 0; i < systems.size(); i++)
+    {
+        previousInputs[i] = systems[i]->getInputSource();
+        systems[i]->setInputSource(&inputs[i]);
+        systems[i]->setThreadedRendering(false);
+    }
+
+    size_t thread_count = shares.size() - 1;
+    for(size_t thread = 0; thread <= thread_count; thread++)
+    {
+        shares[thread] = (systems.size() * thread) / thread_count;
+    }
+
+    observations.clear();
+    if(observationShape != nullptr)
+    {
+        observations.assign(systems.size(), *observationShape);
+    }
+}
+
+
+
+size_t EmuBatch::getSystemCount(void) const noexcept
+{
+    return systems.size();
+}
+
+
+
+unsigned int EmuBatch::getThreadCount(void) const noexcept
+{
+    return static_cast<unsigned int>(shares.size() - 1);
+}
+
+
+
+/**
+ * @brief Makes steps write a downsampled stack of frames per system instead
+ * of the whole frame. Stacks start empty.
+ * @param width
+ * @param height
+ * @param format
+ * @param stack_depth
+ * @param max_pool Whether each frame is pooled with the one before it.
+ * @throws std::invalid_argument on a size or depth out of range.
+ */
+void EmuBatch::setObservation(
+    int width,
+    int height,
+    ObservationFormat format,
+    unsigned int stack_depth,
+    bool max_pool
+)
+{
+    observationShape = std::make_unique<EmuObservation>(
+        width, height, format, stack_depth
+    );
+    observations.assign(systems.size(), *observationShape);
+    maxPool = max_pool;
+
+    for(std::vector<uint8_t>& frame : poolFrames)
+    {
+        frame.resize(max_pool ? LCD_WIDTH * LCD_HEIGHT : 0);
+    }
+}
+
+
+
+/**
+ * @brief Makes steps write whole frames again.
+ */
+void EmuBatch::clearObservation(void) noexcept
+{
+    observationShape.reset();
+    observations.clear();
+    maxPool = false;
+}
+
+
+
+/**
+ * @brief Empties one system's stack, e.g. when its episode restarts.
+ * @param index
+ */
+void EmuBatch::resetObservation(size_t index) noexcept
+{
+    if(index < observations.size()) { observations[index].clear(); }
+}
+
+
+
+/**
+ * @brief Returns the bytes a step writes per system.
+ */
+size_t EmuBatch::getObservationSize(void) const noexcept
+{
+    if(observationShape != nullptr) { return observationShape->getSize(); }
+    return LCD_WIDTH * LCD_HEIGHT;
+}
+
+
+
+/**
+ * @brief Runs every system for a number of frames with its buttons held,
+ * then writes the last frame each one completed, or its stack, into
+ * observations. Only the frames shown are composed. Each system's audio
+ * from the last step is dropped, so what's left to read is this step's.
+ * @param buttons One JoypadButton bitmask per system.
+ * @param frames
+ * @param observations Room for getSystemCount() * getObservationSize()
+ * bytes, in system order. nullptr to skip.
+ * @throws std::runtime_error on system not running. The other systems
+ * still run.
+ */
+void EmuBatch::step(
+    const uint8_t* buttons,
+    unsigned int frames,
+    uint8_t* observations
+)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stepButtons = buttons;
+        stepFrames = frames;
+        stepObservations = observations;
+        stepError = nullptr;
+        pending = static_cast<unsigned int>(workers.size());
+        generation++;
+    }
+    stepStarted.notify_all();
+
+    runShare(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    stepFinished.wait(lock, [&]() { return pending == 0; });
+
+    if(stepError != nullptr) { std::rethrow_exception(stepError); }
+}
+
+
+
+void EmuBatch::stopWorkers(void) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    stepStarted.notify_all();
+
+    for(std::thread& worker : workers) { worker.join(); }
+    workers.clear();
+}
+
+
+
+/**
+ * @brief Points the systems back at their own input sources.
+ */
+void EmuBatch::releaseSystems(void) noexcept
+{
+    for(size_t i = 0; i < systems.size(); i++)
+    {
+        systems[i]->setInputSource(previousInputs[i]);
+    }
+
+    systems.clear();
+}
+
+
+
+void EmuBatch::work(unsigned int thread) noexcept
+{
+    uint64_t seen = 0;
+
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            stepStarted.wait(lock, [&]()
+            {
+                return stopping || generation != seen;
+            });
+            if(stopping) { return; }
+            seen = generation;
+        }
+
+        runShare(thread);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            last = --pending == 0;
+        }
+        if(last) { stepFinished.notify_one(); }
+    }
+}
+
+
+
+void EmuBatch::runShare(unsigned int thread) noexcept
+{
+    size_t observation_size = getObservationSize();
+    uint8_t* pool_frame = maxPool ? poolFrames[thread].data() : nullptr;
+
+    // The PPU decides whether to compose a frame when it starts, which can
+    // be in the system frame before the one shown.
+    unsigned int composed = maxPool ? 3 : 2;
+
+    for(size_t i = shares[thread]; i < shares[thread + 1]; i++)
+    {
+        EmuSys* sys = systems[i];
+        unsigned int render_interval = sys->getRenderInterval();
+        const uint8_t* previous = nullptr;
+
+        try
+        {
+            sys->discardAudio();
+            inputs[i].setButtons(stepButtons[i]);
+
+            for(unsigned int frame = 0; frame < stepFrames; frame++)
+            {
+                bool shown = stepObservations != nullptr
+                    && frame + composed >= stepFrames;
+                sys->setRenderInterval(shown ? render_interval : 0);
+
+                if(pool_frame != nullptr && frame + 1 == stepFrames)
+                {
+                    const uint8_t* last = sys->getFrameBuffer();
+                    std::copy(
+                        last, last + (LCD_WIDTH * LCD_HEIGHT), pool_frame
+                    );
+                    previous = pool_frame;
+                }
+
+                sys->runFrame();
+            }
+        } catch(...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(stepError == nullptr) { stepError = std::current_exception(); }
+        }
+
+        sys->setRenderInterval(render_interval);
+
+        if(stepObservations == nullptr) { continue; }
+
+        uint8_t* dest = stepObservations + (i * observation_size);
+        const uint8_t* frame = sys->getFrameBuffer();
+
+        if(!observations.empty())
+        {
+            observations[i].push(frame, previous);
+            observations[i].read(dest);
+        } else
+        {
+            std::copy(frame, frame + observation_size, dest);
+        }
+    }
+}
@@ -0,0 +1,148 @@
+/**
+ * @file emu/emubatch.hpp
+ * @brief Steps many independent systems at once on a pool of threads
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "emuinput.hpp"
+#include "emuobservation.hpp"
+
+class EmuSys;
+
+/**
+ * @brief Steps a set of independent systems together, for callers that
+ * drive hundreds of them in lockstep, e.g. training agents.
+ *
+ * Systems are split into one contiguous share per thread when they're set,
+ * and each thread steps the same share every time, so a system's memory
+ * stays in one core's cache. A step wakes each thread once, not once per
+ * system, and the caller's thread steps the first share itself.
+ */
+class EmuBatch
+{
+public:
+    /**
+     * @brief Starts the pool's threads.
+     * @param thread_count Threads to step on, counting the caller's. 0 for
+     * one per core.
+     */
+    explicit EmuBatch(unsigned int thread_count = 0);
+
+    /**
+     * @brief Stops the pool's threads, and gives the systems back their
+     * input sources.
+     */
+    ~EmuBatch();
+
+    EmuBatch(const EmuBatch&) = delete;
+    EmuBatch& operator=(const EmuBatch&) = delete;
+
+    /**
+     * @brief Sets the systems to step, which must outlive the batch or the
+     * next call. Each takes its input from the batch until then, and
+     * threaded rendering is turned off, since the pool is the parallelism.
+     * @param systems
+     */
+    void setSystems(const std::vector<EmuSys*>& systems);
+
+    size_t getSystemCount(void) const noexcept;
+    unsigned int getThreadCount(void) const noexcept;
+
+    /**
+     * @brief Makes steps write a downsampled stack of frames per system
+     * instead of the whole frame. Stacks start empty.
+     * @param width
+     * @param height
+     * @param format
+     * @param stack_depth
+     * @param max_pool Whether each frame is pooled with the one before it.
+     * @throws std::invalid_argument on a size or depth out of range.
+     */
+    void setObservation(
+        int width,
+        int height,
+        ObservationFormat format,
+        unsigned int stack_depth,
+        bool max_pool
+    );
+
+    /**
+     * @brief Makes steps write whole frames again.
+     */
+    void clearObservation(void) noexcept;
+
+    /**
+     * @brief Empties one system's stack, e.g. when its episode restarts.
+     * @param index
+     */
+    void resetObservation(size_t index) noexcept;
+
+    /**
+     * @brief Returns the bytes a step writes per system.
+     */
+    size_t getObservationSize(void) const noexcept;
+
+    /**
+     * @brief Runs every system for a number of frames with its buttons
+     * held, then writes the last frame each one completed, or its stack,
+     * into observations. Only the frames shown are composed. Each system's
+     * audio from the last step is dropped, so what's left to read is this
+     * step's.
+     * @param buttons One JoypadButton bitmask per system.
+     * @param frames
+     * @param observations Room for getSystemCount() * getObservationSize()
+     * bytes, in system order. nullptr to skip.
+     * @throws std::runtime_error on system not running. The other systems
+     * still run.
+     */
+    void step(
+        const uint8_t* buttons,
+        unsigned int frames,
+        uint8_t* observations
+    );
+
+private:
+    std::vector<EmuSys*> systems;
+    std::vector<HeldInput> inputs;
+    std::vector<InputSource*> previousInputs;
+
+    // One per system when observing, otherwise frames are written whole.
+    std::unique_ptr<EmuObservation> observationShape;
+    std::vector<EmuObservation> observations;
+    bool maxPool = false;
+    // The frame before the last of a step, per thread, for max pooling
+    std::vector<std::vector<uint8_t>> poolFrames;
+
+    // Thread t steps systems [shares[t], shares[t + 1]).
+    std::vector<size_t> shares;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable stepStarted;
+    std::condition_variable stepFinished;
+    uint64_t generation = 0;
+    unsigned int pending = 0;
+    bool stopping = false;
+
+    // The step being run, set before workers are woken
+    const uint8_t* stepButtons = nullptr;
+    unsigned int stepFrames = 0;
+    uint8_t* stepObservations = nullptr;
+    std::exception_ptr stepError;
+
+    void stopWorkers(void) noexcept;
+    void releaseSystems(void) noexcept;
+    void work(unsigned int thread) noexcept;
+    void runShare(unsigned int thread) noexcept;
+};
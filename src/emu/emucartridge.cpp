@@ -7,6 +7,7 @@
 
 #include "emucartridge.hpp"
 #include <assert.h>
+#include <sstream>
 #include <fmt/core.h>
 #include "../logger.hpp"
 
@@ -17,6 +18,19 @@ EmuCartridge::EmuCartridge(EmuMemory* memory)
 
 
 
+/**
+ * @brief Copies the loaded ROM's details. The copy has no file open, and
+ * points at the same memory until told otherwise.
+ * @param other
+ */
+EmuCartridge::EmuCartridge(const EmuCartridge& other) :
+    mem(other.mem),
+    ROMFilePath(other.ROMFilePath),
+    ROMName(other.ROMName)
+{}
+
+
+
 EmuCartridge::~EmuCartridge()
 {
 }
@@ -79,16 +93,77 @@ void EmuCartridge::loadROM(std::filesystem::path file_path)
 
     ROMFilePath = file_path;
 
+    try
+    {
+        readROM(ROMFile);
+    } catch(...)
+    {
+        ROMFile.close();
+        throw;
+    }
+
+    ROMFile.close();
+}
+
+
+
+/**
+ * @brief Loads a ROM image from memory. Battery-backed RAM starts empty and
+ * isn't saved, since there's no file to save it next to.
+ * @param data
+ * @param size
+ * @throws std::runtime_error if memory pointer is null.
+ * @throws std::runtime_error on invalid ROM.
+ */
+void EmuCartridge::loadROM(const uint8_t* data, size_t size)
+{
+    logMessage(fmt::format(
+        "Attempting to load rom from {} bytes in memory...", size
+    ),
+        LOG_INFO
+    );
+
+    if(mem == nullptr)
+    {
+        throw std::runtime_error("Cannot load ROM into null memory pointer!");
+    }
+
+    ROMFilePath.clear();
+
+    // Loading isn't on any hot path, so one copy into a stream is fine.
+    std::istringstream rom(
+        std::string(reinterpret_cast<const char*>(data), size),
+        std::ios_base::in | std::ios_base::binary
+    );
+    readROM(rom);
+}
+
+
+
+/**
+ * @brief Reads a ROM image into memory, and sets up ERAM.
+ * @param rom
+ * @throws std::runtime_error on invalid ROM.
+ */
+void EmuCartridge::readROM(std::istream& rom)
+{
+    using namespace std::filesystem;
+
     // Pull header info
 
     std::array<uint8_t, 80> header;
-    ROMFile.seekg(0x100);
-    ROMFile.read(reinterpret_cast<char*>(header.data()), 80);
-    ROMFile.seekg(0);
+    rom.seekg(0x100);
+    rom.read(reinterpret_cast<char*>(header.data()), 80);
+
+    if(!rom)
+    {
+        throw std::runtime_error("ROM is too small to have a header!");
+    }
+
+    rom.seekg(0);
 
     if(!validateHeader(header))
     {
-        ROMFile.close();
         throw std::runtime_error("ROM header is invalid!");
     }
 
@@ -112,8 +187,11 @@ void EmuCartridge::loadROM(std::filesystem::path file_path)
     case NONE_BAT_RAM: case MBC1_BAT_RAM: case MBC2_BAT: case MBC3_BAT_RAM:
     case MBC3_BAT_RAM_TIMER: case MBC5_BAT_RAM: case MBC5_RUMBLE_BAT_RAM:
     {
-        persistent_ram = true;
-        sav_file_path = EmuMemory::getSAVPath(ROMFilePath);
+        persistent_ram = !ROMFilePath.empty();
+        if(persistent_ram)
+        {
+            sav_file_path = EmuMemory::getSAVPath(ROMFilePath);
+        }
         break;
     }
     default:
@@ -158,8 +236,7 @@ void EmuCartridge::loadROM(std::filesystem::path file_path)
 
     // ROM0 is a single bank
     std::vector<uint8_t> ROM0_data(ROM0_SIZE);
-    assert(ROMFile.is_open());
-    ROMFile.read(reinterpret_cast<char*>(ROM0_data.data()), ROM0_SIZE);
+    rom.read(reinterpret_cast<char*>(ROM0_data.data()), ROM0_SIZE);
 
     MemoryBank ROM0(ROM0_START, ROM0_END);
     ROM0.loadData(ROM0_data);
@@ -171,8 +248,7 @@ void EmuCartridge::loadROM(std::filesystem::path file_path)
     for(size_t i = 0; i < rom_bank_count; i++)
     {
         std::vector<uint8_t> data(ROM1_SIZE);
-        assert(ROMFile.is_open());
-        ROMFile.read(reinterpret_cast<char*>(data.data()), ROM1_SIZE);
+        rom.read(reinterpret_cast<char*>(data.data()), ROM1_SIZE);
 
         MemoryBank bank(ROM1_START, ROM1_END);
         bank.loadData(data);
@@ -230,7 +306,6 @@ void EmuCartridge::loadROM(std::filesystem::path file_path)
     mem->initERAM(ram_bank_count, 0, persistent_ram, ERAM_data);
 
     if(SAVFile.is_open()) { SAVFile.close(); }
-    ROMFile.close();
 
     logMessage("Successfully loaded ROM.", LOG_INFO);
 }
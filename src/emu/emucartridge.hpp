@@ -18,6 +18,14 @@ class EmuCartridge
 {
 public:
     EmuCartridge(EmuMemory* memory);
+
+    /**
+     * @brief Copies the loaded ROM's details. The copy has no file open, and
+     * points at the same memory until told otherwise.
+     * @param other
+     */
+    EmuCartridge(const EmuCartridge& other);
+
     ~EmuCartridge();
 
     void setMemoryPointer(EmuMemory* memory);
@@ -31,6 +39,16 @@ public:
      */
     void loadROM(std::filesystem::path file_path);
 
+    /**
+     * @brief Loads a ROM image from memory. Battery-backed RAM starts empty
+     * and isn't saved, since there's no file to save it next to.
+     * @param data
+     * @param size
+     * @throws std::runtime_error if memory pointer is null.
+     * @throws std::runtime_error on invalid ROM.
+     */
+    void loadROM(const uint8_t* data, size_t size);
+
     /**
      * @brief Returns the loaded ROM name.
      */
@@ -42,6 +60,13 @@ private:
     std::filesystem::path ROMFilePath;
     std::string ROMName = "NOGAME";
 
+    /**
+     * @brief Reads a ROM image into memory, and sets up ERAM.
+     * @param rom
+     * @throws std::runtime_error on invalid ROM.
+     */
+    void readROM(std::istream& rom);
+
     /**
      * @brief Checks if a given ROM header is valid.
      * @param header
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <fmt/core.h>
 #include "../logger.hpp"
+#include "emustate.hpp"
 #include "emusys.hpp"
 
 EmuCPU::EmuCPU(EmuMemory* memory, EmuSys* parent_sys)
@@ -3452,7 +3453,10 @@ int EmuCPU::step(bool log_instruction)
  */
 void EmuCPU::initRegs(void)
 {
-    // TEMP: Handled by RegisterSet. Will be put into data structure.
+    // TEMP: CPU registers are only set by RegisterSet when it's created.
+    // I/O registers are set here too, so a restart doesn't keep the last
+    // run's, and devices reset after this start from the post-boot values.
+    regs.mem.io = RegisterSet().mem.io;
 }
 
 
@@ -3467,6 +3471,44 @@ RegisterSet* EmuCPU::getRegsPtr(void)
 
 
 
+EmuCPU::State EmuCPU::getState(void) const noexcept
+{
+    return State{
+        regs.cpu, regs.mem, regs.flags, regs.imaster, nextInterruptState
+    };
+}
+
+
+
+void EmuCPU::setState(const State& saved) noexcept
+{
+    regs.cpu = saved.cpu;
+    regs.mem = saved.mem;
+    regs.flags = saved.flags;
+    regs.imaster = saved.imaster;
+    nextInterruptState = saved.nextInterruptState;
+}
+
+
+
+/**
+ * @brief Checks a saved state read from a file before it is set.
+ * @param saved
+ * @throws std::runtime_error if a field is out of range.
+ */
+void EmuCPU::checkState(const State& saved)
+{
+    StateReader::checkBool("CPU ", "zero flag", saved.flags.zero);
+    StateReader::checkBool("CPU ", "sub flag", saved.flags.sub);
+    StateReader::checkBool("CPU ", "half carry flag", saved.flags.half_carry);
+    StateReader::checkBool("CPU ", "carry flag", saved.flags.carry);
+    StateReader::checkBool(
+        "CPU ", "next interrupt state", saved.nextInterruptState
+    );
+}
+
+
+
 /**
  * @brief Sets a breakpoint at a given address.
  * @param address
@@ -58,6 +58,27 @@ public:
     */
     void sendInterrupt(uint8_t bit);
 
+    // Everything needed to resume emulation exactly. Breakpoints are
+    // debugger settings, not state.
+    struct State
+    {
+        decltype(RegisterSet::cpu) cpu;
+        decltype(RegisterSet::mem) mem;
+        decltype(RegisterSet::flags) flags;
+        uint8_t imaster;
+        bool nextInterruptState;
+    };
+
+    State getState(void) const noexcept;
+    void setState(const State& saved) noexcept;
+
+    /**
+     * @brief Checks a saved state read from a file before it is set.
+     * @param saved
+     * @throws std::runtime_error if a field is out of range.
+     */
+    static void checkState(const State& saved);
+
 private:
     RegisterSet regs;
     EmuMemory* mem;
@@ -0,0 +1,282 @@
+/**
+ * @file emu/emuinput.cpp
+ * @brief Supplies joypad input to the emulated system, frame by frame
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "emuinput.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <fmt/core.h>
+
+constexpr const char* INPUT_FILE_HEADER = "# IMGBE input v1";
+
+// Names in bit order
+constexpr const char* BUTTON_NAMES[8] =
+{
+    "RIGHT", "LEFT", "UP", "DOWN", "A", "B", "SELECT", "START",
+};
+
+
+
+uint8_t HeldInput::getButtons(uint64_t) noexcept
+{
+    return buttons;
+}
+
+
+
+/**
+ * @brief Sets the buttons held from the next frame on.
+ * @param buttons JoypadButton bitmask
+ */
+void HeldInput::setButtons(uint8_t buttons) noexcept
+{
+    this->buttons = buttons;
+}
+
+
+
+InputStream::InputStream()
+{}
+
+InputStream::~InputStream()
+{}
+
+
+
+uint8_t InputStream::getButtons(uint64_t frame) noexcept
+{
+    if(changes.empty() || frame < changes.front().frame) { return 0; }
+
+    // Playback moves forward a frame at a time, so the change to use is
+    // nearly always the last one found or the one after it.
+    if(cursor >= changes.size() || changes[cursor].frame > frame)
+    {
+        cursor = 0;
+    }
+
+    if(cursor + 1 < changes.size() && changes[cursor + 1].frame <= frame)
+    {
+        auto next = std::upper_bound(
+            changes.begin() + cursor + 1, changes.end(), frame,
+            [](uint64_t value, const Change& change)
+            {
+                return value < change.frame;
+            }
+        );
+        cursor = (next - changes.begin()) - 1;
+    }
+
+    return changes[cursor].buttons;
+}
+
+
+
+/**
+ * @brief Sets the buttons held from a frame on. Anything already set for
+ * later frames is dropped, so recording over old frames replaces them.
+ * @param frame
+ * @param buttons JoypadButton bitmask
+ */
+void InputStream::setButtons(uint64_t frame, uint8_t buttons)
+{
+    while(!changes.empty() && changes.back().frame >= frame)
+    {
+        changes.pop_back();
+    }
+
+    uint8_t held = changes.empty() ? 0 : changes.back().buttons;
+    if(buttons != held) { changes.push_back({ frame, buttons }); }
+
+    cursor = 0;
+}
+
+
+
+/**
+ * @brief Removes all input.
+ */
+void InputStream::clear(void) noexcept
+{
+    changes.clear();
+    cursor = 0;
+}
+
+
+
+bool InputStream::isEmpty(void) const noexcept
+{
+    return changes.empty();
+}
+
+
+
+/**
+ * @brief Returns the frame of the last change, 0 if empty.
+ */
+uint64_t InputStream::getLastFrame(void) const noexcept
+{
+    return changes.empty() ? 0 : changes.back().frame;
+}
+
+
+
+/**
+ * @brief Replaces the stream with the contents of an input file.
+ * @param file_path
+ * @throws std::ios_base::failure on file error.
+ * @throws std::runtime_error on invalid file contents.
+ */
+void InputStream::loadFile(const std::filesystem::path& file_path)
+{
+    std::ifstream file(file_path);
+    if(!file.is_open())
+    {
+        throw std::ios_base::failure(fmt::format(
+            "Cannot open file {}!", file_path.string()
+        ));
+    }
+
+    std::vector<Change> loaded;
+    std::string line;
+    size_t line_number = 0;
+
+    while(std::getline(file, line))
+    {
+        line_number++;
+
+        size_t start = line.find_first_not_of(" \t\r");
+        if(start == std::string::npos || line[start] == '#') { continue; }
+
+        std::istringstream fields(line);
+        std::string frame_text;
+        std::string buttons_text;
+        fields >> frame_text >> buttons_text;
+
+        try
+        {
+            if(buttons_text.empty()
+               || frame_text.find_first_not_of("0123456789")
+                   != std::string::npos)
+            {
+                throw std::invalid_argument("expected <frame> <buttons>");
+            }
+
+            uint64_t frame = std::stoull(frame_text);
+            if(!loaded.empty() && frame <= loaded.back().frame)
+            {
+                throw std::invalid_argument("frames must increase");
+            }
+
+            loaded.push_back({ frame, parseButtons(buttons_text) });
+        } catch(std::logic_error& ex)
+        {
+            throw std::runtime_error(fmt::format(
+                "Invalid input file {} at line {}: {}",
+                file_path.string(), line_number, ex.what()
+            ));
+        }
+    }
+
+    changes = std::move(loaded);
+    cursor = 0;
+}
+
+
+
+/**
+ * @brief Writes the stream to an input file.
+ * @param file_path
+ * @throws std::ios_base::failure on file error.
+ */
+void InputStream::saveFile(const std::filesystem::path& file_path) const
+{
+    std::ofstream file(file_path);
+    if(!file.is_open())
+    {
+        throw std::ios_base::failure(fmt::format(
+            "Cannot open file {}!", file_path.string()
+        ));
+    }
+
+    file << INPUT_FILE_HEADER << '\n';
+    for(const Change& change : changes)
+    {
+        file << change.frame << ' ' << formatButtons(change.buttons) << '\n';
+    }
+
+    if(!file)
+    {
+        throw std::ios_base::failure(fmt::format(
+            "Cannot write file {}!", file_path.string()
+        ));
+    }
+}
+
+
+
+/**
+ * @brief Formats a button mask as it appears in input files, e.g. "A+START".
+ * @param buttons JoypadButton bitmask
+ */
+std::string formatButtons(uint8_t buttons)
+{
+    if(buttons == 0) { return "-"; }
+
+    std::string text;
+    for(int i = 0; i < 8; i++)
+    {
+        if(((buttons >> i) & 1) == 0) { continue; }
+        if(!text.empty()) { text += '+'; }
+        text += BUTTON_NAMES[i];
+    }
+
+    return text;
+}
+
+
+
+/**
+ * @brief Parses buttons as they appear in input files.
+ * @param text
+ * @returns JoypadButton bitmask
+ * @throws std::invalid_argument on an unknown button name.
+ */
+uint8_t parseButtons(const std::string& text)
+{
+    if(text == "-") { return 0; }
+
+    uint8_t buttons = 0;
+    size_t start = 0;
+
+    while(start <= text.size())
+    {
+        size_t end = text.find('+', start);
+        if(end == std::string::npos) { end = text.size(); }
+
+        std::string name = text.substr(start, end - start);
+        std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+        auto found = std::find_if(
+            std::begin(BUTTON_NAMES), std::end(BUTTON_NAMES),
+            [&name](const char* button) { return name == button; }
+        );
+
+        if(found == std::end(BUTTON_NAMES))
+        {
+            throw std::invalid_argument(fmt::format(
+                "unknown button \"{}\"", name
+            ));
+        }
+
+        buttons |= 1 << (found - std::begin(BUTTON_NAMES));
+        start = end + 1;
+    }
+
+    return buttons;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file emu/emuinput.hpp
+ * @brief Supplies joypad input to the emulated system, frame by frame
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "emujoypad.hpp"
+
+/**
+ * @brief Anything that can say which buttons are held on a given frame.
+ * The system asks once at the start of every frame it runs.
+ */
+class InputSource
+{
+public:
+    virtual ~InputSource() = default;
+
+    /**
+     * @brief Returns the buttons held for a frame.
+     * @param frame Frames run since the system started.
+     * @returns JoypadButton bitmask
+     */
+    virtual uint8_t getButtons(uint64_t frame) noexcept = 0;
+};
+
+/**
+ * @brief The same buttons on every frame until they're changed, for input
+ * decided as the system runs.
+ */
+class HeldInput : public InputSource
+{
+public:
+    uint8_t getButtons(uint64_t frame) noexcept override;
+
+    /**
+     * @brief Sets the buttons held from the next frame on.
+     * @param buttons JoypadButton bitmask
+     */
+    void setButtons(uint8_t buttons) noexcept;
+
+private:
+    uint8_t buttons = 0;
+};
+
+/**
+ * @brief Input kept in memory as the frames where the held buttons change.
+ * Used to record input and to replay it exactly, from code or from a file.
+ *
+ * Files are text, one change per line as "<frame> <buttons>", where buttons
+ * are names joined by '+' (RIGHT, LEFT, UP, DOWN, A, B, SELECT, START) or
+ * '-' for none. Lines starting with '#' are comments.
+ */
+class InputStream : public InputSource
+{
+public:
+    InputStream();
+    ~InputStream();
+
+    uint8_t getButtons(uint64_t frame) noexcept override;
+
+    /**
+     * @brief Sets the buttons held from a frame on. Anything already set for
+     * later frames is dropped, so recording over old frames replaces them.
+     * @param frame
+     * @param buttons JoypadButton bitmask
+     */
+    void setButtons(uint64_t frame, uint8_t buttons);
+
+    /**
+     * @brief Removes all input.
+     */
+    void clear(void) noexcept;
+
+    bool isEmpty(void) const noexcept;
+
+    /**
+     * @brief Returns the frame of the last change, 0 if empty.
+     */
+    uint64_t getLastFrame(void) const noexcept;
+
+    /**
+     * @brief Replaces the stream with the contents of an input file.
+     * @param file_path
+     * @throws std::ios_base::failure on file error.
+     * @throws std::runtime_error on invalid file contents.
+     */
+    void loadFile(const std::filesystem::path& file_path);
+
+    /**
+     * @brief Writes the stream to an input file.
+     * @param file_path
+     * @throws std::ios_base::failure on file error.
+     */
+    void saveFile(const std::filesystem::path& file_path) const;
+
+private:
+    struct Change
+    {
+        uint64_t frame;
+        uint8_t buttons;
+    };
+
+    // Sorted by frame, no two in a row with the same buttons
+    std::vector<Change> changes;
+    // Index of the last change looked up, frames are usually sequential
+    size_t cursor = 0;
+};
+
+/**
+ * @brief Formats a button mask as it appears in input files, e.g. "A+START".
+ * @param buttons JoypadButton bitmask
+ */
+std::string formatButtons(uint8_t buttons);
+
+/**
+ * @brief Parses buttons as they appear in input files.
+ * @param text
+ * @returns JoypadButton bitmask
+ * @throws std::invalid_argument on an unknown button name.
+ */
+uint8_t parseButtons(const std::string& text);
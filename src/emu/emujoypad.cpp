@@ -0,0 +1,128 @@
+/**
+ * @file emu/emujoypad.cpp
+ * @brief Implements the system's joypad
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "emujoypad.hpp"
+
+// Row select bits are active low
+constexpr uint8_t SELECT_DIRECTIONS = 1 << 4;
+constexpr uint8_t SELECT_ACTIONS = 1 << 5;
+constexpr uint8_t SELECT_MASK = SELECT_DIRECTIONS | SELECT_ACTIONS;
+constexpr uint8_t JOYPAD_UNUSED = 0xC0;
+constexpr uint8_t JOYPAD_INTERRUPT = 1 << 4;
+
+
+
+EmuJoypad::EmuJoypad(RegisterSet* registers)
+{
+    regs = registers;
+}
+
+EmuJoypad::~EmuJoypad()
+{}
+
+
+
+void EmuJoypad::setRegisters(RegisterSet* registers)
+{
+    regs = registers;
+}
+
+
+
+/**
+ * @brief Releases all buttons and deselects both rows.
+ */
+void EmuJoypad::reset(void) noexcept
+{
+    state.pressed = 0;
+    if(regs != nullptr) { regs->mem.io.joyp = JOYPAD_UNUSED | SELECT_MASK; }
+}
+
+
+
+/**
+ * @brief Reads JOYP. Pressed buttons in selected rows read as 0.
+ */
+uint8_t EmuJoypad::readRegister(void) const noexcept
+{
+    if(regs == nullptr) { return 0xFF; }
+
+    return JOYPAD_UNUSED | (regs->mem.io.joyp & SELECT_MASK) | getLines();
+}
+
+
+
+/**
+ * @brief Writes JOYP's row select bits.
+ * @param value
+ */
+void EmuJoypad::writeRegister(uint8_t value) noexcept
+{
+    if(regs == nullptr) { return; }
+
+    uint8_t old_lines = getLines();
+    regs->mem.io.joyp = JOYPAD_UNUSED | (value & SELECT_MASK);
+    updateLines(old_lines);
+}
+
+
+
+/**
+ * @brief Sets which buttons are held. Requests the joypad interrupt if a
+ * line in a selected row goes low.
+ * @param buttons JoypadButton bitmask
+ */
+void EmuJoypad::setButtons(uint8_t buttons) noexcept
+{
+    if(buttons == state.pressed) { return; }
+
+    uint8_t old_lines = getLines();
+    state.pressed = buttons;
+    if(regs != nullptr) { updateLines(old_lines); }
+}
+
+
+
+uint8_t EmuJoypad::getButtons(void) const noexcept
+{
+    return state.pressed;
+}
+
+
+
+/**
+ * @brief Returns JOYP's low nibble, where a 0 is a pressed button in a
+ * selected row.
+ */
+uint8_t EmuJoypad::getLines(void) const noexcept
+{
+    if(regs == nullptr) { return 0x0F; }
+
+    uint8_t select = regs->mem.io.joyp;
+    uint8_t low = 0;
+    if((select & SELECT_DIRECTIONS) == 0) { low |= state.pressed & 0x0F; }
+    if((select & SELECT_ACTIONS) == 0) { low |= state.pressed >> 4; }
+
+    return static_cast<uint8_t>(~low & 0x0F);
+}
+
+
+
+/**
+ * @brief Stores the lines in JOYP, and requests the interrupt on any
+ * falling edge.
+ */
+void EmuJoypad::updateLines(uint8_t old_lines) noexcept
+{
+    uint8_t lines = getLines();
+    regs->mem.io.joyp = (regs->mem.io.joyp & ~0x0F) | lines;
+
+    if((old_lines & ~lines) != 0)
+    {
+        regs->mem.io.iflag |= JOYPAD_INTERRUPT;
+    }
+}
@@ -0,0 +1,80 @@
+/**
+ * @file emu/emujoypad.hpp
+ * @brief Implements the system's joypad
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "emuregisters.hpp"
+
+constexpr uint16_t JOYPAD_REG = 0xFF00;
+
+// Pressed buttons as a bitmask. Directions are the low nibble and actions
+// the high nibble, in the order JOYP reports them.
+enum JoypadButton : uint8_t
+{
+    JOYPAD_RIGHT = 1 << 0,
+    JOYPAD_LEFT = 1 << 1,
+    JOYPAD_UP = 1 << 2,
+    JOYPAD_DOWN = 1 << 3,
+    JOYPAD_A = 1 << 4,
+    JOYPAD_B = 1 << 5,
+    JOYPAD_SELECT = 1 << 6,
+    JOYPAD_START = 1 << 7,
+};
+
+/**
+ * @brief Emulates JOYP. Buttons are set from outside once per frame, and
+ * the register is worked out from them and the selected row when read.
+ */
+class EmuJoypad
+{
+public:
+    EmuJoypad(RegisterSet* registers = nullptr);
+    ~EmuJoypad();
+
+    void setRegisters(RegisterSet* registers);
+
+    /**
+     * @brief Releases all buttons and deselects both rows.
+     */
+    void reset(void) noexcept;
+
+    /**
+     * @brief Reads JOYP. Pressed buttons in selected rows read as 0.
+     */
+    uint8_t readRegister(void) const noexcept;
+
+    /**
+     * @brief Writes JOYP's row select bits.
+     * @param value
+     */
+    void writeRegister(uint8_t value) noexcept;
+
+    /**
+     * @brief Sets which buttons are held. Requests the joypad interrupt if a
+     * line in a selected row goes low.
+     * @param buttons JoypadButton bitmask
+     */
+    void setButtons(uint8_t buttons) noexcept;
+
+    uint8_t getButtons(void) const noexcept;
+
+    // Everything needed to resume emulation exactly.
+    struct State
+    {
+        // JoypadButton bitmask
+        uint8_t pressed;
+    };
+
+    State state{};
+
+private:
+    RegisterSet* regs;
+
+    uint8_t getLines(void) const noexcept;
+    void updateLines(uint8_t old_lines) noexcept;
+};
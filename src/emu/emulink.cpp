@@ -0,0 +1,87 @@
+/**
+ * @file emu/emulink.cpp
+ * @brief Connects two emulated systems with a link cable
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "emulink.hpp"
+#include <algorithm>
+#include "emusys.hpp"
+
+/**
+ * @brief Connects two systems' serial ports. Both must outlive the link.
+ * @param first
+ * @param second
+ */
+EmuLink::EmuLink(EmuSys* first, EmuSys* second) :
+    systems{ first, second }
+{
+    ports[0].remote = second;
+    ports[1].remote = first;
+    first->setSerialPeer(&ports[0]);
+    second->setSerialPeer(&ports[1]);
+}
+
+/**
+ * @brief Disconnects both serial ports.
+ */
+EmuLink::~EmuLink()
+{
+    systems[0]->setSerialPeer(nullptr);
+    systems[1]->setSerialPeer(nullptr);
+}
+
+
+
+/**
+ * @brief Sets the most cycles either system runs per turn.
+ * @param cycles Clamped to at least 1.
+ */
+void EmuLink::setQuantum(uint64_t cycles) noexcept
+{
+    quantum = std::max<uint64_t>(cycles, 1);
+}
+
+
+
+uint64_t EmuLink::getQuantum(void) const noexcept
+{
+    return quantum;
+}
+
+
+
+/**
+ * @brief Runs both systems through one frame. A system that is paused or
+ * stopped sits out, and the other runs on without it.
+ * @throws std::runtime_error on system not running.
+ */
+void EmuLink::runFrame(void)
+{
+    bool done[2] = { false, false };
+
+    while(!done[0] || !done[1])
+    {
+        for(int i = 0; i < 2; i++)
+        {
+            if(done[i]) { continue; }
+
+            EmuSys* sys = systems[i];
+            if(!sys->isRunning() || sys->isPaused())
+            {
+                done[i] = true;
+                continue;
+            }
+
+            done[i] = sys->runFrameSlice(quantum);
+        }
+    }
+}
+
+
+
+uint8_t EmuLink::Port::exchange(uint8_t byte) noexcept
+{
+    return remote->receiveSerial(byte);
+}
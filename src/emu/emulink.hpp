@@ -0,0 +1,73 @@
+/**
+ * @file emu/emulink.hpp
+ * @brief Connects two emulated systems with a link cable
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "emuserial.hpp"
+
+class EmuSys;
+
+// Cycles each system runs before the other catches up. One serial bit.
+constexpr uint64_t LINK_DEFAULT_QUANTUM = 512;
+
+/**
+ * @brief A link cable between two systems in the same process. Systems run
+ * in turns of a bounded number of cycles rather than in lockstep, so
+ * neither is ever more than a quantum ahead when a transfer swaps bytes.
+ * Runs on one thread, and turns always go in the same order, so linked runs
+ * are deterministic.
+ */
+class EmuLink
+{
+public:
+    /**
+     * @brief Connects two systems' serial ports. Both must outlive the link.
+     * @param first
+     * @param second
+     */
+    EmuLink(EmuSys* first, EmuSys* second);
+
+    /**
+     * @brief Disconnects both serial ports.
+     */
+    ~EmuLink();
+
+    EmuLink(const EmuLink&) = delete;
+    EmuLink& operator=(const EmuLink&) = delete;
+
+    /**
+     * @brief Sets the most cycles either system runs per turn.
+     * @param cycles Clamped to at least 1.
+     */
+    void setQuantum(uint64_t cycles) noexcept;
+
+    uint64_t getQuantum(void) const noexcept;
+
+    /**
+     * @brief Runs both systems through one frame. A system that is paused
+     * or stopped sits out, and the other runs on without it.
+     * @throws std::runtime_error on system not running.
+     */
+    void runFrame(void);
+
+private:
+    /**
+     * @brief One end of the cable, which forwards to the system at the
+     * other end.
+     */
+    class Port : public SerialPeer
+    {
+    public:
+        EmuSys* remote = nullptr;
+        uint8_t exchange(uint8_t byte) noexcept override;
+    };
+
+    EmuSys* systems[2];
+    Port ports[2];
+    uint64_t quantum = LINK_DEFAULT_QUANTUM;
+};
@@ -6,9 +6,16 @@
  */
 
 #include "emumemory.hpp"
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 #include <fmt/core.h>
 #include "../logger.hpp"
+#include "emuppu.hpp"
+#include "emuapu.hpp"
+#include "emutimer.hpp"
+#include "emujoypad.hpp"
+#include "emuserial.hpp"
 
 EmuMemory::EmuMemory(RegisterSet* cpu_registers) :
     ROM0(ROM0_START, ROM0_END, false, true),
@@ -34,6 +41,10 @@ EmuMemory::EmuMemory(RegisterSet* cpu_registers) :
 EmuMemory::~EmuMemory()
 {}
 
+// Cartridge header, title through checksums, identifies the ROM.
+constexpr size_t ROM_HEADER_START = 0x0134;
+constexpr size_t ROM_HEADER_SIZE = 0x0150 - ROM_HEADER_START;
+
 
 
 /**
@@ -44,6 +55,30 @@ EmuMemory::~EmuMemory()
  */
 uint8_t EmuMemory::readByte(uint16_t address, bool ignore_illegal) const
 {
+    // Sound registers depend on how far the APU has run
+    if(APU != nullptr && address >= APU_REG_START && address <= APU_REG_END)
+    {
+        return APU->readRegister(address);
+    }
+
+    // DIV and TIMA are worked out from the cycle count
+    if(Timer != nullptr
+       && address >= TIMER_REG_START && address <= TIMER_REG_END)
+    {
+        return Timer->readRegister(address);
+    }
+
+    if(Joypad != nullptr && address == JOYPAD_REG)
+    {
+        return Joypad->readRegister();
+    }
+
+    if(Serial != nullptr
+       && address >= SERIAL_REG_START && address <= SERIAL_REG_END)
+    {
+        return Serial->readRegister(address);
+    }
+
     // Check if address is a memory register
     if(CPURegisters != nullptr)
     {
@@ -171,6 +206,32 @@ uint8_t EmuMemory::readByte(uint16_t address, bool ignore_illegal) const
  */
 void EmuMemory::writeByte(uint16_t address, uint8_t value)
 {
+    if(APU != nullptr && address >= APU_REG_START && address <= APU_REG_END)
+    {
+        APU->writeRegister(address, value);
+        return;
+    }
+
+    if(Timer != nullptr
+       && address >= TIMER_REG_START && address <= TIMER_REG_END)
+    {
+        Timer->writeRegister(address, value);
+        return;
+    }
+
+    if(Joypad != nullptr && address == JOYPAD_REG)
+    {
+        Joypad->writeRegister(value);
+        return;
+    }
+
+    if(Serial != nullptr
+       && address >= SERIAL_REG_START && address <= SERIAL_REG_END)
+    {
+        Serial->writeRegister(address, value);
+        return;
+    }
+
     // Check if address is a memory register
     if(CPURegisters != nullptr)
     {
@@ -196,6 +257,7 @@ void EmuMemory::writeByte(uint16_t address, uint8_t value)
     if(address >= VRAM_START && address <= VRAM_END)
     {
         VRAM.writeByte(address, value);
+        if(PPU != nullptr) { PPU->notifyVRAMWrite(address, value); }
         return;
     }
 
@@ -247,6 +309,7 @@ void EmuMemory::writeByte(uint16_t address, uint8_t value)
     else if(address >= OAM_START && address <= OAM_END)
     {
         OAM.writeByte(address, value);
+        if(PPU != nullptr) { PPU->notifyOAMWrite(address, value); }
         return;
     }
 
@@ -286,6 +349,127 @@ void EmuMemory::setCPURegisters(RegisterSet* cpu_registers)
 
 
 
+/**
+ * @brief Sets the PPU pointer, which is notified of VRAM and OAM writes
+ * @param ppu
+ */
+void EmuMemory::setPPU(EmuPPU* ppu)
+{
+    PPU = ppu;
+}
+
+
+
+/**
+ * @brief Sets the APU pointer, which handles sound register accesses
+ * @param apu
+ */
+void EmuMemory::setAPU(EmuAPU* apu)
+{
+    APU = apu;
+}
+
+
+
+/**
+ * @brief Sets the timer pointer, which handles timer register accesses
+ * @param timer
+ */
+void EmuMemory::setTimer(EmuTimer* timer)
+{
+    Timer = timer;
+}
+
+
+
+/**
+ * @brief Sets the joypad pointer, which handles JOYP accesses
+ * @param joypad
+ */
+void EmuMemory::setJoypad(EmuJoypad* joypad)
+{
+    Joypad = joypad;
+}
+
+
+
+/**
+ * @brief Sets the serial pointer, which handles SB and SC accesses
+ * @param serial
+ */
+void EmuMemory::setSerial(EmuSerial* serial)
+{
+    Serial = serial;
+}
+
+
+
+/**
+ * @brief Returns a pointer to the start of VRAM ($8000)
+ */
+const uint8_t* EmuMemory::getVRAMPtr(void) const noexcept
+{
+    return VRAM.getDataPtr();
+}
+
+
+
+/**
+ * @brief Returns a pointer to the start of OAM ($FE00)
+ */
+const uint8_t* EmuMemory::getOAMPtr(void) const noexcept
+{
+    return OAM.getDataPtr();
+}
+
+
+
+/**
+ * @brief Returns a pointer to the start of the RAM bank mapped at an
+ * address, for reading memory in place. Banked regions give the bank
+ * mapped now. Pointers are only valid until the memory is next copied.
+ * @param address
+ * @returns nullptr for ROM, echo RAM, registers, or unmapped ERAM.
+ */
+const uint8_t* EmuMemory::getBankPtr(uint16_t address) const noexcept
+{
+    if(address >= VRAM_START && address <= VRAM_END)
+    {
+        return VRAM.getDataPtr();
+    }
+
+    else if(address >= ERAM_START && address <= ERAM_END)
+    {
+        if(ERAMIndex >= ERAMBankCount) { return nullptr; }
+        return ERAM[ERAMIndex].getDataPtr();
+    }
+
+    else if(address >= WRAM0_START && address <= WRAM0_END)
+    {
+        return WRAM0.getDataPtr();
+    }
+
+    else if(address >= WRAM1_START && address <= WRAM1_END)
+    {
+        if(WRAM1Index >= WRAM1BankCount) { return nullptr; }
+        return WRAM1[WRAM1Index].getDataPtr();
+    }
+
+    else if(address >= OAM_START && address <= OAM_END)
+    {
+        return OAM.getDataPtr();
+    }
+
+    else if(address >= HRAM_START && address <= HRAM_END)
+    {
+        return HRAM.getDataPtr();
+    }
+
+    return nullptr;
+}
+
+
+
 /**
  * @brief Initializes ROM0 with a set of data.
  * @param data MemoryBank with range ROM0_START to ROM0_END.
@@ -500,6 +684,117 @@ std::filesystem::path EmuMemory::getSAVPath(
 
 
 
+/**
+ * @brief Adds all writable memory and the bank indices to a save state,
+ * and the ROM header to check it against on load.
+ * @param writer
+ */
+void EmuMemory::saveState(StateWriter& writer) const
+{
+    State state{
+        static_cast<uint32_t>(ROM1Index),
+        static_cast<uint32_t>(ERAMIndex),
+        static_cast<uint32_t>(WRAM1Index),
+    };
+    writer.write("MEM ", state);
+
+    writer.writeBlock(
+        "ROMH", ROM0.getDataPtr() + ROM_HEADER_START, ROM_HEADER_SIZE
+    );
+    writer.writeBlock("VRAM", VRAM.getDataPtr(), VRAM_SIZE);
+    writer.writeBlock("WRM0", WRAM0.getDataPtr(), WRAM0_SIZE);
+    writer.writeBlock("OAM ", OAM.getDataPtr(), OAM_SIZE);
+    writer.writeBlock("IOR ", IOREG.getDataPtr(), IOREG_SIZE);
+    writer.writeBlock("HRAM", HRAM.getDataPtr(), HRAM_SIZE);
+    writer.writeBlock("IE  ", IEREG.getDataPtr(), IEREG_SIZE);
+
+    uint8_t* wram1 = writer.addBlock("WRM1", WRAM1.size() * WRAM1_SIZE);
+    for(const MemoryBank& bank : WRAM1)
+    {
+        std::memcpy(wram1, bank.getDataPtr(), WRAM1_SIZE);
+        wram1 += WRAM1_SIZE;
+    }
+
+    uint8_t* eram = writer.addBlock("ERAM", ERAM.size() * ERAM_SIZE);
+    for(const MemoryBank& bank : ERAM)
+    {
+        std::memcpy(eram, bank.getDataPtr(), ERAM_SIZE);
+        eram += ERAM_SIZE;
+    }
+}
+
+
+
+/**
+ * @brief Restores memory from a save state. Nothing changes if it throws.
+ * @param reader
+ * @throws std::runtime_error if the state is for another ROM, is missing
+ * blocks, or has a bank index out of range.
+ */
+void EmuMemory::loadState(const StateReader& reader)
+{
+    const uint8_t* header = reader.readBlock("ROMH", ROM_HEADER_SIZE);
+    if(std::memcmp(
+        header, ROM0.getDataPtr() + ROM_HEADER_START, ROM_HEADER_SIZE
+    ) != 0)
+    {
+        throw std::runtime_error("Save state is for a different ROM!");
+    }
+
+    State state;
+    reader.read("MEM ", state);
+    StateReader::checkRange(
+        "MEM ", "ROM1 index", state.ROM1Index, ROM1BankCount
+    );
+    // Left at 0 when there are no banks.
+    StateReader::checkRange(
+        "MEM ", "ERAM index", state.ERAMIndex,
+        std::max<size_t>(ERAMBankCount, 1)
+    );
+    StateReader::checkRange(
+        "MEM ", "WRAM1 index", state.WRAM1Index, WRAM1BankCount
+    );
+
+    const uint8_t* vram = reader.readBlock("VRAM", VRAM_SIZE);
+    const uint8_t* wram0 = reader.readBlock("WRM0", WRAM0_SIZE);
+    const uint8_t* oam = reader.readBlock("OAM ", OAM_SIZE);
+    const uint8_t* ioreg = reader.readBlock("IOR ", IOREG_SIZE);
+    const uint8_t* hram = reader.readBlock("HRAM", HRAM_SIZE);
+    const uint8_t* iereg = reader.readBlock("IE  ", IEREG_SIZE);
+    const uint8_t* wram1 = reader.readBlock(
+        "WRM1", WRAM1.size() * WRAM1_SIZE
+    );
+    const uint8_t* eram = reader.readBlock("ERAM", ERAM.size() * ERAM_SIZE);
+
+    ROM1Index = state.ROM1Index;
+    ERAMIndex = state.ERAMIndex;
+    WRAM1Index = state.WRAM1Index;
+
+    std::memcpy(VRAM.getDataPtr(), vram, VRAM_SIZE);
+    std::memcpy(WRAM0.getDataPtr(), wram0, WRAM0_SIZE);
+    std::memcpy(OAM.getDataPtr(), oam, OAM_SIZE);
+    std::memcpy(IOREG.getDataPtr(), ioreg, IOREG_SIZE);
+    std::memcpy(HRAM.getDataPtr(), hram, HRAM_SIZE);
+    std::memcpy(IEREG.getDataPtr(), iereg, IEREG_SIZE);
+
+    for(MemoryBank& bank : WRAM1)
+    {
+        std::memcpy(bank.getDataPtr(), wram1, WRAM1_SIZE);
+        wram1 += WRAM1_SIZE;
+    }
+
+    for(MemoryBank& bank : ERAM)
+    {
+        std::memcpy(bank.getDataPtr(), eram, ERAM_SIZE);
+        eram += ERAM_SIZE;
+    }
+
+    // Whatever was in ERAM before is gone, so the save file needs updating.
+    if(!ERAM.empty()) { ERAMDirty = true; }
+}
+
+
+
 /**
  * @brief Dumps memory contents to the log as LOG_DEBUG.
  */
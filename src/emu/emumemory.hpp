@@ -12,6 +12,13 @@
 #include <filesystem>
 #include "memorybank.hpp"
 #include "emuregisters.hpp"
+#include "emustate.hpp"
+
+class EmuPPU;
+class EmuAPU;
+class EmuTimer;
+class EmuJoypad;
+class EmuSerial;
 
 class EmuMemory
 {
@@ -42,6 +49,55 @@ public:
      */
     void setCPURegisters(RegisterSet* cpu_registers);
 
+    /**
+     * @brief Sets the PPU pointer, which is notified of VRAM and OAM writes
+     * @param ppu
+     */
+    void setPPU(EmuPPU* ppu);
+
+    /**
+     * @brief Sets the APU pointer, which handles sound register accesses
+     * @param apu
+     */
+    void setAPU(EmuAPU* apu);
+
+    /**
+     * @brief Sets the timer pointer, which handles timer register accesses
+     * @param timer
+     */
+    void setTimer(EmuTimer* timer);
+
+    /**
+     * @brief Sets the joypad pointer, which handles JOYP accesses
+     * @param joypad
+     */
+    void setJoypad(EmuJoypad* joypad);
+
+    /**
+     * @brief Sets the serial pointer, which handles SB and SC accesses
+     * @param serial
+     */
+    void setSerial(EmuSerial* serial);
+
+    /**
+     * @brief Returns a pointer to the start of VRAM ($8000)
+     */
+    const uint8_t* getVRAMPtr(void) const noexcept;
+
+    /**
+     * @brief Returns a pointer to the start of OAM ($FE00)
+     */
+    const uint8_t* getOAMPtr(void) const noexcept;
+
+    /**
+     * @brief Returns a pointer to the start of the RAM bank mapped at an
+     * address, for reading memory in place. Banked regions give the bank
+     * mapped now. Pointers are only valid until the memory is next copied.
+     * @param address
+     * @returns nullptr for ROM, echo RAM, registers, or unmapped ERAM.
+     */
+    const uint8_t* getBankPtr(uint16_t address) const noexcept;
+
     /**
      * @brief Initializes ROM0 with a set of data.
      * @param data MemoryBank with range ROM0_START to ROM0_END.
@@ -114,6 +170,22 @@ public:
         std::filesystem::path rom_file_path
     ) noexcept;
 
+    /**
+     * @brief Adds all writable memory and the bank indices to a save state,
+     * and the ROM header to check it against on load.
+     * @param writer
+     */
+    void saveState(StateWriter& writer) const;
+
+    /**
+     * @brief Restores memory from a save state. Nothing changes if it
+     * throws.
+     * @param reader
+     * @throws std::runtime_error if the state is for another ROM, is missing
+     * blocks, or has a bank index out of range.
+     */
+    void loadState(const StateReader& reader);
+
     /**
      * @brief Dumps memory contents to the log as LOG_DEBUG.
      */
@@ -121,6 +193,11 @@ public:
 
 private:
     RegisterSet* CPURegisters = nullptr;
+    EmuPPU* PPU = nullptr;
+    EmuAPU* APU = nullptr;
+    EmuTimer* Timer = nullptr;
+    EmuJoypad* Joypad = nullptr;
+    EmuSerial* Serial = nullptr;
 
     MemoryBank ROM0;
 
@@ -146,6 +223,14 @@ private:
     MemoryBank IOREG;
     MemoryBank HRAM;
     MemoryBank IEREG;
+
+    // Save state block of everything not held in a bank
+    struct State
+    {
+        uint32_t ROM1Index;
+        uint32_t ERAMIndex;
+        uint32_t WRAM1Index;
+    };
 };
 
 // Memory Segment Addresses
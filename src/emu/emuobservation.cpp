@@ -0,0 +1,361 @@
+/**
+ * @file emu/emuobservation.cpp
+ * @brief Turns frames into small, stacked observations for agents
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "emuobservation.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <fmt/core.h>
+#include "emurenderer.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMGBE_OBSERVATION_SSE2
+#include <emmintrin.h>
+#endif
+
+constexpr size_t FRAME_SIZE = LCD_WIDTH * LCD_HEIGHT;
+// Gray level of shade s is GRAY_WHITE - (s * GRAY_STEP).
+constexpr uint16_t GRAY_WHITE = 255;
+constexpr uint16_t GRAY_STEP = 85;
+
+/**
+ * @brief Works out how much of each source pixel falls in each output
+ * pixel. Sizes are scaled so that both are whole: output pixel i covers
+ * [i * source_count, (i + 1) * source_count), and source pixel s covers
+ * [s * count, (s + 1) * count), so an output pixel's weights sum to
+ * source_count.
+ */
+void EmuObservation::makeTaps(
+    int count,
+    int source_count,
+    std::vector<Tap>& taps,
+    std::vector<size_t>& first
+)
+{
+    taps.clear();
+    first.assign(1, 0);
+
+    for(int i = 0; i < count; i++)
+    {
+        int start = i * source_count;
+        int end = start + source_count;
+
+        for(int s = start / count; s * count < end; s++)
+        {
+            int overlap = std::min(end, (s + 1) * count)
+                - std::max(start, s * count);
+            taps.push_back({
+                static_cast<uint16_t>(s), static_cast<uint16_t>(overlap)
+            });
+        }
+
+        first.push_back(taps.size());
+    }
+}
+
+
+
+/**
+ * @brief Sets up an observation shape. The stack starts empty.
+ * @param width At most LCD_WIDTH.
+ * @param height At most LCD_HEIGHT.
+ * @param format
+ * @param stack_depth Frames stacked, at least 1.
+ * @throws std::invalid_argument on a size or depth out of range.
+ */
+EmuObservation::EmuObservation(
+    int width,
+    int height,
+    ObservationFormat format,
+    unsigned int stack_depth
+) :
+    width(width),
+    height(height),
+    format(format),
+    stackDepth(stack_depth)
+{
+    if(width < 1 || width > LCD_WIDTH || height < 1 || height > LCD_HEIGHT)
+    {
+        throw std::invalid_argument(fmt::format(
+            "Observation size {}x{} must be between 1x1 and {}x{}!",
+            width, height, LCD_WIDTH, LCD_HEIGHT
+        ));
+    }
+
+    if(stack_depth == 0)
+    {
+        throw std::invalid_argument("Observation stack must hold a frame!");
+    }
+
+    makeTaps(width, LCD_WIDTH, columnTaps, columnFirst);
+    makeTaps(height, LCD_HEIGHT, rowTaps, rowFirst);
+
+    for(int x = 0; x < width; x++)
+    {
+        sampleColumns.push_back(static_cast<uint16_t>(
+            (((2 * x) + 1) * LCD_WIDTH) / (2 * width)
+        ));
+    }
+
+    ring.resize(getSize());
+    pooled.resize(FRAME_SIZE);
+    columnSums.resize(LCD_WIDTH);
+}
+
+EmuObservation::~EmuObservation()
+{}
+
+
+
+int EmuObservation::getWidth(void) const noexcept
+{
+    return width;
+}
+
+
+
+int EmuObservation::getHeight(void) const noexcept
+{
+    return height;
+}
+
+
+
+ObservationFormat EmuObservation::getFormat(void) const noexcept
+{
+    return format;
+}
+
+
+
+unsigned int EmuObservation::getStackDepth(void) const noexcept
+{
+    return stackDepth;
+}
+
+
+
+/**
+ * @brief Returns the bytes in a whole stack, width * height * depth.
+ */
+size_t EmuObservation::getSize(void) const noexcept
+{
+    return static_cast<size_t>(width) * height * stackDepth;
+}
+
+
+
+/**
+ * @brief Adds a frame to the stack, dropping the oldest. The first frame
+ * after a clear fills the whole stack.
+ * @param frame LCD_WIDTH * LCD_HEIGHT shades, as from the PPU.
+ * @param previous The frame before it, to take the darker shade of each
+ * pixel of the two, so objects drawn on alternate frames aren't lost.
+ * nullptr to use frame alone.
+ */
+void EmuObservation::push(
+    const uint8_t* frame,
+    const uint8_t* previous
+) noexcept
+{
+    if(previous != nullptr)
+    {
+        size_t i = 0;
+#ifdef IMGBE_OBSERVATION_SSE2
+        for(; i + 16 <= FRAME_SIZE; i += 16)
+        {
+            __m128i a = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(frame + i)
+            );
+            __m128i b = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(previous + i)
+            );
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(pooled.data() + i),
+                _mm_max_epu8(a, b)
+            );
+        }
+#endif
+        for(; i < FRAME_SIZE; i++)
+        {
+            pooled[i] = std::max(frame[i], previous[i]);
+        }
+
+        frame = pooled.data();
+    }
+
+    size_t frame_bytes = static_cast<size_t>(width) * height;
+    ringHead = (ringHead + 1) % stackDepth;
+    uint8_t* dest = ring.data() + (ringHead * frame_bytes);
+
+    downsample(frame, dest);
+
+    if(empty)
+    {
+        for(unsigned int i = 0; i < stackDepth; i++)
+        {
+            if(i == ringHead) { continue; }
+            std::memcpy(ring.data() + (i * frame_bytes), dest, frame_bytes);
+        }
+        empty = false;
+    }
+}
+
+
+
+/**
+ * @brief Empties the stack, e.g. at the start of an episode.
+ */
+void EmuObservation::clear(void) noexcept
+{
+    empty = true;
+}
+
+
+
+/**
+ * @brief Writes the stack, oldest frame first.
+ * @param dest Room for getSize() bytes.
+ */
+void EmuObservation::read(uint8_t* dest) const noexcept
+{
+    size_t frame_bytes = static_cast<size_t>(width) * height;
+
+    for(unsigned int age = stackDepth; age-- > 0;)
+    {
+        std::memcpy(dest, getFrame(age), frame_bytes);
+        dest += frame_bytes;
+    }
+}
+
+
+
+/**
+ * @brief Returns one frame of the stack in place, valid until the next
+ * push.
+ * @param age 0 for the newest.
+ */
+const uint8_t* EmuObservation::getFrame(unsigned int age) const noexcept
+{
+    size_t frame_bytes = static_cast<size_t>(width) * height;
+    unsigned int slot = (ringHead + stackDepth - (age % stackDepth))
+        % stackDepth;
+    return ring.data() + (slot * frame_bytes);
+}
+
+
+
+void EmuObservation::downsample(
+    const uint8_t* frame,
+    uint8_t* dest
+) noexcept
+{
+    if(format == OBSERVATION_SHADES)
+    {
+        sampleShades(frame, dest);
+    } else
+    {
+        averageGrayscale(frame, dest);
+    }
+}
+
+
+
+/**
+ * @brief Takes the source pixel under each output pixel's centre.
+ */
+void EmuObservation::sampleShades(
+    const uint8_t* frame,
+    uint8_t* dest
+) const noexcept
+{
+    for(int y = 0; y < height; y++)
+    {
+        int source_y = (((2 * y) + 1) * LCD_HEIGHT) / (2 * height);
+        const uint8_t* row = frame + (source_y * LCD_WIDTH);
+
+        for(uint16_t source_x : sampleColumns)
+        {
+            *dest++ = row[source_x] & 0b11;
+        }
+    }
+}
+
+
+
+/**
+ * @brief Sums each output row's source rows into columns, converting
+ * shades to gray on the way, then sums each output pixel's columns. Column
+ * sums are at most GRAY_WHITE * LCD_HEIGHT, so they fit in 16 bits.
+ */
+void EmuObservation::averageGrayscale(
+    const uint8_t* frame,
+    uint8_t* dest
+) noexcept
+{
+    constexpr uint32_t AREA = LCD_WIDTH * LCD_HEIGHT;
+
+    for(int y = 0; y < height; y++)
+    {
+        const Tap* first = rowTaps.data() + rowFirst[y];
+        const Tap* last = rowTaps.data() + rowFirst[y + 1];
+
+        int x = 0;
+#ifdef IMGBE_OBSERVATION_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i mask = _mm_set1_epi16(0b11);
+        const __m128i white = _mm_set1_epi16(GRAY_WHITE);
+        const __m128i step = _mm_set1_epi16(GRAY_STEP);
+
+        for(; x + 8 <= LCD_WIDTH; x += 8)
+        {
+            __m128i sum = zero;
+            for(const Tap* tap = first; tap != last; tap++)
+            {
+                __m128i shades = _mm_unpacklo_epi8(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(
+                        frame + (tap->source * LCD_WIDTH) + x
+                    )),
+                    zero
+                );
+                __m128i gray = _mm_sub_epi16(
+                    white, _mm_mullo_epi16(_mm_and_si128(shades, mask), step)
+                );
+                sum = _mm_add_epi16(sum, _mm_mullo_epi16(
+                    gray, _mm_set1_epi16(static_cast<short>(tap->weight))
+                ));
+            }
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(columnSums.data() + x), sum
+            );
+        }
+#endif
+        for(; x < LCD_WIDTH; x++)
+        {
+            uint16_t sum = 0;
+            for(const Tap* tap = first; tap != last; tap++)
+            {
+                uint8_t shade = frame[(tap->source * LCD_WIDTH) + x] & 0b11;
+                sum += (GRAY_WHITE - (shade * GRAY_STEP)) * tap->weight;
+            }
+            columnSums[x] = sum;
+        }
+
+        for(int out = 0; out < width; out++)
+        {
+            uint32_t sum = 0;
+            for(size_t i = columnFirst[out]; i < columnFirst[out + 1]; i++)
+            {
+                const Tap& tap = columnTaps[i];
+                sum += static_cast<uint32_t>(columnSums[tap.source])
+                    * tap.weight;
+            }
+            *dest++ = static_cast<uint8_t>((sum + (AREA / 2)) / AREA);
+        }
+    }
+}
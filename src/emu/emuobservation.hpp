@@ -0,0 +1,128 @@
+/**
+ * @file emu/emuobservation.hpp
+ * @brief Turns frames into small, stacked observations for agents
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum ObservationFormat
+{
+    OBSERVATION_SHADES, // Shades 0-3, sampled at each pixel's centre
+    OBSERVATION_GRAYSCALE, // 0-255 with white at 255, averaged over area
+};
+
+/**
+ * @brief Downsamples frames straight from the PPU's shades and keeps the
+ * newest few stacked in a ring, so agents get their input without the
+ * frame ever being converted to color.
+ *
+ * Grayscale is the exact area average of the source pixels each output
+ * pixel covers, as for a resize by area, in fixed point. Columns are
+ * summed with SSE2 where available.
+ */
+class EmuObservation
+{
+public:
+    /**
+     * @brief Sets up an observation shape. The stack starts empty.
+     * @param width At most LCD_WIDTH.
+     * @param height At most LCD_HEIGHT.
+     * @param format
+     * @param stack_depth Frames stacked, at least 1.
+     * @throws std::invalid_argument on a size or depth out of range.
+     */
+    EmuObservation(
+        int width,
+        int height,
+        ObservationFormat format,
+        unsigned int stack_depth = 1
+    );
+    ~EmuObservation();
+
+    int getWidth(void) const noexcept;
+    int getHeight(void) const noexcept;
+    ObservationFormat getFormat(void) const noexcept;
+    unsigned int getStackDepth(void) const noexcept;
+
+    /**
+     * @brief Returns the bytes in a whole stack, width * height * depth.
+     */
+    size_t getSize(void) const noexcept;
+
+    /**
+     * @brief Adds a frame to the stack, dropping the oldest. The first
+     * frame after a clear fills the whole stack.
+     * @param frame LCD_WIDTH * LCD_HEIGHT shades, as from the PPU.
+     * @param previous The frame before it, to take the darker shade of each
+     * pixel of the two, so objects drawn on alternate frames aren't lost.
+     * nullptr to use frame alone.
+     */
+    void push(
+        const uint8_t* frame,
+        const uint8_t* previous = nullptr
+    ) noexcept;
+
+    /**
+     * @brief Empties the stack, e.g. at the start of an episode.
+     */
+    void clear(void) noexcept;
+
+    /**
+     * @brief Writes the stack, oldest frame first.
+     * @param dest Room for getSize() bytes.
+     */
+    void read(uint8_t* dest) const noexcept;
+
+    /**
+     * @brief Returns one frame of the stack in place, valid until the next
+     * push.
+     * @param age 0 for the newest.
+     */
+    const uint8_t* getFrame(unsigned int age) const noexcept;
+
+private:
+    // A source pixel's share of an output pixel
+    struct Tap
+    {
+        uint16_t source;
+        uint16_t weight;
+    };
+
+    int width;
+    int height;
+    ObservationFormat format;
+    unsigned int stackDepth;
+
+    // Output pixel i uses taps [first[i], first[i + 1]).
+    std::vector<Tap> columnTaps;
+    std::vector<size_t> columnFirst;
+    std::vector<Tap> rowTaps;
+    std::vector<size_t> rowFirst;
+    // Source column under each output column's centre
+    std::vector<uint16_t> sampleColumns;
+
+    std::vector<uint8_t> ring;
+    unsigned int ringHead = 0;
+    bool empty = true;
+
+    // Scratch space, kept between frames to avoid allocating
+    std::vector<uint8_t> pooled;
+    std::vector<uint16_t> columnSums;
+
+    static void makeTaps(
+        int count,
+        int source_count,
+        std::vector<Tap>& taps,
+        std::vector<size_t>& first
+    );
+
+    void downsample(const uint8_t* frame, uint8_t* dest) noexcept;
+    void sampleShades(const uint8_t* frame, uint8_t* dest) const noexcept;
+    void averageGrayscale(const uint8_t* frame, uint8_t* dest) noexcept;
+};
@@ -6,9 +6,11 @@
  */
 
 #include "emuppu.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include <fmt/core.h>
 #include "../logger.hpp"
+#include "emustate.hpp"
 
 EmuPPU::EmuPPU(EmuMemory* memory, EmuCPU* cpu)
 {
@@ -60,11 +62,14 @@ void EmuPPU::step(int cycles)
             if(cycle >= 40)
             {
                 state = PixelTransfer;
-                logMessage(fmt::format(
-                    "Finished OAM search on line {}.",
-                    ly),
-                    LOG_DEBUG
-                );
+                if(isLogLevelEnabled(LOG_DEBUG))
+                {
+                    logMessage(fmt::format(
+                        "Finished OAM search on line {}.",
+                        ly),
+                        LOG_DEBUG
+                    );
+                }
             }
             break;
         }
@@ -75,12 +80,16 @@ void EmuPPU::step(int cycles)
             if(lx >= 160)
             {
                 lx = 0;
+                if(renderingFrame) { renderLine(); }
                 state = HBlank;
-                logMessage(fmt::format(
-                    "Finished pixel transfer on line {}.",
-                    ly),
-                    LOG_DEBUG
-                );
+                if(isLogLevelEnabled(LOG_DEBUG))
+                {
+                    logMessage(fmt::format(
+                        "Finished pixel transfer on line {}.",
+                        ly),
+                        LOG_DEBUG
+                    );
+                }
             }
             break;
         }
@@ -94,15 +103,19 @@ void EmuPPU::step(int cycles)
                 ly++;
                 mem->writeByte(0xFF44, ly);
 
-                logMessage(fmt::format(
-                    "Finished HBlank on line {}.",
-                    ly),
-                    LOG_DEBUG
-                );
+                if(isLogLevelEnabled(LOG_DEBUG))
+                {
+                    logMessage(fmt::format(
+                        "Finished HBlank on line {}.",
+                        ly),
+                        LOG_DEBUG
+                    );
+                }
 
                 if(ly >= 144)
                 {
                     cpu->sendInterrupt(0);
+                    endFrame();
                     state = VBlank;
                 } else
                 {
@@ -127,6 +140,7 @@ void EmuPPU::step(int cycles)
                 {
                     mem->writeByte(0xFF44, 0);
                     logMessage("Finished VBlank.", LOG_DEBUG);
+                    startFrame();
                     state = OAMSearch;
                 }
             }
@@ -136,3 +150,238 @@ void EmuPPU::step(int cycles)
         cycle++;
     }
 }
+
+
+
+/**
+ * @brief Sets how often frames are composed. Timing is unaffected.
+ * @param interval 1 renders every frame, N renders 1 in N, 0 never renders.
+ */
+void EmuPPU::setRenderInterval(unsigned int interval) noexcept
+{
+    // The tile cache isn't maintained while rendering is off.
+    if(renderInterval == 0 && interval != 0) { renderer.invalidateAll(); }
+
+    renderInterval = interval;
+    if(interval == 0) { renderingFrame = false; }
+}
+
+
+
+unsigned int EmuPPU::getRenderInterval(void) const noexcept
+{
+    return renderInterval;
+}
+
+
+
+/**
+ * @brief Hands composition off to a render thread, or back to the PPU.
+ * @param render_thread Started render thread, or nullptr.
+ */
+void EmuPPU::setRenderThread(EmuRenderThread* render_thread) noexcept
+{
+    // Local tiles went stale while the thread was composing.
+    if(render_thread == nullptr) { renderer.invalidateAll(); }
+    renderThread = render_thread;
+}
+
+
+
+/**
+ * @brief Notifies the PPU that VRAM has been written to.
+ * @param address
+ * @param value
+ */
+void EmuPPU::notifyVRAMWrite(uint16_t address, uint8_t value) noexcept
+{
+    // The render thread's shadow VRAM has to see every write.
+    if(renderThread != nullptr)
+    {
+        renderThread->journalVRAMWrite(address, value);
+        return;
+    }
+
+    if(renderInterval == 0) { return; }
+    renderer.invalidateTile(address);
+}
+
+
+
+/**
+ * @brief Notifies the PPU that OAM has been written to.
+ * @param address
+ * @param value
+ */
+void EmuPPU::notifyOAMWrite(uint16_t address, uint8_t value) noexcept
+{
+    if(renderThread != nullptr)
+    {
+        renderThread->journalOAMWrite(address, value);
+    }
+}
+
+
+
+/**
+ * @brief Returns the last completed frame as LCD_WIDTH * LCD_HEIGHT
+ * shades (0-3), row-major. Without a render thread, it stays at the same
+ * address for the life of the PPU.
+ */
+const uint8_t* EmuPPU::getFrameBuffer(void) const noexcept
+{
+    if(renderThread != nullptr) { return renderThread->getFrameBuffer(); }
+    return frontBuffer.data();
+}
+
+
+
+/**
+ * @brief Returns the number of frames completed since creation.
+ */
+uint64_t EmuPPU::getFrameCount(void) const noexcept
+{
+    return frameCount;
+}
+
+
+
+/**
+ * @brief Returns the frame number of the newest frame getFrameBuffer can
+ * return. With a render thread, it only changes once that frame is complete.
+ */
+uint64_t EmuPPU::getReadyFrame(void) const noexcept
+{
+    if(renderThread != nullptr) { return renderThread->getReadyFrame(); }
+    return frameCount;
+}
+
+
+
+/**
+ * @brief Returns true if the last completed frame was composed.
+ */
+bool EmuPPU::isFrameRendered(void) const noexcept
+{
+    return frameRendered;
+}
+
+
+
+EmuPPU::State EmuPPU::getState(void) const noexcept
+{
+    State saved{
+        static_cast<uint8_t>(state), lx, ly, windowLine, cycle,
+        renderingFrame, frameRendered, {}
+    };
+
+    const uint8_t* frame = getFrameBuffer();
+    std::copy(frame, frame + saved.frame.size(), saved.frame.begin());
+    return saved;
+}
+
+
+
+/**
+ * @brief Restores a saved state. VRAM must already be restored, since the
+ * tile cache is rebuilt from it.
+ * @param saved
+ */
+void EmuPPU::setState(const State& saved) noexcept
+{
+    state = static_cast<PPUStates>(saved.mode);
+    lx = saved.lx;
+    ly = saved.ly;
+    windowLine = saved.windowLine;
+    cycle = saved.cycle;
+    renderingFrame = saved.renderingFrame;
+    frameRendered = saved.frameRendered;
+    frontBuffer = saved.frame;
+
+    renderer.invalidateAll();
+}
+
+
+
+/**
+ * @brief Checks a saved state read from a file before it is set.
+ * @param saved
+ * @throws std::runtime_error if a field is out of range.
+ */
+void EmuPPU::checkState(const State& saved)
+{
+    StateReader::checkRange("PPU ", "mode", saved.mode, VBlank + 1);
+    StateReader::checkBool("PPU ", "rendering frame", saved.renderingFrame);
+    StateReader::checkBool("PPU ", "frame rendered", saved.frameRendered);
+}
+
+
+
+/**
+ * @brief Replaces the last completed frame, e.g. to keep one composed by
+ * frames that were since undone.
+ * @param frame
+ */
+void EmuPPU::setFrameBuffer(const FrameBuffer& frame) noexcept
+{
+    frontBuffer = frame;
+}
+
+
+
+void EmuPPU::renderLine(void) noexcept
+{
+    const RegisterSet* regs = cpu->getRegsPtr();
+    if(regs->mem.video.ly >= LCD_HEIGHT) { return; }
+
+    PPULineState line;
+    line.ly = regs->mem.video.ly;
+    line.lcdc = regs->mem.video.lcdc;
+    line.scy = regs->mem.video.scy;
+    line.scx = regs->mem.video.scx;
+    line.wy = regs->mem.video.wy;
+    line.wx = regs->mem.video.wx;
+    line.bgp = regs->mem.video.bgp;
+    line.obp0 = regs->mem.video.obp0;
+    line.obp1 = regs->mem.video.obp1;
+    line.windowLine = windowLine;
+
+    if(EmuRenderer::isWindowVisible(line)) { windowLine++; }
+
+    if(renderThread != nullptr)
+    {
+        renderThread->submitLine(line);
+        return;
+    }
+
+    renderer.renderLine(
+        mem->getVRAMPtr(),
+        mem->getOAMPtr(),
+        line,
+        backBuffer.data() + (line.ly * LCD_WIDTH)
+    );
+}
+
+
+
+void EmuPPU::startFrame(void) noexcept
+{
+    windowLine = 0;
+    renderingFrame = renderInterval != 0
+        && (frameCount % renderInterval) == 0;
+}
+
+
+
+void EmuPPU::endFrame(void) noexcept
+{
+    frameRendered = renderingFrame;
+    frameCount++;
+    if(renderingFrame && renderThread != nullptr)
+    {
+        renderThread->submitEndFrame(frameCount);
+    } else if(renderingFrame)
+    {
+        frontBuffer = backBuffer;
+    }
+}
@@ -7,8 +7,11 @@
 
 #pragma once
 
+#include <array>
 #include "emumemory.hpp"
 #include "emucpu.hpp"
+#include "emurenderer.hpp"
+#include "emurenderthread.hpp"
 
 class EmuPPU
 {
@@ -27,9 +30,117 @@ public:
      */
     void step(int cycles);
 
+    /**
+     * @brief Sets how often frames are composed. Timing is unaffected.
+     * @param interval 1 renders every frame, N renders 1 in N, 0 never renders.
+     */
+    void setRenderInterval(unsigned int interval) noexcept;
+
+    unsigned int getRenderInterval(void) const noexcept;
+
+    /**
+     * @brief Hands composition off to a render thread, or back to the PPU.
+     * @param render_thread Started render thread, or nullptr.
+     */
+    void setRenderThread(EmuRenderThread* render_thread) noexcept;
+
+    /**
+     * @brief Notifies the PPU that VRAM has been written to.
+     * @param address
+     * @param value
+     */
+    void notifyVRAMWrite(uint16_t address, uint8_t value) noexcept;
+
+    /**
+     * @brief Notifies the PPU that OAM has been written to.
+     * @param address
+     * @param value
+     */
+    void notifyOAMWrite(uint16_t address, uint8_t value) noexcept;
+
+    /**
+     * @brief Returns the last completed frame as LCD_WIDTH * LCD_HEIGHT
+     * shades (0-3), row-major. Without a render thread, it stays at the
+     * same address for the life of the PPU.
+     */
+    const uint8_t* getFrameBuffer(void) const noexcept;
+
+    /**
+     * @brief Returns the number of frames completed since creation.
+     */
+    uint64_t getFrameCount(void) const noexcept;
+
+    /**
+     * @brief Returns the frame number of the newest frame getFrameBuffer
+     * can return. With a render thread, it only changes once that frame
+     * is complete.
+     */
+    uint64_t getReadyFrame(void) const noexcept;
+
+    /**
+     * @brief Returns true if the last completed frame was composed.
+     */
+    bool isFrameRendered(void) const noexcept;
+
+    using FrameBuffer = std::array<uint8_t, LCD_WIDTH * LCD_HEIGHT>;
+
+    // Everything needed to resume emulation exactly, and the last completed
+    // frame so there's something to show before the next one.
+    struct State
+    {
+        uint8_t mode;
+        uint8_t lx;
+        uint8_t ly;
+        uint8_t windowLine;
+        int32_t cycle;
+        bool renderingFrame;
+        bool frameRendered;
+        FrameBuffer frame;
+    };
+
+    State getState(void) const noexcept;
+
+    /**
+     * @brief Restores a saved state. VRAM must already be restored, since
+     * the tile cache is rebuilt from it.
+     * @param saved
+     */
+    void setState(const State& saved) noexcept;
+
+    /**
+     * @brief Checks a saved state read from a file before it is set.
+     * @param saved
+     * @throws std::runtime_error if a field is out of range.
+     */
+    static void checkState(const State& saved);
+
+    /**
+     * @brief Replaces the last completed frame, e.g. to keep one composed
+     * by frames that were since undone.
+     * @param frame
+     */
+    void setFrameBuffer(const FrameBuffer& frame) noexcept;
+
 private:
     EmuMemory* mem;
     EmuCPU* cpu;
+    EmuRenderer renderer;
+    EmuRenderThread* renderThread = nullptr;
+
+    // Lines are composed into the back buffer, copied to the front at
+    // VBlank so the front never moves.
+    FrameBuffer frontBuffer{};
+    FrameBuffer backBuffer{};
+
+    unsigned int renderInterval = 1;
+    bool renderingFrame = true;
+    bool frameRendered = false;
+    uint64_t frameCount = 0;
+    uint8_t windowLine = 0;
+
+    void renderLine(void) noexcept;
+    void startFrame(void) noexcept;
+    void endFrame(void) noexcept;
 
     enum PPUStates
     {
@@ -41,5 +152,5 @@ private:
 
     PPUStates state = OAMSearch;
     int cycle = 0;
-    uint8_t lx, ly;
+    uint8_t lx = 0, ly = 0;
 };
@@ -23,15 +23,74 @@ RegisterSet::~RegisterSet()
  * @param address Emulated memory address
  * @returns a pointer to a register, or a nullptr
  */
-uint8_t* RegisterSet::getRegisterPtr(uint16_t address) const noexcept
+uint8_t* RegisterSet::getRegisterPtr(uint16_t address) noexcept
 {
-    auto it = MEMORY_MAP.find(address);
-    if(it != MEMORY_MAP.end())
+    // A switch rather than a table of pointers, which copies of the set
+    // would share with the original.
+    if(address >= 0xFF30 && address <= 0xFF3F)
     {
-        return it->second;
+        return &mem.sound.wave[address - 0xFF30];
     }
 
-    return nullptr;
+    switch(address)
+    {
+    case 0xFF00: return &mem.io.joyp;
+    case 0xFF01: return &mem.io.sb;
+    case 0xFF02: return &mem.io.sc;
+    case 0xFF04: return &mem.io.div;
+    case 0xFF05: return &mem.io.tima;
+    case 0xFF06: return &mem.io.tma;
+    case 0xFF07: return &mem.io.tac;
+    case 0xFF0F: return &mem.io.iflag;
+    case 0xFF10: return &mem.sound.nr10;
+    case 0xFF11: return &mem.sound.nr11;
+    case 0xFF12: return &mem.sound.nr12;
+    case 0xFF13: return &mem.sound.nr13;
+    case 0xFF14: return &mem.sound.nr14;
+    case 0xFF16: return &mem.sound.nr21;
+    case 0xFF17: return &mem.sound.nr22;
+    case 0xFF18: return &mem.sound.nr23;
+    case 0xFF19: return &mem.sound.nr24;
+    case 0xFF1A: return &mem.sound.nr30;
+    case 0xFF1B: return &mem.sound.nr31;
+    case 0xFF1C: return &mem.sound.nr32;
+    case 0xFF1D: return &mem.sound.nr33;
+    case 0xFF1E: return &mem.sound.nr34;
+    case 0xFF20: return &mem.sound.nr41;
+    case 0xFF21: return &mem.sound.nr42;
+    case 0xFF22: return &mem.sound.nr43;
+    case 0xFF23: return &mem.sound.nr44;
+    case 0xFF24: return &mem.sound.nr50;
+    case 0xFF25: return &mem.sound.nr51;
+    case 0xFF26: return &mem.sound.nr52;
+    case 0xFF40: return &mem.video.lcdc;
+    case 0xFF41: return &mem.video.stat;
+    case 0xFF42: return &mem.video.scy;
+    case 0xFF43: return &mem.video.scx;
+    case 0xFF44: return &mem.video.ly;
+    case 0xFF45: return &mem.video.lyc;
+    case 0xFF47: return &mem.video.bgp;
+    case 0xFF48: return &mem.video.obp0;
+    case 0xFF49: return &mem.video.obp1;
+    case 0xFF4A: return &mem.video.wy;
+    case 0xFF4B: return &mem.video.wx;
+    case 0xFF4D: return &mem.video.key1;
+    case 0xFF4F: return &mem.video.vbk;
+    case 0xFF50: return &mem.io.boot;
+    case 0xFF51: return &mem.video.hdma1;
+    case 0xFF52: return &mem.video.hdma2;
+    case 0xFF53: return &mem.video.hdma3;
+    case 0xFF54: return &mem.video.hdma4;
+    case 0xFF55: return &mem.video.hdma5;
+    case 0xFF56: return &mem.video.rp;
+    case 0xFF68: return &mem.video.bcps;
+    case 0xFF69: return &mem.video.bcpd;
+    case 0xFF6A: return &mem.video.ocps;
+    case 0xFF6B: return &mem.video.ocpd;
+    case 0xFF70: return &mem.video.svbk;
+    case 0xFFFF: return &mem.io.ienable;
+    default: return nullptr;
+    }
 }
 
 
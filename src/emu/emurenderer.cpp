@@ -0,0 +1,256 @@
+/**
+ * @file emu/emurenderer.cpp
+ * @brief Composes PPU scanlines from VRAM, OAM, and a register snapshot
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "emurenderer.hpp"
+#include <algorithm>
+
+// Offsets relative to the start of VRAM
+constexpr uint16_t TILE_DATA_END = 0x1800;
+constexpr uint16_t TILE_MAP_0 = 0x1800;
+constexpr uint16_t TILE_MAP_1 = 0x1C00;
+
+// LCDC bits
+constexpr uint8_t LCDC_BG_ENABLE = 1 << 0;
+constexpr uint8_t LCDC_OBJ_ENABLE = 1 << 1;
+constexpr uint8_t LCDC_OBJ_SIZE = 1 << 2;
+constexpr uint8_t LCDC_BG_MAP = 1 << 3;
+constexpr uint8_t LCDC_TILE_DATA = 1 << 4;
+constexpr uint8_t LCDC_WIN_ENABLE = 1 << 5;
+constexpr uint8_t LCDC_WIN_MAP = 1 << 6;
+constexpr uint8_t LCDC_LCD_ENABLE = 1 << 7;
+
+EmuRenderer::EmuRenderer()
+{
+    dirtyTiles.set();
+}
+
+EmuRenderer::~EmuRenderer()
+{}
+
+
+
+/**
+ * @brief Marks the tile containing a VRAM address for re-decoding.
+ * @param address Emulated memory address
+ */
+void EmuRenderer::invalidateTile(uint16_t address) noexcept
+{
+    uint16_t offset = address - 0x8000;
+    if(offset >= TILE_DATA_END) { return; } // Tile maps aren't cached
+
+    dirtyTiles.set(offset / 16);
+    anyDirty = true;
+}
+
+
+
+/**
+ * @brief Marks every tile for re-decoding.
+ */
+void EmuRenderer::invalidateAll(void) noexcept
+{
+    dirtyTiles.set();
+    anyDirty = true;
+}
+
+
+
+/**
+ * @brief Composes one scanline of shades (0-3) after palette mapping.
+ * @param vram Pointer to the start of VRAM ($8000)
+ * @param oam Pointer to the start of OAM ($FE00)
+ * @param line Register snapshot for the line
+ * @param out Destination, LCD_WIDTH bytes
+ */
+void EmuRenderer::renderLine(
+    const uint8_t* vram,
+    const uint8_t* oam,
+    const PPULineState& line,
+    uint8_t* out
+) noexcept
+{
+    if(!(line.lcdc & LCDC_LCD_ENABLE))
+    {
+        std::fill(out, out + LCD_WIDTH, 0);
+        return;
+    }
+
+    if(anyDirty) { decodeDirtyTiles(vram); }
+
+    // Raw color indices are kept around for sprite priority.
+    uint8_t color_indices[LCD_WIDTH];
+    renderBackground(vram, line, color_indices);
+
+    for(int x = 0; x < LCD_WIDTH; x++)
+    {
+        out[x] = (line.bgp >> (color_indices[x] * 2)) & 0b11;
+    }
+
+    if(line.lcdc & LCDC_OBJ_ENABLE)
+    {
+        renderSprites(oam, line, color_indices, out);
+    }
+}
+
+
+
+/**
+ * @brief Returns true if the window is drawn on the given line.
+ * @param line
+ */
+bool EmuRenderer::isWindowVisible(const PPULineState& line) noexcept
+{
+    return (line.lcdc & LCDC_LCD_ENABLE)
+        && (line.lcdc & LCDC_BG_ENABLE)
+        && (line.lcdc & LCDC_WIN_ENABLE)
+        && line.ly >= line.wy
+        && line.wx <= 166;
+}
+
+
+
+void EmuRenderer::decodeDirtyTiles(const uint8_t* vram) noexcept
+{
+    for(int tile = 0; tile < TILE_COUNT; tile++)
+    {
+        if(!dirtyTiles.test(tile)) { continue; }
+
+        const uint8_t* source = vram + (tile * 16);
+        std::array<uint8_t, 64>& decoded = tiles[tile];
+
+        for(int row = 0; row < 8; row++)
+        {
+            uint8_t low = source[row * 2];
+            uint8_t high = source[(row * 2) + 1];
+
+            for(int col = 0; col < 8; col++)
+            {
+                int shift = 7 - col;
+                decoded[(row * 8) + col] = static_cast<uint8_t>(
+                    (((high >> shift) & 1) << 1) | ((low >> shift) & 1)
+                );
+            }
+        }
+    }
+
+    dirtyTiles.reset();
+    anyDirty = false;
+}
+
+
+
+void EmuRenderer::renderBackground(
+    const uint8_t* vram,
+    const PPULineState& line,
+    uint8_t* color_indices
+) noexcept
+{
+    if(!(line.lcdc & LCDC_BG_ENABLE))
+    {
+        std::fill(color_indices, color_indices + LCD_WIDTH, 0);
+        return;
+    }
+
+    bool unsigned_tiles = line.lcdc & LCDC_TILE_DATA;
+    auto tileIndex = [unsigned_tiles](uint8_t number) -> int
+    {
+        return unsigned_tiles ? number : 256 + static_cast<int8_t>(number);
+    };
+
+    int window_start = LCD_WIDTH;
+    if(isWindowVisible(line))
+    {
+        window_start = std::max(0, line.wx - 7);
+    }
+
+    // Background
+    const uint8_t* bg_map = vram
+        + ((line.lcdc & LCDC_BG_MAP) ? TILE_MAP_1 : TILE_MAP_0);
+    uint8_t bg_y = line.scy + line.ly;
+    const uint8_t* bg_row = bg_map + ((bg_y / 8) * 32);
+    int tile_row = (bg_y % 8) * 8;
+
+    for(int x = 0; x < window_start; x++)
+    {
+        uint8_t bg_x = line.scx + x;
+        const std::array<uint8_t, 64>& tile = tiles[tileIndex(bg_row[bg_x / 8])];
+        color_indices[x] = tile[tile_row + (bg_x % 8)];
+    }
+
+    // Window
+    if(window_start >= LCD_WIDTH) { return; }
+
+    const uint8_t* win_map = vram
+        + ((line.lcdc & LCDC_WIN_MAP) ? TILE_MAP_1 : TILE_MAP_0);
+    const uint8_t* win_row = win_map + ((line.windowLine / 8) * 32);
+    tile_row = (line.windowLine % 8) * 8;
+
+    // WX < 7 scrolls the window off the left edge
+    int win_x = window_start - (line.wx - 7);
+    for(int x = window_start; x < LCD_WIDTH; x++, win_x++)
+    {
+        const std::array<uint8_t, 64>& tile =
+            tiles[tileIndex(win_row[win_x / 8])];
+        color_indices[x] = tile[tile_row + (win_x % 8)];
+    }
+}
+
+
+
+void EmuRenderer::renderSprites(
+    const uint8_t* oam,
+    const PPULineState& line,
+    const uint8_t* color_indices,
+    uint8_t* out
+) noexcept
+{
+    int height = (line.lcdc & LCDC_OBJ_SIZE) ? 16 : 8;
+
+    // Hardware draws at most 10 sprites per line, picked in OAM order.
+    int selected[10];
+    int selected_count = 0;
+    for(int i = 0; i < 40 && selected_count < 10; i++)
+    {
+        int row = line.ly + 16 - oam[i * 4];
+        if(row >= 0 && row < height) { selected[selected_count++] = i; }
+    }
+
+    // DMG priority: lower X wins, then lower OAM index.
+    std::stable_sort(selected, selected + selected_count,
+        [oam](int a, int b) { return oam[(a * 4) + 1] < oam[(b * 4) + 1]; }
+    );
+
+    // Draw lowest priority first so higher priority sprites overwrite it.
+    for(int s = selected_count - 1; s >= 0; s--)
+    {
+        const uint8_t* sprite = oam + (selected[s] * 4);
+        int x_pos = sprite[1] - 8;
+        uint8_t tile_number = sprite[2];
+        uint8_t attributes = sprite[3];
+
+        int row = line.ly + 16 - sprite[0];
+        if(attributes & 0x40) { row = height - 1 - row; } // Y flip
+        if(height == 16) { tile_number &= 0xFE; }
+
+        const std::array<uint8_t, 64>& tile = tiles[tile_number + (row / 8)];
+        uint8_t palette = (attributes & 0x10) ? line.obp1 : line.obp0;
+        bool behind_bg = attributes & 0x80;
+        bool x_flip = attributes & 0x20;
+
+        for(int col = 0; col < 8; col++)
+        {
+            int x = x_pos + col;
+            if(x < 0 || x >= LCD_WIDTH) { continue; }
+
+            uint8_t color = tile[((row % 8) * 8) + (x_flip ? 7 - col : col)];
+            if(color == 0) { continue; }
+            if(behind_bg && color_indices[x] != 0) { continue; }
+
+            out[x] = (palette >> (color * 2)) & 0b11;
+        }
+    }
+}
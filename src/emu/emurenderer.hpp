@@ -0,0 +1,92 @@
+/**
+ * @file emu/emurenderer.hpp
+ * @brief Composes PPU scanlines from VRAM, OAM, and a register snapshot
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+constexpr int LCD_WIDTH = 160;
+constexpr int LCD_HEIGHT = 144;
+
+// Every PPU register that affects the pixels of a single scanline.
+struct PPULineState
+{
+    uint8_t ly = 0;
+    uint8_t lcdc = 0;
+    uint8_t scy = 0;
+    uint8_t scx = 0;
+    uint8_t wy = 0;
+    uint8_t wx = 0;
+    uint8_t bgp = 0;
+    uint8_t obp0 = 0;
+    uint8_t obp1 = 0;
+    // Internal window line counter, only advances on lines the window is drawn.
+    uint8_t windowLine = 0;
+};
+
+class EmuRenderer
+{
+public:
+    EmuRenderer();
+    ~EmuRenderer();
+
+    /**
+     * @brief Marks the tile containing a VRAM address for re-decoding.
+     * @param address Emulated memory address
+     */
+    void invalidateTile(uint16_t address) noexcept;
+
+    /**
+     * @brief Marks every tile for re-decoding.
+     */
+    void invalidateAll(void) noexcept;
+
+    /**
+     * @brief Composes one scanline of shades (0-3) after palette mapping.
+     * @param vram Pointer to the start of VRAM ($8000)
+     * @param oam Pointer to the start of OAM ($FE00)
+     * @param line Register snapshot for the line
+     * @param out Destination, LCD_WIDTH bytes
+     */
+    void renderLine(
+        const uint8_t* vram,
+        const uint8_t* oam,
+        const PPULineState& line,
+        uint8_t* out
+    ) noexcept;
+
+    /**
+     * @brief Returns true if the window is drawn on the given line.
+     * @param line
+     */
+    static bool isWindowVisible(const PPULineState& line) noexcept;
+
+private:
+    static constexpr int TILE_COUNT = 384;
+
+    // Decoded 2bpp tile data, one color index per byte.
+    std::array<std::array<uint8_t, 64>, TILE_COUNT> tiles{};
+    std::bitset<TILE_COUNT> dirtyTiles;
+    bool anyDirty = true;
+
+    void decodeDirtyTiles(const uint8_t* vram) noexcept;
+
+    void renderBackground(
+        const uint8_t* vram,
+        const PPULineState& line,
+        uint8_t* color_indices
+    ) noexcept;
+
+    void renderSprites(
+        const uint8_t* oam,
+        const PPULineState& line,
+        const uint8_t* color_indices,
+        uint8_t* out
+    ) noexcept;
+};
@@ -0,0 +1,197 @@
+/**
+ * @file emu/emurenderthread.cpp
+ * @brief Composes PPU frames on a separate thread
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "emurenderthread.hpp"
+#include <algorithm>
+#include <chrono>
+
+EmuRenderThread::EmuRenderThread()
+{}
+
+EmuRenderThread::~EmuRenderThread()
+{
+    stop();
+}
+
+
+
+/**
+ * @brief Seeds the shadow VRAM/OAM and launches the thread.
+ * @param vram Pointer to VRAM_SIZE bytes
+ * @param oam Pointer to OAM_SIZE bytes
+ */
+void EmuRenderThread::start(const uint8_t* vram, const uint8_t* oam)
+{
+    if(running) { return; }
+
+    std::copy(vram, vram + this->vram.size(), this->vram.begin());
+    std::copy(oam, oam + this->oam.size(), this->oam.begin());
+    renderer.invalidateAll();
+
+    running = true;
+    thread = std::thread(&EmuRenderThread::run, this);
+}
+
+
+
+/**
+ * @brief Finishes queued work and joins the thread.
+ */
+void EmuRenderThread::stop(void) noexcept
+{
+    if(!running) { return; }
+
+    running = false;
+    if(thread.joinable()) { thread.join(); }
+}
+
+
+
+void EmuRenderThread::journalVRAMWrite(uint16_t address, uint8_t value) noexcept
+{
+    push(Command{ VRAMWrite, value, address, {} });
+}
+
+
+
+void EmuRenderThread::journalOAMWrite(uint16_t address, uint8_t value) noexcept
+{
+    push(Command{ OAMWrite, value, address, {} });
+}
+
+
+
+void EmuRenderThread::submitLine(const PPULineState& line) noexcept
+{
+    push(Command{ Line, 0, 0, line });
+}
+
+
+
+void EmuRenderThread::submitEndFrame(uint64_t frame) noexcept
+{
+    push(Command{ EndFrame, 0, 0, {}, frame });
+}
+
+
+
+/**
+ * @brief Returns the newest completed frame. Consumer only. The pointer
+ * stays valid until the next call.
+ */
+const uint8_t* EmuRenderThread::getFrameBuffer(void) noexcept
+{
+    if(readyIndex.load(std::memory_order_relaxed) & FRESH_BIT)
+    {
+        frontIndex = readyIndex.exchange(
+            static_cast<uint8_t>(frontIndex),
+            std::memory_order_acq_rel
+        ) & ~FRESH_BIT;
+    }
+
+    return frames[frontIndex].data();
+}
+
+
+
+/**
+ * @brief Returns the frame number of the newest completed frame. It is
+ * published once the frame is, so getFrameBuffer then returns that frame or
+ * a newer one.
+ */
+uint64_t EmuRenderThread::getReadyFrame(void) const noexcept
+{
+    return readyFrame.load(std::memory_order_acquire);
+}
+
+
+
+void EmuRenderThread::push(const Command& command) noexcept
+{
+    // Only waits if the render thread has fallen a full queue behind.
+    while(!commands.tryPush(command)) { std::this_thread::yield(); }
+}
+
+
+
+void EmuRenderThread::run(void) noexcept
+{
+    constexpr size_t BATCH_SIZE = 256;
+    Command batch[BATCH_SIZE];
+    int idle_polls = 0;
+
+    while(true)
+    {
+        size_t count = commands.popBulk(batch, BATCH_SIZE);
+
+        if(count == 0)
+        {
+            if(!running.load(std::memory_order_acquire)
+               && commands.size() == 0)
+            {
+                break;
+            }
+
+            // Back off so an idle emulator doesn't pin a core.
+            if(++idle_polls < 64)
+            {
+                std::this_thread::yield();
+            } else
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(250));
+            }
+
+            continue;
+        }
+
+        idle_polls = 0;
+        for(size_t i = 0; i < count; i++) { execute(batch[i]); }
+    }
+}
+
+
+
+void EmuRenderThread::execute(const Command& command) noexcept
+{
+    switch(command.type)
+    {
+    case VRAMWrite:
+    {
+        vram[command.address - 0x8000] = command.value;
+        renderer.invalidateTile(command.address);
+        break;
+    }
+
+    case OAMWrite:
+    {
+        oam[command.address - 0xFE00] = command.value;
+        break;
+    }
+
+    case Line:
+    {
+        renderer.renderLine(
+            vram.data(),
+            oam.data(),
+            command.line,
+            frames[backIndex].data() + (command.line.ly * LCD_WIDTH)
+        );
+        break;
+    }
+
+    case EndFrame:
+    {
+        backIndex = readyIndex.exchange(
+            static_cast<uint8_t>(backIndex | FRESH_BIT),
+            std::memory_order_acq_rel
+        ) & ~FRESH_BIT;
+        // Only after the frame, so a reader that sees the number sees it.
+        readyFrame.store(command.frame, std::memory_order_release);
+        break;
+    }
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * @file emu/emurenderthread.hpp
+ * @brief Composes PPU frames on a separate thread
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "emurenderer.hpp"
+#include "spscqueue.hpp"
+
+/**
+ * @brief Consumer side of the threaded rendering pipeline.
+ *
+ * The emulation thread records VRAM/OAM writes and per-line register
+ * snapshots in order. This thread replays them against its own copy of VRAM
+ * and OAM, so it never reads emulator memory.
+ */
+class EmuRenderThread
+{
+public:
+    EmuRenderThread();
+    ~EmuRenderThread();
+
+    /**
+     * @brief Seeds the shadow VRAM/OAM and launches the thread.
+     * @param vram Pointer to VRAM_SIZE bytes
+     * @param oam Pointer to OAM_SIZE bytes
+     */
+    void start(const uint8_t* vram, const uint8_t* oam);
+
+    /**
+     * @brief Finishes queued work and joins the thread.
+     */
+    void stop(void) noexcept;
+
+    // Producer side, called from the emulation thread.
+    void journalVRAMWrite(uint16_t address, uint8_t value) noexcept;
+    void journalOAMWrite(uint16_t address, uint8_t value) noexcept;
+    void submitLine(const PPULineState& line) noexcept;
+    void submitEndFrame(uint64_t frame) noexcept;
+
+    /**
+     * @brief Returns the newest completed frame. Consumer only. The pointer
+     * stays valid until the next call.
+     */
+    const uint8_t* getFrameBuffer(void) noexcept;
+
+    /**
+     * @brief Returns the frame number of the newest completed frame. It is
+     * published once the frame is, so getFrameBuffer then returns that
+     * frame or a newer one.
+     */
+    uint64_t getReadyFrame(void) const noexcept;
+
+private:
+    enum CommandType : uint8_t
+    {
+        VRAMWrite,
+        OAMWrite,
+        Line,
+        EndFrame,
+    };
+
+    struct Command
+    {
+        CommandType type;
+        uint8_t value;
+        uint16_t address;
+        PPULineState line;
+        // EndFrame only, the PPU's frame number
+        uint64_t frame;
+    };
+
+    using FrameBuffer = std::array<uint8_t, LCD_WIDTH * LCD_HEIGHT>;
+
+    static constexpr size_t QUEUE_SIZE = 1 << 16;
+    static constexpr uint8_t FRESH_BIT = 0b100;
+
+    SPSCQueue<Command> commands{ QUEUE_SIZE };
+    std::thread thread;
+    std::atomic<bool> running{ false };
+
+    // Only touched by the render thread once started.
+    EmuRenderer renderer;
+    std::array<uint8_t, 0x2000> vram{};
+    std::array<uint8_t, 0xA0> oam{};
+
+    // Three buffers: the thread composes into back, publishes to ready, and
+    // the consumer swaps ready into front. Neither side waits on the other.
+    std::array<FrameBuffer, 3> frames{};
+    int backIndex = 0;
+    std::atomic<uint8_t> readyIndex{ 1 };
+    int frontIndex = 2;
+    std::atomic<uint64_t> readyFrame{ 0 };
+
+    void push(const Command& command) noexcept;
+    void run(void) noexcept;
+    void execute(const Command& command) noexcept;
+};
@@ -0,0 +1,315 @@
+/**
+ * @file emu/emurewind.cpp
+ * @brief Keeps a history of snapshots to run the emulated system backwards
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "emurewind.hpp"
+#include <algorithm>
+#include <cstring>
+#include "lzcodec.hpp"
+
+/**
+ * @brief XORs two buffers into a third, a word at a time.
+ */
+static void xorBuffers(
+    uint8_t* dest,
+    const uint8_t* a,
+    const uint8_t* b,
+    size_t size
+) noexcept
+{
+    size_t i = 0;
+    for(; i + 8 <= size; i += 8)
+    {
+        uint64_t word_a;
+        uint64_t word_b;
+        std::memcpy(&word_a, a + i, 8);
+        std::memcpy(&word_b, b + i, 8);
+        word_a ^= word_b;
+        std::memcpy(dest + i, &word_a, 8);
+    }
+    for(; i < size; i++)
+    {
+        dest[i] = a[i] ^ b[i];
+    }
+}
+
+
+
+EmuRewind::EmuRewind()
+{}
+
+EmuRewind::~EmuRewind()
+{}
+
+
+
+/**
+ * @brief Sets the size of the delta ring. Drops all history.
+ * @param bytes
+ */
+void EmuRewind::setBudget(size_t bytes)
+{
+    clear();
+    budget = bytes;
+    ring.clear();
+    ring.shrink_to_fit();
+}
+
+
+
+size_t EmuRewind::getBudget(void) const noexcept
+{
+    return budget;
+}
+
+
+
+/**
+ * @brief Sets how many frames apart snapshots are. Longer intervals keep
+ * more history, but going back re-runs more frames.
+ * @param frames Clamped to at least 1.
+ */
+void EmuRewind::setInterval(uint64_t frames) noexcept
+{
+    interval = std::max<uint64_t>(frames, 1);
+}
+
+
+
+uint64_t EmuRewind::getInterval(void) const noexcept
+{
+    return interval;
+}
+
+
+
+/**
+ * @brief Records the frame the system just ran, and snapshots it if it's
+ * time. Call after every whole frame.
+ * @param sys
+ * @throws std::runtime_error on system not running.
+ */
+void EmuRewind::capture(EmuSys& sys)
+{
+    uint64_t frame = sys.getInputFrame();
+    if(frame == 0) { return; }
+
+    // The system went back without us, so the history is for another run.
+    if(!latest.empty() && frame < latestFrame) { clear(); }
+
+    inputs.setButtons(frame - 1, sys.getButtons());
+
+    if(!latest.empty() && frame < latestFrame + interval) { return; }
+
+    sys.saveState(snapshot);
+
+    if(!latest.empty() && snapshot.size() == latest.size())
+    {
+        difference.resize(latest.size());
+        xorBuffers(
+            difference.data(), latest.data(), snapshot.data(), latest.size()
+        );
+
+        lzCompress(difference.data(), difference.size(), compressed);
+        pushDelta(latestFrame, compressed);
+    } else
+    {
+        deltas.clear();
+        ringHead = 0;
+    }
+
+    latest.swap(snapshot);
+    latestFrame = frame;
+}
+
+
+
+/**
+ * @brief Puts the system back to the start of an earlier frame, or as far
+ * back as history goes. History after that frame is dropped.
+ * @param sys
+ * @param frame Input frame, as in EmuSys::getInputFrame().
+ * @returns The frame the system is now at.
+ * @throws std::runtime_error on system not running.
+ */
+uint64_t EmuRewind::rewindTo(EmuSys& sys, uint64_t frame)
+{
+    if(latest.empty() || frame >= sys.getInputFrame())
+    {
+        return sys.getInputFrame();
+    }
+
+    while(latestFrame > frame && !deltas.empty())
+    {
+        popDelta();
+    }
+
+    sys.loadState(latest);
+    replay(sys, frame);
+
+    return sys.getInputFrame();
+}
+
+
+
+/**
+ * @brief Drops all history. Call when the system jumps somewhere the
+ * history doesn't lead, e.g. on a reset or loading a save state.
+ */
+void EmuRewind::clear(void) noexcept
+{
+    latest.clear();
+    latestFrame = 0;
+    deltas.clear();
+    ringHead = 0;
+    inputs.clear();
+}
+
+
+
+bool EmuRewind::isEmpty(void) const noexcept
+{
+    return latest.empty();
+}
+
+
+
+/**
+ * @brief Returns the earliest frame that can be rewound to.
+ */
+uint64_t EmuRewind::getOldestFrame(void) const noexcept
+{
+    return deltas.empty() ? latestFrame : deltas.front().frame;
+}
+
+
+
+/**
+ * @brief Returns the bytes held by history, including the newest snapshot.
+ */
+size_t EmuRewind::getMemoryUsed(void) const noexcept
+{
+    size_t used = latest.size();
+    for(const Delta& delta : deltas) { used += delta.size; }
+    return used;
+}
+
+
+
+/**
+ * @brief Adds a delta to the ring, overwriting the oldest ones in its way.
+ */
+void EmuRewind::pushDelta(uint64_t frame, const std::vector<uint8_t>& data)
+{
+    size_t size = data.size();
+
+    // History can't skip a delta, so one that doesn't fit ends it here.
+    if(size > budget)
+    {
+        deltas.clear();
+        ringHead = 0;
+        return;
+    }
+
+    if(ring.size() != budget) { ring.resize(budget); }
+
+    size_t start = ringHead;
+    bool wrapped = false;
+    if(start + size > ring.size())
+    {
+        start = 0;
+        wrapped = true;
+    }
+
+    // The oldest deltas are the ones just past the head, so anything in
+    // the way is always at the front.
+    while(!deltas.empty())
+    {
+        const Delta& oldest = deltas.front();
+        bool skipped = wrapped && oldest.offset >= ringHead;
+        bool overlaps = oldest.offset < start + size
+            && start < oldest.offset + oldest.size;
+
+        if(!skipped && !overlaps) { break; }
+        deltas.pop_front();
+    }
+
+    std::memcpy(ring.data() + start, data.data(), size);
+    deltas.push_back({ frame, start, size });
+    ringHead = start + size;
+}
+
+
+
+/**
+ * @brief Undoes the newest delta, moving the newest snapshot back to the
+ * one before it.
+ */
+void EmuRewind::popDelta(void)
+{
+    const Delta& delta = deltas.back();
+
+    difference.resize(latest.size());
+    lzDecompress(
+        ring.data() + delta.offset, delta.size,
+        difference.data(), difference.size()
+    );
+
+    xorBuffers(
+        latest.data(), latest.data(), difference.data(), latest.size()
+    );
+
+    latestFrame = delta.frame;
+    ringHead = delta.offset;
+    deltas.pop_back();
+}
+
+
+
+/**
+ * @brief Runs the system up to a frame with the recorded input, silently,
+ * composing only the last frames.
+ */
+void EmuRewind::replay(EmuSys& sys, uint64_t frame)
+{
+    if(sys.getInputFrame() >= frame) { return; }
+
+    InputSource* source = sys.getInputSource();
+    unsigned int render_interval = sys.getRenderInterval();
+    bool audio_enabled = sys.isAudioEnabled();
+    bool paused = sys.isPaused();
+
+    auto restore = [&]()
+    {
+        sys.setInputSource(source);
+        sys.setRenderInterval(render_interval);
+        sys.setAudioEnabled(audio_enabled);
+        if(paused) { sys.pause(); }
+    };
+
+    sys.setInputSource(&inputs);
+    sys.setAudioEnabled(false);
+    sys.resume();
+
+    try
+    {
+        // A breakpoint pauses the system partway, so stop there.
+        while(sys.getInputFrame() < frame && !sys.isPaused())
+        {
+            // The PPU decides whether to compose a frame when it starts,
+            // which can be in the system frame before the one shown.
+            bool shown = sys.getInputFrame() + 2 >= frame;
+            sys.setRenderInterval(shown ? render_interval : 0);
+            sys.runFrame();
+        }
+    } catch(...)
+    {
+        restore();
+        throw;
+    }
+
+    restore();
+}
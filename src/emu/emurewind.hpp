@@ -0,0 +1,122 @@
+/**
+ * @file emu/emurewind.hpp
+ * @brief Keeps a history of snapshots to run the emulated system backwards
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "emusys.hpp"
+#include "emuinput.hpp"
+
+constexpr size_t REWIND_DEFAULT_BUDGET = 32 * 1024 * 1024;
+constexpr uint64_t REWIND_DEFAULT_INTERVAL = 2;
+
+/**
+ * @brief Rewind history for one system.
+ *
+ * Every interval frames the system is snapshotted. The newest snapshot is
+ * kept whole. Each older one is kept as the XOR of it and the snapshot
+ * after it, compressed, in a ring of the budget's size that overwrites the
+ * oldest history when full. Consecutive snapshots differ in few bytes, so
+ * each delta is a small fraction of a snapshot.
+ *
+ * Going back undoes deltas until the newest snapshot at or before the
+ * target frame, then re-runs the frames after it with the recorded input.
+ */
+class EmuRewind
+{
+public:
+    EmuRewind();
+    ~EmuRewind();
+
+    /**
+     * @brief Sets the size of the delta ring. Drops all history.
+     * @param bytes
+     */
+    void setBudget(size_t bytes);
+
+    size_t getBudget(void) const noexcept;
+
+    /**
+     * @brief Sets how many frames apart snapshots are. Longer intervals
+     * keep more history, but going back re-runs more frames.
+     * @param frames Clamped to at least 1.
+     */
+    void setInterval(uint64_t frames) noexcept;
+
+    uint64_t getInterval(void) const noexcept;
+
+    /**
+     * @brief Records the frame the system just ran, and snapshots it if it's
+     * time. Call after every whole frame.
+     * @param sys
+     * @throws std::runtime_error on system not running.
+     */
+    void capture(EmuSys& sys);
+
+    /**
+     * @brief Puts the system back to the start of an earlier frame, or as
+     * far back as history goes. History after that frame is dropped.
+     * @param sys
+     * @param frame Input frame, as in EmuSys::getInputFrame().
+     * @returns The frame the system is now at.
+     * @throws std::runtime_error on system not running.
+     */
+    uint64_t rewindTo(EmuSys& sys, uint64_t frame);
+
+    /**
+     * @brief Drops all history. Call when the system jumps somewhere the
+     * history doesn't lead, e.g. on a reset or loading a save state.
+     */
+    void clear(void) noexcept;
+
+    bool isEmpty(void) const noexcept;
+
+    /**
+     * @brief Returns the earliest frame that can be rewound to.
+     */
+    uint64_t getOldestFrame(void) const noexcept;
+
+    /**
+     * @brief Returns the bytes held by history, including the newest
+     * snapshot.
+     */
+    size_t getMemoryUsed(void) const noexcept;
+
+private:
+    struct Delta
+    {
+        // Frame of the older of the two snapshots
+        uint64_t frame;
+        size_t offset;
+        size_t size;
+    };
+
+    size_t budget = REWIND_DEFAULT_BUDGET;
+    uint64_t interval = REWIND_DEFAULT_INTERVAL;
+
+    std::vector<uint8_t> latest;
+    uint64_t latestFrame = 0;
+
+    // Deltas are written one after another, wrapping to the start.
+    std::vector<uint8_t> ring;
+    size_t ringHead = 0;
+    std::deque<Delta> deltas;
+
+    InputStream inputs;
+
+    // Scratch space, kept between frames to avoid allocating
+    std::vector<uint8_t> snapshot;
+    std::vector<uint8_t> difference;
+    std::vector<uint8_t> compressed;
+
+    void pushDelta(uint64_t frame, const std::vector<uint8_t>& data);
+    void popDelta(void);
+    void replay(EmuSys& sys, uint64_t frame);
+};
@@ -0,0 +1,201 @@
+/**
+ * @file emu/emuserial.cpp
+ * @brief Implements the system's serial port
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "emuserial.hpp"
+#include "emusys.hpp"
+
+constexpr uint8_t SC_TRANSFER = 1 << 7;
+constexpr uint8_t SC_INTERNAL_CLOCK = 1 << 0;
+constexpr uint8_t SC_UNUSED = 0x7E;
+constexpr uint8_t SERIAL_INTERRUPT = 1 << 3;
+
+
+
+EmuSerial::EmuSerial(RegisterSet* registers, EmuSys* parent_sys)
+{
+    regs = registers;
+    sys = parent_sys;
+    state.transferEndCycle = SERIAL_NO_EVENT;
+}
+
+EmuSerial::~EmuSerial()
+{}
+
+
+
+void EmuSerial::setRegisters(RegisterSet* registers)
+{
+    regs = registers;
+}
+
+
+
+void EmuSerial::setParentSysPtr(EmuSys* parent_sys)
+{
+    sys = parent_sys;
+}
+
+
+
+/**
+ * @brief Sets the other end of the link cable.
+ * @param peer nullptr for no cable, which reads 0xFF.
+ */
+void EmuSerial::setPeer(SerialPeer* peer) noexcept
+{
+    this->peer = peer;
+    if(regs != nullptr) { notifyPeer(); }
+}
+
+
+
+/**
+ * @brief Cancels any transfer and clears SB and SC.
+ */
+void EmuSerial::reset(void) noexcept
+{
+    state = State{};
+    state.transferEndCycle = SERIAL_NO_EVENT;
+
+    if(regs == nullptr) { return; }
+
+    regs->mem.io.sb = 0;
+    regs->mem.io.sc = SC_UNUSED;
+}
+
+
+
+/**
+ * @brief Reads a serial register.
+ * @param address $FF01-$FF02
+ * @returns Register value with unused bits set.
+ */
+uint8_t EmuSerial::readRegister(uint16_t address) const noexcept
+{
+    if(regs == nullptr) { return 0xFF; }
+
+    switch(address)
+    {
+    case 0xFF01: return regs->mem.io.sb;
+    case 0xFF02: return regs->mem.io.sc | SC_UNUSED;
+    default: return 0xFF;
+    }
+}
+
+
+
+/**
+ * @brief Writes a serial register, starting a transfer if SC asks for one.
+ * @param address $FF01-$FF02
+ * @param value
+ */
+void EmuSerial::writeRegister(uint16_t address, uint8_t value) noexcept
+{
+    if(regs == nullptr) { return; }
+
+    if(address == 0xFF01)
+    {
+        regs->mem.io.sb = value;
+        notifyPeer();
+        return;
+    }
+
+    if(address != 0xFF02) { return; }
+
+    regs->mem.io.sc = value | SC_UNUSED;
+
+    // Only this end's clock needs an event. The other end's transfer is
+    // finished by its peer calling receive().
+    if((value & SC_TRANSFER) != 0 && (value & SC_INTERNAL_CLOCK) != 0)
+    {
+        uint64_t cycle = (sys != nullptr) ? sys->getCycleCount() : 0;
+        state.transferEndCycle = cycle + SERIAL_TRANSFER_CYCLES;
+        if(sys != nullptr) { sys->scheduleEvent(state.transferEndCycle); }
+    } else
+    {
+        state.transferEndCycle = SERIAL_NO_EVENT;
+    }
+
+    notifyPeer();
+}
+
+
+
+/**
+ * @brief Answers a transfer clocked by the peer. Only does anything if a
+ * transfer on the external clock is waiting.
+ * @param byte Byte shifted in.
+ * @returns Byte shifted out, 0xFF if not waiting.
+ */
+uint8_t EmuSerial::receive(uint8_t byte) noexcept
+{
+    if(regs == nullptr) { return 0xFF; }
+
+    uint8_t control = regs->mem.io.sc;
+    if((control & SC_TRANSFER) == 0 || (control & SC_INTERNAL_CLOCK) != 0)
+    {
+        return 0xFF;
+    }
+
+    uint8_t sent = regs->mem.io.sb;
+    finishTransfer(byte);
+    return sent;
+}
+
+
+
+/**
+ * @brief Returns the cycle the current transfer finishes, or
+ * SERIAL_NO_EVENT.
+ */
+uint64_t EmuSerial::getNextEventCycle(void) const noexcept
+{
+    return state.transferEndCycle;
+}
+
+
+
+/**
+ * @brief Finishes a transfer due by a cycle.
+ * @param cycle
+ */
+void EmuSerial::runEvents(uint64_t cycle) noexcept
+{
+    if(regs == nullptr || cycle < state.transferEndCycle) { return; }
+
+    state.transferEndCycle = SERIAL_NO_EVENT;
+
+    uint8_t sent = regs->mem.io.sb;
+    finishTransfer((peer != nullptr) ? peer->exchange(sent) : 0xFF);
+}
+
+
+
+/**
+ * @brief Stores the byte shifted in, ends the transfer and requests the
+ * serial interrupt.
+ */
+void EmuSerial::finishTransfer(uint8_t byte) noexcept
+{
+    regs->mem.io.sb = byte;
+    regs->mem.io.sc &= ~SC_TRANSFER;
+    regs->mem.io.iflag |= SERIAL_INTERRUPT;
+    notifyPeer();
+}
+
+
+
+void EmuSerial::notifyPeer(void) noexcept
+{
+    if(peer == nullptr) { return; }
+
+    uint8_t control = regs->mem.io.sc;
+    bool waiting = (control & SC_TRANSFER) != 0
+        && (control & SC_INTERNAL_CLOCK) == 0;
+
+    peer->notifyReady(regs->mem.io.sb, waiting);
+}
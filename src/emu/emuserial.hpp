@@ -0,0 +1,127 @@
+/**
+ * @file emu/emuserial.hpp
+ * @brief Implements the system's serial port
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "emuregisters.hpp"
+
+class EmuSys;
+
+// SB, SC, $FF01-$FF02
+constexpr uint16_t SERIAL_REG_START = 0xFF01;
+constexpr uint16_t SERIAL_REG_END = 0xFF02;
+
+// 8 bits at 8192 Hz
+constexpr uint64_t SERIAL_TRANSFER_CYCLES = 4096;
+
+// No transfer is pending
+constexpr uint64_t SERIAL_NO_EVENT = UINT64_MAX;
+
+/**
+ * @brief The other end of a link cable.
+ */
+class SerialPeer
+{
+public:
+    virtual ~SerialPeer() = default;
+
+    /**
+     * @brief Swaps bytes with the other end, for a transfer clocked by this
+     * end.
+     * @param byte Byte shifted out.
+     * @returns Byte shifted in, 0xFF if the other end wasn't listening.
+     */
+    virtual uint8_t exchange(uint8_t byte) noexcept = 0;
+
+    /**
+     * @brief Tells the other end what this end would shift out if clocked
+     * now. Called whenever SB or SC is written or a transfer finishes, so a
+     * peer in another process can answer without asking.
+     * @param byte SB
+     * @param waiting Whether a transfer on the external clock is waiting.
+     */
+    virtual void notifyReady(uint8_t byte, bool waiting) noexcept {}
+};
+
+/**
+ * @brief Emulates SB and SC. A transfer on the internal clock is scheduled
+ * to finish SERIAL_TRANSFER_CYCLES later, when it swaps bytes with the peer
+ * in one go. A transfer on the external clock waits for the peer to clock
+ * it.
+ */
+class EmuSerial
+{
+public:
+    EmuSerial(RegisterSet* registers = nullptr, EmuSys* parent_sys = nullptr);
+    ~EmuSerial();
+
+    void setRegisters(RegisterSet* registers);
+    void setParentSysPtr(EmuSys* parent_sys);
+
+    /**
+     * @brief Sets the other end of the link cable.
+     * @param peer nullptr for no cable, which reads 0xFF.
+     */
+    void setPeer(SerialPeer* peer) noexcept;
+
+    /**
+     * @brief Cancels any transfer and clears SB and SC.
+     */
+    void reset(void) noexcept;
+
+    /**
+     * @brief Reads a serial register.
+     * @param address $FF01-$FF02
+     * @returns Register value with unused bits set.
+     */
+    uint8_t readRegister(uint16_t address) const noexcept;
+
+    /**
+     * @brief Writes a serial register, starting a transfer if SC asks for
+     * one.
+     * @param address $FF01-$FF02
+     * @param value
+     */
+    void writeRegister(uint16_t address, uint8_t value) noexcept;
+
+    /**
+     * @brief Answers a transfer clocked by the peer. Only does anything if
+     * a transfer on the external clock is waiting.
+     * @param byte Byte shifted in.
+     * @returns Byte shifted out, 0xFF if not waiting.
+     */
+    uint8_t receive(uint8_t byte) noexcept;
+
+    /**
+     * @brief Returns the cycle the current transfer finishes, or
+     * SERIAL_NO_EVENT.
+     */
+    uint64_t getNextEventCycle(void) const noexcept;
+
+    /**
+     * @brief Finishes a transfer due by a cycle.
+     * @param cycle
+     */
+    void runEvents(uint64_t cycle) noexcept;
+
+    // Everything needed to resume emulation exactly.
+    struct State
+    {
+        uint64_t transferEndCycle;
+    };
+
+    State state{};
+
+private:
+    RegisterSet* regs;
+    EmuSys* sys;
+    SerialPeer* peer = nullptr;
+
+    void finishTransfer(uint8_t byte) noexcept;
+    void notifyPeer(void) noexcept;
+};
@@ -0,0 +1,259 @@
+/**
+ * @file emu/emustate.cpp
+ * @brief Reads and writes save states as tagged binary blocks
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "emustate.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <fmt/core.h>
+
+constexpr char STATE_MAGIC[8] = { 'I', 'M', 'G', 'B', 'E', 'S', 'T', 'A' };
+// Magic, then version
+constexpr size_t STATE_HEADER_SIZE = sizeof(STATE_MAGIC) + 4;
+// Tag, then size
+constexpr size_t BLOCK_HEADER_SIZE = 8;
+
+
+
+StateWriter::StateWriter(std::vector<uint8_t>& buffer) :
+    buffer(buffer)
+{
+    buffer.clear();
+    buffer.resize(STATE_HEADER_SIZE);
+    std::memcpy(buffer.data(), STATE_MAGIC, sizeof(STATE_MAGIC));
+    std::memcpy(
+        buffer.data() + sizeof(STATE_MAGIC), &STATE_VERSION, 4
+    );
+}
+
+StateWriter::~StateWriter()
+{}
+
+
+
+/**
+ * @brief Appends a block to be filled in, for data that isn't in one piece.
+ * @param tag Four characters.
+ * @param size
+ * @returns The block's bytes, valid until the next block is added.
+ */
+uint8_t* StateWriter::addBlock(const char* tag, size_t size)
+{
+    uint32_t block_size = static_cast<uint32_t>(size);
+
+    size_t pos = buffer.size();
+    buffer.resize(pos + BLOCK_HEADER_SIZE + size);
+
+    uint8_t* block = buffer.data() + pos;
+    std::memcpy(block, tag, 4);
+    std::memcpy(block + 4, &block_size, 4);
+    return block + BLOCK_HEADER_SIZE;
+}
+
+
+
+/**
+ * @brief Appends a block.
+ * @param tag Four characters.
+ * @param data
+ * @param size
+ */
+void StateWriter::writeBlock(const char* tag, const void* data, size_t size)
+{
+    std::memcpy(addBlock(tag, size), data, size);
+}
+
+
+
+/**
+ * @brief Checks a state's header and block layout.
+ * @param data
+ * @param size
+ * @throws std::runtime_error if not a save state, or the wrong version.
+ */
+StateReader::StateReader(const uint8_t* data, size_t size) :
+    data(data),
+    size(size)
+{
+    if(size < STATE_HEADER_SIZE
+       || std::memcmp(data, STATE_MAGIC, sizeof(STATE_MAGIC)) != 0)
+    {
+        throw std::runtime_error("Not a save state!");
+    }
+
+    uint32_t version;
+    std::memcpy(&version, data + sizeof(STATE_MAGIC), 4);
+    if(version != STATE_VERSION)
+    {
+        throw std::runtime_error(fmt::format(
+            "Save state is version {}, expected {}!", version, STATE_VERSION
+        ));
+    }
+
+    // Checked once here, so finding blocks can't run off the end.
+    size_t pos = STATE_HEADER_SIZE;
+    while(pos < size)
+    {
+        uint32_t block_size;
+        if(size - pos < BLOCK_HEADER_SIZE) { pos = SIZE_MAX; break; }
+        std::memcpy(&block_size, data + pos + 4, 4);
+        if(size - pos - BLOCK_HEADER_SIZE < block_size)
+        {
+            pos = SIZE_MAX;
+            break;
+        }
+        pos += BLOCK_HEADER_SIZE + block_size;
+    }
+
+    if(pos != size)
+    {
+        throw std::runtime_error("Save state is truncated!");
+    }
+}
+
+StateReader::~StateReader()
+{}
+
+
+
+/**
+ * @brief Returns a block's bytes.
+ * @param tag Four characters.
+ * @param size Expected size.
+ * @throws std::runtime_error if missing or a different size.
+ */
+const uint8_t* StateReader::readBlock(const char* tag, size_t size) const
+{
+    size_t pos = STATE_HEADER_SIZE;
+    while(pos < this->size)
+    {
+        uint32_t block_size;
+        std::memcpy(&block_size, data + pos + 4, 4);
+
+        if(std::memcmp(data + pos, tag, 4) == 0)
+        {
+            if(block_size != size)
+            {
+                throw std::runtime_error(fmt::format(
+                    "Save state block {:.4} is {} bytes, expected {}!",
+                    tag, block_size, size
+                ));
+            }
+            return data + pos + BLOCK_HEADER_SIZE;
+        }
+
+        pos += BLOCK_HEADER_SIZE + block_size;
+    }
+
+    throw std::runtime_error(fmt::format(
+        "Save state is missing block {:.4}!", tag
+    ));
+}
+
+
+
+/**
+ * @brief Checks a value read from a block is below a limit, e.g. an enum or a
+ * bank index.
+ * @param tag Four characters.
+ * @param field
+ * @param value
+ * @param limit
+ * @throws std::runtime_error if not.
+ */
+void StateReader::checkRange(
+    const char* tag, const char* field, uint64_t value, uint64_t limit
+)
+{
+    if(value >= limit)
+    {
+        throw std::runtime_error(fmt::format(
+            "Save state block {:.4} has {} {}, expected below {}!",
+            tag, field, value, limit
+        ));
+    }
+}
+
+
+
+/**
+ * @brief Checks a bool read from a block holds 0 or 1.
+ * @param tag Four characters.
+ * @param field
+ * @param value
+ * @throws std::runtime_error if not.
+ */
+void StateReader::checkBool(
+    const char* tag, const char* field, const bool& value
+)
+{
+    // Any other byte is undefined once used as a bool, so look at the byte.
+    uint8_t byte;
+    std::memcpy(&byte, &value, 1);
+    checkRange(tag, field, byte, 2);
+}
+
+
+
+/**
+ * @brief Writes a save state to a file.
+ * @param file_path
+ * @param state
+ * @throws std::ios_base::failure on file error.
+ */
+void writeStateFile(
+    const std::filesystem::path& file_path,
+    const std::vector<uint8_t>& state
+)
+{
+    std::ofstream file(file_path, std::ios::binary);
+    if(!file.is_open())
+    {
+        throw std::ios_base::failure(fmt::format(
+            "Cannot open file {}!", file_path.string()
+        ));
+    }
+
+    file.write(reinterpret_cast<const char*>(state.data()), state.size());
+
+    if(!file)
+    {
+        throw std::ios_base::failure(fmt::format(
+            "Cannot write file {}!", file_path.string()
+        ));
+    }
+}
+
+
+
+/**
+ * @brief Reads a save state from a file.
+ * @param file_path
+ * @throws std::ios_base::failure on file error.
+ */
+std::vector<uint8_t> readStateFile(const std::filesystem::path& file_path)
+{
+    std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+    if(!file.is_open())
+    {
+        throw std::ios_base::failure(fmt::format(
+            "Cannot open file {}!", file_path.string()
+        ));
+    }
+
+    std::vector<uint8_t> state(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(state.data()), state.size());
+
+    if(!file)
+    {
+        throw std::ios_base::failure(fmt::format(
+            "Cannot read file {}!", file_path.string()
+        ));
+    }
+
+    return state;
+}
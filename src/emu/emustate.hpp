@@ -0,0 +1,156 @@
+/**
+ * @file emu/emustate.hpp
+ * @brief Reads and writes save states as tagged binary blocks
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+#include <vector>
+
+// Bumped whenever a block's layout changes. Older states are refused.
+constexpr uint32_t STATE_VERSION = 1;
+
+/**
+ * @brief Builds a save state in a byte buffer.
+ *
+ * A state is a header, then blocks of a four-character tag, a 32-bit size,
+ * and the block's bytes. Blocks are POD structs copied as they are in
+ * memory, so states are only portable between builds for the same
+ * (little-endian) platform, like RegisterSet itself.
+ */
+class StateWriter
+{
+public:
+    /**
+     * @brief Starts a state, replacing a buffer's contents but keeping its
+     * memory, so saving repeatedly into one buffer doesn't allocate.
+     * @param buffer
+     */
+    StateWriter(std::vector<uint8_t>& buffer);
+    ~StateWriter();
+
+    /**
+     * @brief Appends a block to be filled in, for data that isn't in one
+     * piece.
+     * @param tag Four characters.
+     * @param size
+     * @returns The block's bytes, valid until the next block is added.
+     */
+    uint8_t* addBlock(const char* tag, size_t size);
+
+    /**
+     * @brief Appends a block.
+     * @param tag Four characters.
+     * @param data
+     * @param size
+     */
+    void writeBlock(const char* tag, const void* data, size_t size);
+
+    /**
+     * @brief Appends a POD as a block.
+     * @param tag Four characters.
+     * @param value
+     */
+    template<typename T>
+    void write(const char* tag, const T& value)
+    {
+        static_assert(
+            std::is_trivially_copyable_v<T>, "State blocks must be POD"
+        );
+        writeBlock(tag, &value, sizeof(T));
+    }
+
+private:
+    std::vector<uint8_t>& buffer;
+};
+
+/**
+ * @brief Finds blocks in a save state. The data must outlive the reader.
+ */
+class StateReader
+{
+public:
+    /**
+     * @brief Checks a state's header and block layout.
+     * @param data
+     * @param size
+     * @throws std::runtime_error if not a save state, or the wrong version.
+     */
+    StateReader(const uint8_t* data, size_t size);
+    ~StateReader();
+
+    /**
+     * @brief Returns a block's bytes.
+     * @param tag Four characters.
+     * @param size Expected size.
+     * @throws std::runtime_error if missing or a different size.
+     */
+    const uint8_t* readBlock(const char* tag, size_t size) const;
+
+    /**
+     * @brief Reads a block into a POD.
+     * @param tag Four characters.
+     * @param value
+     * @throws std::runtime_error if missing or a different size.
+     */
+    template<typename T>
+    void read(const char* tag, T& value) const
+    {
+        static_assert(
+            std::is_trivially_copyable_v<T>, "State blocks must be POD"
+        );
+        std::memcpy(&value, readBlock(tag, sizeof(T)), sizeof(T));
+    }
+
+    /**
+     * @brief Checks a value read from a block is below a limit, e.g. an enum
+     * or a bank index.
+     * @param tag Four characters.
+     * @param field
+     * @param value
+     * @param limit
+     * @throws std::runtime_error if not.
+     */
+    static void checkRange(
+        const char* tag, const char* field, uint64_t value, uint64_t limit
+    );
+
+    /**
+     * @brief Checks a bool read from a block holds 0 or 1.
+     * @param tag Four characters.
+     * @param field
+     * @param value
+     * @throws std::runtime_error if not.
+     */
+    static void checkBool(
+        const char* tag, const char* field, const bool& value
+    );
+
+private:
+    const uint8_t* data;
+    size_t size;
+};
+
+/**
+ * @brief Writes a save state to a file.
+ * @param file_path
+ * @param state
+ * @throws std::ios_base::failure on file error.
+ */
+void writeStateFile(
+    const std::filesystem::path& file_path,
+    const std::vector<uint8_t>& state
+);
+
+/**
+ * @brief Reads a save state from a file.
+ * @param file_path
+ * @throws std::ios_base::failure on file error.
+ */
+std::vector<uint8_t> readStateFile(const std::filesystem::path& file_path);
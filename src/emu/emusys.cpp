@@ -6,6 +6,7 @@
  */
 
 #include "emusys.hpp"
+#include <algorithm>
 #include <fmt/core.h>
 #include "../logger.hpp"
 
@@ -15,20 +16,81 @@ EmuSys::EmuSys() :
     mem(),
     cart(&mem),
     cpu(&mem, this),
-    ppu(&mem, &cpu)
+    ppu(&mem, &cpu),
+    apu(cpu.getRegsPtr(), this),
+    timer(cpu.getRegsPtr(), this),
+    serial(cpu.getRegsPtr(), this),
+    joypad(cpu.getRegsPtr())
 {
-    mem.setCPURegisters(cpu.getRegsPtr());
+    connectDevices();
     logMessage("Emulated system created.", LOG_INFO);
 }
 
+EmuSys::EmuSys(const EmuSys& other) :
+    loaded(other.loaded),
+    running(other.running),
+    paused(other.paused),
+    romFilePath(other.romFilePath),
+    mem(other.mem),
+    cart(other.cart),
+    cpu(other.cpu),
+    ppu(other.ppu),
+    apu(other.apu),
+    timer(other.timer),
+    serial(other.serial),
+    joypad(other.joypad),
+    inputSource(nullptr),
+    inputFrame(other.inputFrame),
+    cpu_speed(other.cpu_speed),
+    cycleCount(other.cycleCount),
+    frameEndCycle(other.frameEndCycle),
+    sliceEndCycle(other.sliceEndCycle),
+    frameStarted(other.frameStarted),
+    nextEventCycle(other.nextEventCycle)
+{
+    connectDevices();
+    serial.setPeer(nullptr);
+    ppu.setRenderThread(nullptr);
+
+    // The render thread has the newest frame, not the PPU.
+    if(other.isThreadedRendering())
+    {
+        const uint8_t* frame = other.getFrameBuffer();
+        std::copy(frame, frame + aheadFrame.size(), aheadFrame.begin());
+        ppu.setFrameBuffer(aheadFrame);
+    }
+}
+
 
 
 EmuSys::~EmuSys()
 {
+    setThreadedRendering(false);
     logMessage("Emulated system destroyed.", LOG_INFO);
 }
 
 
+/**
+ * @brief Makes an independent copy of the system as it is now, to run ahead
+ * of or alongside it. Memory is shared until either side writes to it, a
+ * bank at a time, and the ROM is never copied. The copy has no input
+ * source, since sources keep a read position, and isn't recorded, linked,
+ * or rendering on a thread. Attach its own source, and the copy and the
+ * original can then run on different threads.
+ * @throws std::runtime_error on system not running.
+ */
+std::unique_ptr<EmuSys> EmuSys::clone(void) const
+{
+    if(!running)
+    {
+        throw std::runtime_error("Cannot clone system that is not running!");
+    }
+
+    return std::unique_ptr<EmuSys>(new EmuSys(*this));
+}
+
+
+
 /**
  * @brief Attempts to load a ROM file into the emulator
  * @param file_path Path to ROM file
@@ -43,27 +105,148 @@ void EmuSys::loadROM(std::filesystem::path file_path)
 
 
 
+/**
+ * @brief Loads a ROM image from memory. Battery-backed RAM isn't saved.
+ * @param data Copied, so it needn't outlive the call.
+ * @param size
+ * @throws std::runtime_error on invalid ROM.
+ */
+void EmuSys::loadROM(const uint8_t* data, size_t size)
+{
+    cart.loadROM(data, size);
+    loaded = true;
+}
+
+
+
 /**
  * @brief Runs through one frame of emulation if not paused
  * @throws std::runtime_error on system not running.
  */
 void EmuSys::runFrame(void)
+{
+    runFrameSlice(UINT64_MAX);
+}
+
+
+
+/**
+ * @brief Runs part of a frame, for interleaving with other systems. Input
+ * is polled when a frame starts, and audio is finished when it ends.
+ * @param max_cycles Stops after at least this many cycles.
+ * @returns true if the frame finished.
+ * @throws std::runtime_error on system not running.
+ */
+bool EmuSys::runFrameSlice(uint64_t max_cycles)
 {
     if(!running)
     {
         throw std::runtime_error("Cannot step system that is not running!");
     }
 
-    if(paused) { return; }
+    if(paused) { return false; }
+
+    // Frames end on exact multiples of EMU_CYCLES_PER_FRAME. Instruction
+    // overshoot is carried into the next frame, and a frame interrupted by
+    // a breakpoint resumes towards the same boundary.
+    if(!frameStarted)
+    {
+        frameStarted = true;
+        pollInput();
+
+        while(frameEndCycle <= cycleCount)
+        {
+            frameEndCycle += EMU_CYCLES_PER_FRAME;
+        }
+    }
 
-    int cycles_per_frame = static_cast<int>(cpu_speed / 59.7);
-    int cycles = 0;
+    sliceEndCycle = (max_cycles < frameEndCycle - cycleCount)
+        ? cycleCount + max_cycles
+        : frameEndCycle;
 
-    while(cycles < cycles_per_frame)
+    while(cycleCount < sliceEndCycle)
     {
-        // FIXME: This breaks frame timing
         if(paused) { break; } // CPU breakpoints pause in-frame
-        cycles += step(true); // TEMP: Will not log by default
+        step(false);
+    }
+
+    if(cycleCount < frameEndCycle) { return false; }
+
+    frameStarted = false;
+    apu.endFrame();
+    return true;
+}
+
+
+
+/**
+ * @brief Runs a frame, then runs further frames to show the newest, and
+ * puts the system back to the end of the first. Input takes effect on
+ * screen that many frames sooner. Further frames are silent and only the
+ * newest is composed.
+ * @param frames Frames to run ahead, 0 is the same as runFrame().
+ * @throws std::runtime_error on system not running.
+ */
+void EmuSys::runFrameAhead(unsigned int frames)
+{
+    if(frames == 0)
+    {
+        runFrame();
+        return;
+    }
+
+    // The render thread can't follow the system going back.
+    setThreadedRendering(false);
+
+    unsigned int render_interval = getRenderInterval();
+    bool audio_enabled = isAudioEnabled();
+    InputStream* recorder = inputRecorder;
+
+    auto restore = [&]()
+    {
+        setRenderInterval(render_interval);
+        setAudioEnabled(audio_enabled);
+        inputRecorder = recorder;
+    };
+
+    try
+    {
+        // The PPU decides whether to compose a frame when it starts, which
+        // can be in the system frame before the one shown.
+        setRenderInterval((frames == 1) ? render_interval : 0);
+        runFrame();
+        if(paused || !running)
+        {
+            restore();
+            return;
+        }
+
+        saveState(aheadState);
+        apu.getOutput(aheadOutput);
+
+        // What happens ahead is only a guess, so it isn't recorded.
+        setAudioEnabled(false);
+        inputRecorder = nullptr;
+
+        for(unsigned int i = 1; i <= frames && !paused; i++)
+        {
+            setRenderInterval((i + 1 >= frames) ? render_interval : 0);
+            runFrame();
+        }
+
+        const uint8_t* frame = ppu.getFrameBuffer();
+        std::copy(frame, frame + aheadFrame.size(), aheadFrame.begin());
+
+        // A breakpoint ahead is hit for real later.
+        paused = false;
+        restore();
+        loadState(aheadState);
+        apu.setOutput(aheadOutput);
+        ppu.setFrameBuffer(aheadFrame);
+    } catch(...)
+    {
+        restore();
+        throw;
     }
 }
 
@@ -82,11 +265,43 @@ int EmuSys::step(bool log_instruction)
 
     int cycles = cpu.step(log_instruction);
     ppu.step(cycles);
+    cycleCount += cycles;
+
+    // The only per-instruction cost of timed devices is this check
+    if(cycleCount >= nextEventCycle) { runEvents(); }
+
     return cycles;
 }
 
 
 
+/**
+ * @brief Steps the system until at least a given number of cycles have run,
+ * or it is paused or stopped. Input is polled at the same frame boundaries
+ * as runFrame(), however the cycles are split across calls, so recordings
+ * replay the same either way.
+ * @param cycles
+ * @throws std::runtime_error on system not running.
+ */
+void EmuSys::runCycles(uint64_t cycles)
+{
+    if(!running)
+    {
+        throw std::runtime_error("Cannot step system that is not running!");
+    }
+
+    uint64_t target = cycleCount + cycles;
+    while(cycleCount < target && running && !paused)
+    {
+        runFrameSlice(target - cycleCount);
+    }
+
+    // Hand over audio up to here, even if the frame isn't over.
+    apu.endFrame();
+}
+
+
+
 /**
  * @brief Starts the system with an opened ROM.
  * @throws std::runtime_error on ROM not loaded.
@@ -98,7 +313,15 @@ void EmuSys::start(void)
         throw std::runtime_error("Cannot start system without loaded ROM!");
     }
 
+    // Post-boot register values first, which the timer then starts from
     cpu.initRegs();
+    timer.reset();
+    apu.reset();
+    serial.reset();
+    joypad.reset();
+    inputFrame = 0;
+    frameStarted = false;
+    nextEventCycle = 0;
 
     running = true;
     // TEMP WHILE DEBUGGING INSTRUCTIONS
@@ -189,6 +412,454 @@ bool EmuSys::isPaused(void) const noexcept
 
 
 
+/**
+ * @brief Sets how often the PPU composes frames. Emulation is unaffected.
+ * @param interval 1 renders every frame, N renders 1 in N, 0 never renders.
+ */
+void EmuSys::setRenderInterval(unsigned int interval) noexcept
+{
+    ppu.setRenderInterval(interval);
+}
+
+
+
+unsigned int EmuSys::getRenderInterval(void) const noexcept
+{
+    return ppu.getRenderInterval();
+}
+
+
+
+/**
+ * @brief Moves pixel composition to a dedicated render thread.
+ * @param enabled
+ */
+void EmuSys::setThreadedRendering(bool enabled)
+{
+    if(enabled == isThreadedRendering()) { return; }
+
+    if(enabled)
+    {
+        renderThread = std::make_unique<EmuRenderThread>();
+        renderThread->start(mem.getVRAMPtr(), mem.getOAMPtr());
+        ppu.setRenderThread(renderThread.get());
+        logMessage("Threaded rendering enabled.", LOG_INFO);
+    } else
+    {
+        ppu.setRenderThread(nullptr);
+        renderThread.reset();
+        logMessage("Threaded rendering disabled.", LOG_INFO);
+    }
+}
+
+
+
+bool EmuSys::isThreadedRendering(void) const noexcept
+{
+    return renderThread != nullptr;
+}
+
+
+
+/**
+ * @brief Sets the audio output sample rate. Drops buffered audio.
+ * @param sample_rate Hz
+ */
+void EmuSys::setAudioSampleRate(int sample_rate) noexcept
+{
+    apu.setSampleRate(sample_rate);
+}
+
+
+
+int EmuSys::getAudioSampleRate(void) const noexcept
+{
+    return apu.getSampleRate();
+}
+
+
+
+/**
+ * @brief Scales audio output for dynamic rate control.
+ * @param ratio Around 1.0, e.g. from pacerGetRateAdjust().
+ */
+void EmuSys::setAudioRateAdjust(double ratio) noexcept
+{
+    apu.setRateAdjust(ratio);
+}
+
+
+
+/**
+ * @brief Enables or disables audio synthesis. Sound emulation continues
+ * either way.
+ * @param enabled
+ */
+void EmuSys::setAudioEnabled(bool enabled) noexcept
+{
+    apu.setSynthesisEnabled(enabled);
+}
+
+
+
+bool EmuSys::isAudioEnabled(void) const noexcept
+{
+    return apu.isSynthesisEnabled();
+}
+
+
+
+/**
+ * @brief Returns the number of stereo audio frames ready to be read.
+ */
+size_t EmuSys::getAudioFramesAvailable(void) const noexcept
+{
+    return apu.getAvailableFrames();
+}
+
+
+
+/**
+ * @brief Moves up to max_frames interleaved 16-bit stereo frames into dest.
+ * @param dest Room for max_frames * 2 samples.
+ * @param max_frames
+ * @returns Number of frames read.
+ */
+size_t EmuSys::readAudio(int16_t* dest, size_t max_frames) noexcept
+{
+    return apu.readSamples(dest, max_frames);
+}
+
+
+
+/**
+ * @brief Returns the audio frames ready to be read, interleaved, in place.
+ * There are getAudioFramesAvailable() of them. Valid until the system next
+ * runs or audio is read.
+ */
+const int16_t* EmuSys::getAudio(void) const noexcept
+{
+    return apu.getSamples();
+}
+
+
+
+/**
+ * @brief Drops the audio frames ready to be read, for callers that read
+ * them in place.
+ */
+void EmuSys::discardAudio(void) noexcept
+{
+    apu.discardSamples();
+}
+
+
+
+/**
+ * @brief Sets where joypad input comes from. It is asked for the held
+ * buttons at the start of every frame.
+ * @param source nullptr for no buttons held.
+ */
+void EmuSys::setInputSource(InputSource* source) noexcept
+{
+    inputSource = source;
+}
+
+
+
+InputSource* EmuSys::getInputSource(void) const noexcept
+{
+    return inputSource;
+}
+
+
+
+/**
+ * @brief Returns the buttons held on the current, or last run, frame.
+ */
+uint8_t EmuSys::getButtons(void) const noexcept
+{
+    return joypad.getButtons();
+}
+
+
+
+/**
+ * @brief Records the buttons used on every frame into a stream.
+ * @param recorder nullptr to stop recording.
+ */
+void EmuSys::setInputRecorder(InputStream* recorder) noexcept
+{
+    inputRecorder = recorder;
+}
+
+
+
+/**
+ * @brief Returns the number of frames run since the system started. Input
+ * is keyed by this.
+ */
+uint64_t EmuSys::getInputFrame(void) const noexcept
+{
+    return inputFrame;
+}
+
+
+
+/**
+ * @brief Connects the serial port to the other end of a link cable.
+ * @param peer nullptr to disconnect.
+ */
+void EmuSys::setSerialPeer(SerialPeer* peer) noexcept
+{
+    serial.setPeer(peer);
+}
+
+
+
+/**
+ * @brief Answers a serial transfer clocked by the other end of the link.
+ * @param byte Byte shifted in.
+ * @returns Byte shifted out, 0xFF if no transfer was waiting.
+ */
+uint8_t EmuSys::receiveSerial(uint8_t byte) noexcept
+{
+    return serial.receive(byte);
+}
+
+
+
+/**
+ * @brief Makes sure device events are checked by a cycle. Devices call this
+ * whenever they schedule something.
+ * @param cycle
+ */
+void EmuSys::scheduleEvent(uint64_t cycle) noexcept
+{
+    nextEventCycle = std::min(nextEventCycle, cycle);
+}
+
+
+
+/**
+ * @brief Ends the running frame slice after the current instruction, so
+ * whatever is running the slice can react to something mid-slice.
+ */
+void EmuSys::endSlice(void) noexcept
+{
+    sliceEndCycle = cycleCount;
+}
+
+
+
+/**
+ * @brief Saves the whole machine into a buffer, reusing the buffer's memory.
+ * The ROM isn't included.
+ * @param buffer
+ * @throws std::runtime_error on system not running.
+ */
+void EmuSys::saveState(std::vector<uint8_t>& buffer) const
+{
+    if(!running)
+    {
+        throw std::runtime_error(
+            "Cannot save state of system that is not running!"
+        );
+    }
+
+    StateWriter writer(buffer);
+
+    writer.write(
+        "SYS ", State{ cycleCount, frameEndCycle, inputFrame, frameStarted }
+    );
+    writer.write("CPU ", cpu.getState());
+    writer.write("PPU ", ppu.getState());
+    writer.write("APU ", apu.state);
+    writer.write("TIMR", timer.state);
+    writer.write("SER ", serial.state);
+    writer.write("JOYP", joypad.state);
+    mem.saveState(writer);
+}
+
+
+
+/**
+ * @brief Restores the whole machine from a save state of the same ROM.
+ * Nothing changes if it throws.
+ * @param buffer
+ * @throws std::runtime_error on system not running, or an invalid state.
+ */
+void EmuSys::loadState(const std::vector<uint8_t>& buffer)
+{
+    if(!running)
+    {
+        throw std::runtime_error(
+            "Cannot load state into system that is not running!"
+        );
+    }
+
+    // Every block is read before anything changes.
+    StateReader reader(buffer.data(), buffer.size());
+
+    State sys_state;
+    EmuCPU::State cpu_state;
+    EmuPPU::State ppu_state;
+    EmuAPU::State apu_state;
+    EmuTimer::State timer_state;
+    EmuSerial::State serial_state;
+    EmuJoypad::State joypad_state;
+
+    reader.read("SYS ", sys_state);
+    reader.read("CPU ", cpu_state);
+    reader.read("PPU ", ppu_state);
+    reader.read("APU ", apu_state);
+    reader.read("TIMR", timer_state);
+    reader.read("SER ", serial_state);
+    reader.read("JOYP", joypad_state);
+    StateReader::checkBool("SYS ", "frame started", sys_state.frameStarted);
+    EmuCPU::checkState(cpu_state);
+    EmuPPU::checkState(ppu_state);
+    EmuAPU::checkState(apu_state);
+    mem.loadState(reader);
+
+    cycleCount = sys_state.cycleCount;
+    frameEndCycle = sys_state.frameEndCycle;
+    inputFrame = sys_state.inputFrame;
+    frameStarted = sys_state.frameStarted;
+
+    // Registers first, the APU re-emits its output levels from them.
+    cpu.setState(cpu_state);
+    ppu.setState(ppu_state);
+    apu.setState(apu_state);
+    timer.state = timer_state;
+    serial.state = serial_state;
+    joypad.state = joypad_state;
+
+    // Devices reschedule from their restored state.
+    nextEventCycle = 0;
+
+    // The render thread keeps its own copy of VRAM and OAM.
+    if(isThreadedRendering())
+    {
+        setThreadedRendering(false);
+        setThreadedRendering(true);
+    }
+}
+
+
+
+/**
+ * @brief Saves the whole machine to a file.
+ * @param file_path
+ * @throws std::runtime_error on system not running.
+ * @throws std::ios_base::failure on file error.
+ */
+void EmuSys::saveStateFile(const std::filesystem::path& file_path) const
+{
+    std::vector<uint8_t> buffer;
+    saveState(buffer);
+    writeStateFile(file_path, buffer);
+}
+
+
+
+/**
+ * @brief Restores the whole machine from a file.
+ * @param file_path
+ * @throws std::runtime_error on system not running, or an invalid state.
+ * @throws std::ios_base::failure on file error.
+ */
+void EmuSys::loadStateFile(const std::filesystem::path& file_path)
+{
+    loadState(readStateFile(file_path));
+}
+
+
+
+/**
+ * @brief Returns the last completed frame as LCD_WIDTH * LCD_HEIGHT
+ * shades (0-3), row-major. Without threaded rendering, it stays at the same
+ * address for the life of the system.
+ */
+const uint8_t* EmuSys::getFrameBuffer(void) const noexcept
+{
+    return ppu.getFrameBuffer();
+}
+
+
+
+/**
+ * @brief Returns the CPU's registers and interrupt state.
+ */
+EmuCPU::State EmuSys::getCPUState(void) const noexcept
+{
+    return cpu.getState();
+}
+
+
+
+/**
+ * @brief Reads a byte as the CPU would, without side effects or logging.
+ * @param address
+ */
+uint8_t EmuSys::readMemory(uint16_t address) const noexcept
+{
+    try
+    {
+        return mem.readByte(address, true);
+    } catch(const std::exception&)
+    {
+        return 0xFF;
+    }
+}
+
+
+
+/**
+ * @brief Returns the RAM bank mapped at an address, for reading memory in
+ * place. Valid until the bank is switched or the system is cloned.
+ * @param address
+ * @returns nullptr for ROM, echo RAM, registers, or unmapped ERAM.
+ */
+const uint8_t* EmuSys::getMemoryPtr(uint16_t address) const noexcept
+{
+    return mem.getBankPtr(address);
+}
+
+
+
+/**
+ * @brief Returns the number of cycles run since creation.
+ */
+uint64_t EmuSys::getCycleCount(void) const noexcept
+{
+    return cycleCount;
+}
+
+
+
+/**
+ * @brief Returns the number of frames the PPU has completed.
+ */
+uint64_t EmuSys::getFrameCount(void) const noexcept
+{
+    return ppu.getFrameCount();
+}
+
+
+
+/**
+ * @brief Returns the frame number of the newest frame getFrameBuffer can
+ * return. With threaded rendering, it only changes once that frame is
+ * complete, so key uploads on this rather than getFrameCount.
+ */
+uint64_t EmuSys::getReadyFrame(void) const noexcept
+{
+    return ppu.getReadyFrame();
+}
+
+
+
 /**
  * @brief Dumps information of the current system state to LOG_DEBUG
  */
@@ -198,3 +869,76 @@ void EmuSys::dumpSystem(void) const
     mem.dumpMemory();
     logMessage("---END SYSTEM DUMP---", LOG_DEBUG);
 }
+
+
+
+/**
+ * @brief Points the devices at each other, and at this system.
+ */
+void EmuSys::connectDevices(void) noexcept
+{
+    RegisterSet* regs = cpu.getRegsPtr();
+
+    mem.setCPURegisters(regs);
+    mem.setPPU(&ppu);
+    mem.setAPU(&apu);
+    mem.setTimer(&timer);
+    mem.setSerial(&serial);
+    mem.setJoypad(&joypad);
+
+    cart.setMemoryPointer(&mem);
+    cpu.setMemPtr(&mem);
+    cpu.setParentSysPtr(this);
+    ppu.setMemory(&mem);
+    ppu.setCPU(&cpu);
+    apu.setRegisters(regs);
+    apu.setParentSysPtr(this);
+    timer.setRegisters(regs);
+    timer.setParentSysPtr(this);
+    serial.setRegisters(regs);
+    serial.setParentSysPtr(this);
+    joypad.setRegisters(regs);
+}
+
+
+
+/**
+ * @brief Hands this frame's buttons to the joypad, and records them.
+ */
+void EmuSys::pollInput(void)
+{
+    uint8_t buttons = (inputSource != nullptr)
+        ? inputSource->getButtons(inputFrame)
+        : 0;
+
+    joypad.setButtons(buttons);
+
+    if(inputRecorder != nullptr)
+    {
+        inputRecorder->setButtons(inputFrame, buttons);
+    }
+
+    inputFrame++;
+}
+
+
+
+/**
+ * @brief Runs every device event that is due, and finds the next one.
+ */
+void EmuSys::runEvents(void) noexcept
+{
+    if(cycleCount >= timer.getNextEventCycle())
+    {
+        timer.runEvents(cycleCount);
+    }
+
+    if(cycleCount >= serial.getNextEventCycle())
+    {
+        serial.runEvents(cycleCount);
+    }
+
+    nextEventCycle = std::min(
+        timer.getNextEventCycle(), serial.getNextEventCycle()
+    );
+}
@@ -8,10 +8,22 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
+#include <vector>
 #include "emumemory.hpp"
 #include "emucartridge.hpp"
 #include "emucpu.hpp"
 #include "emuppu.hpp"
+#include "emuapu.hpp"
+#include "emutimer.hpp"
+#include "emuserial.hpp"
+#include "emujoypad.hpp"
+#include "emuinput.hpp"
+#include "emustate.hpp"
+#include "emurenderthread.hpp"
+
+// 154 lines of 456 cycles each
+constexpr uint64_t EMU_CYCLES_PER_FRAME = 70224;
 
 class EmuSys
 {
@@ -19,6 +31,19 @@ public:
     EmuSys();
     ~EmuSys();
 
+    EmuSys& operator=(const EmuSys&) = delete;
+
+    /**
+     * @brief Makes an independent copy of the system as it is now, to run
+     * ahead of or alongside it. Memory is shared until either side writes
+     * to it, a bank at a time, and the ROM is never copied. The copy has no
+     * input source, since sources keep a read position, and isn't recorded,
+     * linked, or rendering on a thread. Attach its own source, and the copy
+     * and the original can then run on different threads.
+     * @throws std::runtime_error on system not running.
+     */
+    std::unique_ptr<EmuSys> clone(void) const;
+
     /**
      * @brief Attempts to load a ROM file into the emulator
      * @param file_path Path to ROM file
@@ -27,12 +52,40 @@ public:
      */
     void loadROM(std::filesystem::path file_path);
 
+    /**
+     * @brief Loads a ROM image from memory. Battery-backed RAM isn't saved.
+     * @param data Copied, so it needn't outlive the call.
+     * @param size
+     * @throws std::runtime_error on invalid ROM.
+     */
+    void loadROM(const uint8_t* data, size_t size);
+
     /**
      * @brief Runs through one frame of emulation if not paused
      * @throws std::runtime_error on system not running.
      */
     void runFrame(void);
 
+    /**
+     * @brief Runs part of a frame, for interleaving with other systems.
+     * Input is polled when a frame starts, and audio is finished when it
+     * ends.
+     * @param max_cycles Stops after at least this many cycles.
+     * @returns true if the frame finished.
+     * @throws std::runtime_error on system not running.
+     */
+    bool runFrameSlice(uint64_t max_cycles);
+
+    /**
+     * @brief Runs a frame, then runs further frames to show the newest,
+     * and puts the system back to the end of the first. Input takes effect
+     * on screen that many frames sooner. Further frames are silent and
+     * only the newest is composed.
+     * @param frames Frames to run ahead, 0 is the same as runFrame().
+     * @throws std::runtime_error on system not running.
+     */
+    void runFrameAhead(unsigned int frames);
+
     /**
      * @brief Steps the system by one CPU instruction
      * @throws std::runtime_error on system not running.
@@ -41,6 +94,16 @@ public:
      */
     int step(bool log_instruction);
 
+    /**
+     * @brief Steps the system until at least a given number of cycles have
+     * run, or it is paused or stopped. Input is polled at the same frame
+     * boundaries as runFrame(), however the cycles are split across calls,
+     * so recordings replay the same either way.
+     * @param cycles
+     * @throws std::runtime_error on system not running.
+     */
+    void runCycles(uint64_t cycles);
+
     /**
      * @brief Starts the system with an opened ROM.
      * @throws std::runtime_error on ROM not loaded.
@@ -77,6 +140,199 @@ public:
     bool isRunning(void) const noexcept;
     bool isPaused(void) const noexcept;
 
+    /**
+     * @brief Sets how often the PPU composes frames. Emulation is unaffected.
+     * @param interval 1 renders every frame, N renders 1 in N, 0 never renders.
+     */
+    void setRenderInterval(unsigned int interval) noexcept;
+
+    unsigned int getRenderInterval(void) const noexcept;
+
+    /**
+     * @brief Moves pixel composition to a dedicated render thread.
+     * @param enabled
+     */
+    void setThreadedRendering(bool enabled);
+
+    bool isThreadedRendering(void) const noexcept;
+
+    /**
+     * @brief Sets the audio output sample rate. Drops buffered audio.
+     * @param sample_rate Hz
+     */
+    void setAudioSampleRate(int sample_rate) noexcept;
+
+    int getAudioSampleRate(void) const noexcept;
+
+    /**
+     * @brief Scales audio output for dynamic rate control.
+     * @param ratio Around 1.0, e.g. from pacerGetRateAdjust().
+     */
+    void setAudioRateAdjust(double ratio) noexcept;
+
+    /**
+     * @brief Enables or disables audio synthesis. Sound emulation continues
+     * either way.
+     * @param enabled
+     */
+    void setAudioEnabled(bool enabled) noexcept;
+
+    bool isAudioEnabled(void) const noexcept;
+
+    /**
+     * @brief Returns the number of stereo audio frames ready to be read.
+     */
+    size_t getAudioFramesAvailable(void) const noexcept;
+
+    /**
+     * @brief Moves up to max_frames interleaved 16-bit stereo frames into
+     * dest.
+     * @param dest Room for max_frames * 2 samples.
+     * @param max_frames
+     * @returns Number of frames read.
+     */
+    size_t readAudio(int16_t* dest, size_t max_frames) noexcept;
+
+    /**
+     * @brief Returns the audio frames ready to be read, interleaved, in
+     * place. There are getAudioFramesAvailable() of them. Valid until the
+     * system next runs or audio is read.
+     */
+    const int16_t* getAudio(void) const noexcept;
+
+    /**
+     * @brief Drops the audio frames ready to be read, for callers that
+     * read them in place.
+     */
+    void discardAudio(void) noexcept;
+
+    /**
+     * @brief Sets where joypad input comes from. It is asked for the held
+     * buttons at the start of every frame.
+     * @param source nullptr for no buttons held.
+     */
+    void setInputSource(InputSource* source) noexcept;
+
+    InputSource* getInputSource(void) const noexcept;
+
+    /**
+     * @brief Returns the buttons held on the current, or last run, frame.
+     */
+    uint8_t getButtons(void) const noexcept;
+
+    /**
+     * @brief Records the buttons used on every frame into a stream.
+     * @param recorder nullptr to stop recording.
+     */
+    void setInputRecorder(InputStream* recorder) noexcept;
+
+    /**
+     * @brief Returns the number of frames run since the system started.
+     * Input is keyed by this.
+     */
+    uint64_t getInputFrame(void) const noexcept;
+
+    /**
+     * @brief Connects the serial port to the other end of a link cable.
+     * @param peer nullptr to disconnect.
+     */
+    void setSerialPeer(SerialPeer* peer) noexcept;
+
+    /**
+     * @brief Answers a serial transfer clocked by the other end of the link.
+     * @param byte Byte shifted in.
+     * @returns Byte shifted out, 0xFF if no transfer was waiting.
+     */
+    uint8_t receiveSerial(uint8_t byte) noexcept;
+
+    /**
+     * @brief Makes sure device events are checked by a cycle. Devices call
+     * this whenever they schedule something.
+     * @param cycle
+     */
+    void scheduleEvent(uint64_t cycle) noexcept;
+
+    /**
+     * @brief Ends the running frame slice after the current instruction,
+     * so whatever is running the slice can react to something mid-slice.
+     */
+    void endSlice(void) noexcept;
+
+    /**
+     * @brief Saves the whole machine into a buffer, reusing the buffer's
+     * memory. The ROM isn't included.
+     * @param buffer
+     * @throws std::runtime_error on system not running.
+     */
+    void saveState(std::vector<uint8_t>& buffer) const;
+
+    /**
+     * @brief Restores the whole machine from a save state of the same ROM.
+     * Nothing changes if it throws.
+     * @param buffer
+     * @throws std::runtime_error on system not running, or an invalid state.
+     */
+    void loadState(const std::vector<uint8_t>& buffer);
+
+    /**
+     * @brief Saves the whole machine to a file.
+     * @param file_path
+     * @throws std::runtime_error on system not running.
+     * @throws std::ios_base::failure on file error.
+     */
+    void saveStateFile(const std::filesystem::path& file_path) const;
+
+    /**
+     * @brief Restores the whole machine from a file.
+     * @param file_path
+     * @throws std::runtime_error on system not running, or an invalid state.
+     * @throws std::ios_base::failure on file error.
+     */
+    void loadStateFile(const std::filesystem::path& file_path);
+
+    /**
+     * @brief Returns the last completed frame as LCD_WIDTH * LCD_HEIGHT
+     * shades (0-3), row-major. Without threaded rendering, it stays at the
+     * same address for the life of the system.
+     */
+    const uint8_t* getFrameBuffer(void) const noexcept;
+
+    /**
+     * @brief Returns the CPU's registers and interrupt state.
+     */
+    EmuCPU::State getCPUState(void) const noexcept;
+
+    /**
+     * @brief Reads a byte as the CPU would, without side effects or logging.
+     * @param address
+     */
+    uint8_t readMemory(uint16_t address) const noexcept;
+
+    /**
+     * @brief Returns the RAM bank mapped at an address, for reading memory
+     * in place. Valid until the bank is switched or the system is cloned.
+     * @param address
+     * @returns nullptr for ROM, echo RAM, registers, or unmapped ERAM.
+     */
+    const uint8_t* getMemoryPtr(uint16_t address) const noexcept;
+
+    /**
+     * @brief Returns the number of cycles run since creation.
+     */
+    uint64_t getCycleCount(void) const noexcept;
+
+    /**
+     * @brief Returns the number of frames the PPU has completed.
+     */
+    uint64_t getFrameCount(void) const noexcept;
+
+    /**
+     * @brief Returns the frame number of the newest frame getFrameBuffer
+     * can return. With threaded rendering, it only changes once that frame
+     * is complete, so key uploads on this rather than getFrameCount.
+     */
+    uint64_t getReadyFrame(void) const noexcept;
+
     /**
      * @brief Dumps information of the current system state to LOG_DEBUG
      */
@@ -92,6 +348,44 @@ private:
     EmuCartridge cart;
     EmuCPU cpu;
     EmuPPU ppu;
+    EmuAPU apu;
+    EmuTimer timer;
+    EmuSerial serial;
+    EmuJoypad joypad;
+
+    std::unique_ptr<EmuRenderThread> renderThread;
+
+    InputSource* inputSource = nullptr;
+    InputStream* inputRecorder = nullptr;
+    uint64_t inputFrame = 0;
 
     int cpu_speed = 4194304;
+    uint64_t cycleCount = 0;
+    uint64_t frameEndCycle = 0;
+    uint64_t sliceEndCycle = 0;
+    bool frameStarted = false;
+
+    // Earliest cycle any device may have an event due
+    uint64_t nextEventCycle = 0;
+
+    // Where run-ahead goes back to, kept between frames to avoid allocating
+    std::vector<uint8_t> aheadState;
+    EmuAPU::Output aheadOutput;
+    EmuPPU::FrameBuffer aheadFrame;
+
+    // Save state block of the system's own counters
+    struct State
+    {
+        uint64_t cycleCount;
+        uint64_t frameEndCycle;
+        uint64_t inputFrame;
+        bool frameStarted;
+    };
+
+    // Only through clone(), which documents what isn't copied
+    EmuSys(const EmuSys& other);
+
+    void connectDevices(void) noexcept;
+    void pollInput(void);
+    void runEvents(void) noexcept;
 };
@@ -0,0 +1,308 @@
+/**
+ * @file emu/emutimer.cpp
+ * @brief Implements the system's DIV and TIMA timers
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "emutimer.hpp"
+#include "emusys.hpp"
+
+// Cycles per TIMA increment, indexed by TAC's clock select bits. TIMA ticks
+// when bit (period / 2) of the internal divider falls.
+constexpr uint64_t TIMA_PERIODS[4] = { 1024, 16, 64, 256 };
+
+constexpr uint8_t TAC_ENABLE = 0b100;
+constexpr uint8_t TAC_UNUSED = 0xF8;
+constexpr uint8_t TIMER_INTERRUPT = 1 << 2;
+
+
+
+EmuTimer::EmuTimer(RegisterSet* registers, EmuSys* parent_sys)
+{
+    regs = registers;
+    sys = parent_sys;
+    state.nextOverflowCycle = TIMER_NO_EVENT;
+}
+
+EmuTimer::~EmuTimer()
+{}
+
+
+
+void EmuTimer::setRegisters(RegisterSet* registers)
+{
+    regs = registers;
+}
+
+
+
+void EmuTimer::setParentSysPtr(EmuSys* parent_sys)
+{
+    sys = parent_sys;
+}
+
+
+
+/**
+ * @brief Restarts the timer from the values already in its registers, e.g.
+ * the post-boot values, rather than overwriting them. The divider's lower
+ * byte starts at zero.
+ */
+void EmuTimer::reset(void) noexcept
+{
+    uint64_t cycle = getCurrentCycle();
+
+    state = State{};
+    state.dividerOffset = static_cast<uint16_t>(0 - cycle);
+    state.timaCycle = cycle;
+    state.nextOverflowCycle = TIMER_NO_EVENT;
+
+    if(regs == nullptr) { return; }
+
+    state.dividerOffset = static_cast<uint16_t>(
+        (regs->mem.io.div << 8) - cycle
+    );
+    state.timaValue = regs->mem.io.tima;
+    regs->mem.io.tac |= TAC_UNUSED;
+
+    schedule();
+}
+
+
+
+/**
+ * @brief Reads a timer register as of the current cycle.
+ * @param address $FF04-$FF07
+ * @returns Register value with unused bits set.
+ */
+uint8_t EmuTimer::readRegister(uint16_t address) noexcept
+{
+    if(regs == nullptr) { return 0xFF; }
+
+    uint64_t cycle = getCurrentCycle();
+
+    switch(address)
+    {
+    case 0xFF04:
+    {
+        regs->mem.io.div = static_cast<uint8_t>(getDivider(cycle) >> 8);
+        return regs->mem.io.div;
+    }
+    case 0xFF05:
+    {
+        catchUp(cycle);
+        return regs->mem.io.tima;
+    }
+    case 0xFF06:
+    {
+        return regs->mem.io.tma;
+    }
+    case 0xFF07:
+    {
+        return regs->mem.io.tac | TAC_UNUSED;
+    }
+    default:
+    {
+        return 0xFF;
+    }
+    }
+}
+
+
+
+/**
+ * @brief Writes a timer register and reschedules the next overflow.
+ * @param address $FF04-$FF07
+ * @param value
+ */
+void EmuTimer::writeRegister(uint16_t address, uint8_t value) noexcept
+{
+    if(regs == nullptr) { return; }
+
+    uint64_t cycle = getCurrentCycle();
+    catchUp(cycle);
+
+    // TIMA watches one divider bit through an AND with the enable bit, so
+    // anything that drops that signal from high to low is a tick.
+    bool was_high = isEnabled()
+        && (getDivider(cycle) & (getPeriod() / 2)) != 0;
+
+    switch(address)
+    {
+    case 0xFF04:
+    {
+        // Any write clears the whole internal divider
+        state.dividerOffset = static_cast<uint16_t>(0 - cycle);
+        regs->mem.io.div = 0;
+        if(was_high) { incrementTIMA(cycle); }
+        break;
+    }
+    case 0xFF05:
+    {
+        state.timaValue = value;
+        regs->mem.io.tima = value;
+        break;
+    }
+    case 0xFF06:
+    {
+        regs->mem.io.tma = value;
+        break;
+    }
+    case 0xFF07:
+    {
+        regs->mem.io.tac = value | TAC_UNUSED;
+        bool is_high = isEnabled()
+            && (getDivider(cycle) & (getPeriod() / 2)) != 0;
+        if(was_high && !is_high) { incrementTIMA(cycle); }
+        break;
+    }
+    default:
+    {
+        return;
+    }
+    }
+
+    schedule();
+}
+
+
+
+/**
+ * @brief Returns the cycle of the next TIMA overflow, or TIMER_NO_EVENT.
+ */
+uint64_t EmuTimer::getNextEventCycle(void) const noexcept
+{
+    return state.nextOverflowCycle;
+}
+
+
+
+/**
+ * @brief Handles every overflow up to and including a cycle, reloading TIMA
+ * from TMA and requesting the timer interrupt.
+ * @param cycle
+ */
+void EmuTimer::runEvents(uint64_t cycle) noexcept
+{
+    if(regs == nullptr) { return; }
+    catchUp(cycle);
+}
+
+
+
+uint64_t EmuTimer::getCurrentCycle(void) const noexcept
+{
+    return (sys != nullptr) ? sys->getCycleCount() : state.timaCycle;
+}
+
+
+
+/**
+ * @brief Returns the 16-bit internal divider, of which DIV is the top byte.
+ */
+uint16_t EmuTimer::getDivider(uint64_t cycle) const noexcept
+{
+    return static_cast<uint16_t>(cycle + state.dividerOffset);
+}
+
+
+
+bool EmuTimer::isEnabled(void) const noexcept
+{
+    return (regs->mem.io.tac & TAC_ENABLE) != 0;
+}
+
+
+
+uint64_t EmuTimer::getPeriod(void) const noexcept
+{
+    return TIMA_PERIODS[regs->mem.io.tac & 0b11];
+}
+
+
+
+/**
+ * @brief Returns the number of TIMA ticks in the cycles (from, to].
+ */
+uint64_t EmuTimer::countTicks(uint64_t from, uint64_t to) const noexcept
+{
+    // Ticks land on multiples of the period in divider time. The period
+    // divides 65536, so the divider wrapping doesn't move them.
+    uint64_t period = getPeriod();
+    return ((to + state.dividerOffset) / period)
+        - ((from + state.dividerOffset) / period);
+}
+
+
+
+/**
+ * @brief Brings TIMA up to a cycle, handling any overflows on the way.
+ */
+void EmuTimer::catchUp(uint64_t cycle) noexcept
+{
+    if(cycle < state.timaCycle) { return; }
+
+    while(state.nextOverflowCycle <= cycle)
+    {
+        state.timaValue = regs->mem.io.tma;
+        state.timaCycle = state.nextOverflowCycle;
+        regs->mem.io.iflag |= TIMER_INTERRUPT;
+        schedule();
+    }
+
+    if(isEnabled())
+    {
+        // Fewer than the ticks left to overflow, which was handled above.
+        state.timaValue += static_cast<uint8_t>(
+            countTicks(state.timaCycle, cycle)
+        );
+    }
+
+    state.timaCycle = cycle;
+    regs->mem.io.tima = state.timaValue;
+}
+
+
+
+/**
+ * @brief Ticks TIMA once outside of its schedule, for divider glitches.
+ */
+void EmuTimer::incrementTIMA(uint64_t cycle) noexcept
+{
+    if(state.timaValue == 0xFF)
+    {
+        state.timaValue = regs->mem.io.tma;
+        regs->mem.io.iflag |= TIMER_INTERRUPT;
+    } else
+    {
+        state.timaValue++;
+    }
+
+    state.timaCycle = cycle;
+    regs->mem.io.tima = state.timaValue;
+}
+
+
+
+/**
+ * @brief Works out when TIMA next overflows from its value at timaCycle.
+ */
+void EmuTimer::schedule(void) noexcept
+{
+    if(!isEnabled())
+    {
+        state.nextOverflowCycle = TIMER_NO_EVENT;
+        return;
+    }
+
+    uint64_t period = getPeriod();
+    uint64_t ticks_left = 0x100 - state.timaValue;
+    uint64_t divider_time = state.timaCycle + state.dividerOffset;
+
+    state.nextOverflowCycle =
+        (((divider_time / period) + ticks_left) * period)
+        - state.dividerOffset;
+
+    if(sys != nullptr) { sys->scheduleEvent(state.nextOverflowCycle); }
+}
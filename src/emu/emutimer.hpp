@@ -0,0 +1,96 @@
+/**
+ * @file emu/emutimer.hpp
+ * @brief Implements the system's DIV and TIMA timers
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "emuregisters.hpp"
+
+class EmuSys;
+
+// DIV, TIMA, TMA, TAC, $FF04-$FF07
+constexpr uint16_t TIMER_REG_START = 0xFF04;
+constexpr uint16_t TIMER_REG_END = 0xFF07;
+
+// No event is pending
+constexpr uint64_t TIMER_NO_EVENT = UINT64_MAX;
+
+/**
+ * @brief Emulates the timers analytically. DIV is derived from the system
+ * cycle count when read, and TIMA is only brought up to date when accessed.
+ * The one thing that can't wait, a TIMA overflow, is scheduled as a single
+ * future cycle which the system checks after each instruction.
+ */
+class EmuTimer
+{
+public:
+    EmuTimer(RegisterSet* registers = nullptr, EmuSys* parent_sys = nullptr);
+    ~EmuTimer();
+
+    void setRegisters(RegisterSet* registers);
+    void setParentSysPtr(EmuSys* parent_sys);
+
+    /**
+     * @brief Restarts the timer from the values already in its registers,
+     * e.g. the post-boot values, rather than overwriting them. The
+     * divider's lower byte starts at zero.
+     */
+    void reset(void) noexcept;
+
+    /**
+     * @brief Reads a timer register as of the current cycle.
+     * @param address $FF04-$FF07
+     * @returns Register value with unused bits set.
+     */
+    uint8_t readRegister(uint16_t address) noexcept;
+
+    /**
+     * @brief Writes a timer register and reschedules the next overflow.
+     * @param address $FF04-$FF07
+     * @param value
+     */
+    void writeRegister(uint16_t address, uint8_t value) noexcept;
+
+    /**
+     * @brief Returns the cycle of the next TIMA overflow, or TIMER_NO_EVENT.
+     */
+    uint64_t getNextEventCycle(void) const noexcept;
+
+    /**
+     * @brief Handles every overflow up to and including a cycle, reloading
+     * TIMA from TMA and requesting the timer interrupt.
+     * @param cycle
+     */
+    void runEvents(uint64_t cycle) noexcept;
+
+    // Everything needed to resume emulation exactly.
+    struct State
+    {
+        // Added to the cycle count to get the 16-bit internal divider
+        uint16_t dividerOffset;
+        // TIMA was timaValue as of timaCycle
+        uint8_t timaValue;
+        uint64_t timaCycle;
+        uint64_t nextOverflowCycle;
+    };
+
+    State state{};
+
+private:
+    RegisterSet* regs;
+    EmuSys* sys;
+
+    uint64_t getCurrentCycle(void) const noexcept;
+    uint16_t getDivider(uint64_t cycle) const noexcept;
+    bool isEnabled(void) const noexcept;
+    uint64_t getPeriod(void) const noexcept;
+    uint64_t countTicks(uint64_t from, uint64_t to) const noexcept;
+
+    void catchUp(uint64_t cycle) noexcept;
+    void incrementTIMA(uint64_t cycle) noexcept;
+    void schedule(void) noexcept;
+};
@@ -0,0 +1,244 @@
+/**
+ * @file emu/lzcodec.cpp
+ * @brief A small, fast LZ77 codec for snapshot deltas
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "lzcodec.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+constexpr size_t LZ_MIN_MATCH = 4;
+constexpr size_t LZ_MAX_OFFSET = 0xFFFF;
+// The last bytes are always literals, as in LZ4.
+constexpr size_t LZ_END_LITERALS = 5;
+constexpr int LZ_HASH_BITS = 12;
+// Lengths of 15 or more continue in extra bytes.
+constexpr size_t LZ_LENGTH_EXTENDED = 15;
+
+static inline uint32_t read32(const uint8_t* data) noexcept
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static inline uint64_t read64(const uint8_t* data) noexcept
+{
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static inline uint32_t hashSequence(uint32_t sequence) noexcept
+{
+    return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static void writeLength(std::vector<uint8_t>& dest, size_t length)
+{
+    while(length >= 255)
+    {
+        dest.push_back(255);
+        length -= 255;
+    }
+    dest.push_back(static_cast<uint8_t>(length));
+}
+
+static void writeSequence(
+    std::vector<uint8_t>& dest,
+    const uint8_t* literals,
+    size_t literal_count,
+    size_t match_length,
+    size_t offset
+)
+{
+    size_t match_code = (match_length != 0) ? match_length - LZ_MIN_MATCH : 0;
+
+    dest.push_back(static_cast<uint8_t>(
+        (std::min(literal_count, LZ_LENGTH_EXTENDED) << 4)
+        | std::min(match_code, LZ_LENGTH_EXTENDED)
+    ));
+
+    if(literal_count >= LZ_LENGTH_EXTENDED)
+    {
+        writeLength(dest, literal_count - LZ_LENGTH_EXTENDED);
+    }
+    dest.insert(dest.end(), literals, literals + literal_count);
+
+    // The last sequence is literals only.
+    if(match_length == 0) { return; }
+
+    dest.push_back(static_cast<uint8_t>(offset));
+    dest.push_back(static_cast<uint8_t>(offset >> 8));
+
+    if(match_code >= LZ_LENGTH_EXTENDED)
+    {
+        writeLength(dest, match_code - LZ_LENGTH_EXTENDED);
+    }
+}
+
+
+
+/**
+ * @brief Compresses a block of bytes.
+ * @param source
+ * @param size
+ * @param dest Replaced with the compressed bytes, keeping its memory.
+ */
+void lzCompress(
+    const uint8_t* source,
+    size_t size,
+    std::vector<uint8_t>& dest
+)
+{
+    dest.clear();
+
+    // Last position seen for each hash of four bytes
+    std::array<uint32_t, 1 << LZ_HASH_BITS> table{};
+
+    size_t pos = 0;
+    size_t anchor = 0;
+
+    if(size > LZ_END_LITERALS + LZ_MIN_MATCH)
+    {
+        size_t last_match_start = size - LZ_END_LITERALS - LZ_MIN_MATCH;
+        size_t match_limit = size - LZ_END_LITERALS;
+
+        while(pos <= last_match_start)
+        {
+            uint32_t sequence = read32(source + pos);
+            uint32_t hash = hashSequence(sequence);
+            size_t candidate = table[hash];
+            table[hash] = static_cast<uint32_t>(pos);
+
+            if(candidate >= pos || pos - candidate > LZ_MAX_OFFSET
+               || read32(source + candidate) != sequence)
+            {
+                // Step faster through data that isn't matching.
+                pos += 1 + ((pos - anchor) >> 6);
+                continue;
+            }
+
+            size_t length = LZ_MIN_MATCH;
+            while(pos + length + 8 <= match_limit
+                  && read64(source + candidate + length)
+                      == read64(source + pos + length))
+            {
+                length += 8;
+            }
+            while(pos + length < match_limit
+                  && source[candidate + length] == source[pos + length])
+            {
+                length++;
+            }
+
+            writeSequence(
+                dest, source + anchor, pos - anchor, length, pos - candidate
+            );
+            pos += length;
+            anchor = pos;
+        }
+    }
+
+    writeSequence(dest, source + anchor, size - anchor, 0, 0);
+}
+
+
+
+/**
+ * @brief Decompresses a block made by lzCompress.
+ * @param source
+ * @param size
+ * @param dest
+ * @param dest_size Exact decompressed size.
+ * @throws std::runtime_error if the block is corrupt or the wrong size.
+ */
+void lzDecompress(
+    const uint8_t* source,
+    size_t size,
+    uint8_t* dest,
+    size_t dest_size
+)
+{
+    size_t in = 0;
+    size_t out = 0;
+
+    auto read_length = [&](size_t length)
+    {
+        uint8_t extra;
+        do
+        {
+            if(in >= size)
+            {
+                throw std::runtime_error("Compressed data is truncated!");
+            }
+            extra = source[in++];
+            length += extra;
+        } while(extra == 255);
+        return length;
+    };
+
+    while(in < size)
+    {
+        uint8_t token = source[in++];
+
+        size_t literal_count = token >> 4;
+        if(literal_count == LZ_LENGTH_EXTENDED)
+        {
+            literal_count = read_length(literal_count);
+        }
+
+        if(literal_count > size - in || literal_count > dest_size - out)
+        {
+            throw std::runtime_error("Compressed data is corrupt!");
+        }
+
+        std::memcpy(dest + out, source + in, literal_count);
+        in += literal_count;
+        out += literal_count;
+
+        if(in == size) { break; }
+
+        if(size - in < 2)
+        {
+            throw std::runtime_error("Compressed data is truncated!");
+        }
+
+        size_t offset = source[in] | (source[in + 1] << 8);
+        in += 2;
+
+        size_t length = token & 0x0F;
+        if(length == LZ_LENGTH_EXTENDED) { length = read_length(length); }
+        length += LZ_MIN_MATCH;
+
+        if(offset == 0 || offset > out || length > dest_size - out)
+        {
+            throw std::runtime_error("Compressed data is corrupt!");
+        }
+
+        // Matches may overlap what they're copying, e.g. a run of zeros,
+        // which repeats every offset bytes. Each copy doubles how much of
+        // the repeat is available to copy from.
+        uint8_t* target = dest + out;
+        const uint8_t* match = target - offset;
+        size_t copied = 0;
+        while(copied < length)
+        {
+            size_t chunk = std::min(length - copied, copied + offset);
+            std::memcpy(target + copied, match, chunk);
+            copied += chunk;
+        }
+        out += length;
+    }
+
+    if(out != dest_size)
+    {
+        throw std::runtime_error(
+            "Compressed data is a different size than expected!"
+        );
+    }
+}
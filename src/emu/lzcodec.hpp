@@ -0,0 +1,44 @@
+/**
+ * @file emu/lzcodec.hpp
+ * @brief A small, fast LZ77 codec for snapshot deltas
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Compresses a block of bytes.
+ *
+ * The format follows LZ4's block format: sequences of a token (literal and
+ * match length nibbles), extra length bytes, literals, and a 16-bit match
+ * offset. It favors speed over ratio, and does best on long runs, like the
+ * zeros in an XOR of two similar snapshots.
+ * @param source
+ * @param size
+ * @param dest Replaced with the compressed bytes, keeping its memory.
+ */
+void lzCompress(
+    const uint8_t* source,
+    size_t size,
+    std::vector<uint8_t>& dest
+);
+
+/**
+ * @brief Decompresses a block made by lzCompress.
+ * @param source
+ * @param size
+ * @param dest
+ * @param dest_size Exact decompressed size.
+ * @throws std::runtime_error if the block is corrupt or the wrong size.
+ */
+void lzDecompress(
+    const uint8_t* source,
+    size_t size,
+    uint8_t* dest,
+    size_t dest_size
+);
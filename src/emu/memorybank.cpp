@@ -7,6 +7,7 @@
 
 #include "memorybank.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 #include <assert.h>
 
@@ -34,9 +35,8 @@ MemoryBank::MemoryBank(
         );
     }
 
-    data.reserve(end_address - start_address + 1);
-    data.resize(end_address - start_address + 1);
-    std::fill(data.begin(), data.end(), 0);
+    data = std::make_shared<SharedData>();
+    data->bytes.assign(end_address - start_address + 1, 0);
 
     startAddress = start_address;
     endAddress = end_address;
@@ -47,8 +47,44 @@ MemoryBank::MemoryBank(
 
 
 
+/**
+ * @brief Shares other's bytes until either bank is written to.
+ */
+MemoryBank::MemoryBank(const MemoryBank& other) :
+    data(other.data),
+    readLocked(other.readLocked),
+    writeLocked(other.writeLocked),
+    startAddress(other.startAddress),
+    endAddress(other.endAddress)
+{
+    if(data != nullptr)
+    {
+        data->owners.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+MemoryBank& MemoryBank::operator=(const MemoryBank& other)
+{
+    if(this == &other) { return *this; }
+
+    if(other.data != nullptr)
+    {
+        other.data->owners.fetch_add(1, std::memory_order_relaxed);
+    }
+    releaseData();
+
+    data = other.data;
+    readLocked = other.readLocked;
+    writeLocked = other.writeLocked;
+    startAddress = other.startAddress;
+    endAddress = other.endAddress;
+    return *this;
+}
+
 MemoryBank::~MemoryBank()
-{}
+{
+    releaseData();
+}
 
 
 
@@ -68,9 +104,9 @@ uint8_t MemoryBank::readByte(size_t address) const
         );
     }
 
-    assert(data.size() == (endAddress - startAddress + 1));
+    assert(data->bytes.size() == (endAddress - startAddress + 1));
 
-    return data.at(address - startAddress);
+    return data->bytes.at(address - startAddress);
 }
 
 
@@ -91,9 +127,10 @@ void MemoryBank::writeByte(size_t address, uint8_t value)
         );
     }
 
-    assert(data.size() == (endAddress - startAddress + 1));
+    assert(data->bytes.size() == (endAddress - startAddress + 1));
 
-    data.at(address - startAddress) = value;
+    makeUnique();
+    data->bytes.at(address - startAddress) = value;
 }
 
 
@@ -140,6 +177,33 @@ size_t MemoryBank::getEndAddress(void) const noexcept
 
 
 
+/**
+ * @brief Returns a pointer to the start of the bank's data. The mutable
+ * pointer is only valid until the bank is next copied.
+ */
+const uint8_t* MemoryBank::getDataPtr(void) const noexcept
+{
+    return data->bytes.data();
+}
+
+uint8_t* MemoryBank::getDataPtr(void)
+{
+    makeUnique();
+    return data->bytes.data();
+}
+
+
+
+/**
+ * @brief Returns the number of bytes in the bank.
+ */
+size_t MemoryBank::getSize(void) const noexcept
+{
+    return data->bytes.size();
+}
+
+
+
 /**
  * @brief Copies an existing vector of data. Must be <= bank size.
  * @param data
@@ -147,5 +211,38 @@ size_t MemoryBank::getEndAddress(void) const noexcept
  */
 void MemoryBank::loadData(std::vector<uint8_t>& new_data)
 {
-    std::copy(new_data.begin(), new_data.end(), data.begin());
+    makeUnique();
+    std::copy(new_data.begin(), new_data.end(), data->bytes.begin());
+}
+
+
+
+/**
+ * @brief Gives this bank its own copy of its bytes before a write, if it
+ * shares them with a copy. The acquire pairs with the release in
+ * releaseData(), so writing in place can't race a copy on another thread
+ * that was still reading. Two copies that write at once may both copy,
+ * which only costs the spare copy.
+ */
+void MemoryBank::makeUnique(void)
+{
+    if(data->owners.load(std::memory_order_acquire) == 1) { return; }
+
+    std::shared_ptr<SharedData> copy = std::make_shared<SharedData>();
+    copy->bytes = data->bytes;
+    releaseData();
+    data = std::move(copy);
+}
+
+
+
+/**
+ * @brief Stops sharing this bank's bytes. Releases, so the next bank to
+ * find itself the only owner sees this one's reads finished.
+ */
+void MemoryBank::releaseData(void) noexcept
+{
+    if(data == nullptr) { return; }
+    data->owners.fetch_sub(1, std::memory_order_release);
+    data.reset();
 }
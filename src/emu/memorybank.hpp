@@ -8,8 +8,16 @@
 #pragma once
 
 #include <vector>
+#include <atomic>
+#include <memory>
+#include <cstddef>
 #include <cstdint>
 
+/**
+ * @brief A range of emulated memory. Copies share their bytes until either
+ * is written to, so copying a bank costs nothing until it diverges. Copies
+ * may be used on different threads.
+ */
 class MemoryBank
 {
 public:
@@ -29,6 +37,8 @@ public:
         bool write_locked = false
     );
 
+    MemoryBank(const MemoryBank& other);
+    MemoryBank& operator=(const MemoryBank& other);
     ~MemoryBank();
 
     /**
@@ -59,6 +69,18 @@ public:
     size_t getStartAddress(void) const noexcept;
     size_t getEndAddress(void) const noexcept;
 
+    /**
+     * @brief Returns a pointer to the start of the bank's data. The mutable
+     * pointer is only valid until the bank is next copied.
+     */
+    const uint8_t* getDataPtr(void) const noexcept;
+    uint8_t* getDataPtr(void);
+
+    /**
+     * @brief Returns the number of bytes in the bank.
+     */
+    size_t getSize(void) const noexcept;
+
     /**
      * @brief Copies an existing vector of data. Must be <= bank size.
      * @param data 
@@ -67,9 +89,21 @@ public:
     void loadData(std::vector<uint8_t>& new_data);
 
 private:
-    std::vector<uint8_t> data;
+    // Bytes shared with copies until one of them writes. Owners are
+    // counted with release/acquire ordering, so a bank that finds itself
+    // the only owner also sees every other owner's last use of the bytes.
+    struct SharedData
+    {
+        std::vector<uint8_t> bytes;
+        std::atomic<unsigned int> owners{ 1 };
+    };
+
+    std::shared_ptr<SharedData> data;
     bool readLocked;
     bool writeLocked;
     size_t startAddress;
     size_t endAddress;
+
+    void makeUnique(void);
+    void releaseData(void) noexcept;
 };
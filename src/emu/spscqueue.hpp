@@ -0,0 +1,146 @@
+/**
+ * @file emu/spscqueue.hpp
+ * @brief Lock-free single-producer/single-consumer ring buffer
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Keeps the producer and consumer indices on separate cache lines.
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief Bounded ring buffer safe for exactly one producer thread and one
+ * consumer thread. Capacity is rounded up to a power of two.
+ */
+template<typename T>
+class SPSCQueue
+{
+public:
+    explicit SPSCQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while(size < capacity) { size <<= 1; }
+
+        buffer.resize(size);
+        mask = size - 1;
+    }
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    /**
+     * @brief Pushes an item. Producer only.
+     * @returns false if the queue is full.
+     */
+    bool tryPush(const T& item) noexcept
+    {
+        size_t head = writeIndex.load(std::memory_order_relaxed);
+        if(head - cachedReadIndex > mask)
+        {
+            cachedReadIndex = readIndex.load(std::memory_order_acquire);
+            if(head - cachedReadIndex > mask) { return false; }
+        }
+
+        buffer[head & mask] = item;
+        writeIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pushes up to count items. Producer only.
+     * @returns Number of items pushed.
+     */
+    size_t pushBulk(const T* items, size_t count) noexcept
+    {
+        size_t head = writeIndex.load(std::memory_order_relaxed);
+        size_t free = capacity() - (head - cachedReadIndex);
+        if(free < count)
+        {
+            cachedReadIndex = readIndex.load(std::memory_order_acquire);
+            free = capacity() - (head - cachedReadIndex);
+        }
+
+        if(count > free) { count = free; }
+        for(size_t i = 0; i < count; i++)
+        {
+            buffer[(head + i) & mask] = items[i];
+        }
+
+        writeIndex.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Pops an item. Consumer only.
+     * @returns false if the queue is empty.
+     */
+    bool tryPop(T& item) noexcept
+    {
+        size_t tail = readIndex.load(std::memory_order_relaxed);
+        if(tail == cachedWriteIndex)
+        {
+            cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+            if(tail == cachedWriteIndex) { return false; }
+        }
+
+        item = buffer[tail & mask];
+        readIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pops up to count items. Consumer only.
+     * @returns Number of items popped.
+     */
+    size_t popBulk(T* items, size_t count) noexcept
+    {
+        size_t tail = readIndex.load(std::memory_order_relaxed);
+        size_t available = cachedWriteIndex - tail;
+        if(available < count)
+        {
+            cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+            available = cachedWriteIndex - tail;
+        }
+
+        if(count > available) { count = available; }
+        for(size_t i = 0; i < count; i++)
+        {
+            items[i] = buffer[(tail + i) & mask];
+        }
+
+        readIndex.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Returns the approximate number of queued items. Either thread.
+     */
+    size_t size(void) const noexcept
+    {
+        return writeIndex.load(std::memory_order_acquire)
+            - readIndex.load(std::memory_order_acquire);
+    }
+
+    size_t capacity(void) const noexcept
+    {
+        return mask + 1;
+    }
+
+private:
+    std::vector<T> buffer;
+    size_t mask;
+
+    // Producer-owned
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> writeIndex{ 0 };
+    size_t cachedReadIndex = 0;
+
+    // Consumer-owned
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> readIndex{ 0 };
+    size_t cachedWriteIndex = 0;
+};
@@ -0,0 +1,518 @@
+/**
+ * @file filters.cpp
+ * @brief Pixel-art upscaling filters for ARGB8888 frames
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "filters.hpp"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMGBE_FILTERS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+constexpr uint32_t ALPHA_MASK = 0xFF000000;
+
+inline uint32_t* rowAt(uint32_t* dest, int pitch, int row) noexcept
+{
+    return reinterpret_cast<uint32_t*>(
+        reinterpret_cast<uint8_t*>(dest) + (row * pitch)
+    );
+}
+
+inline uint32_t average(uint32_t a, uint32_t b) noexcept
+{
+    // Per-channel rounding average, matching _mm_avg_epu8
+    return ((a | b) & 0x01010101) + ((a >> 1) & 0x7F7F7F7F)
+        + ((b >> 1) & 0x7F7F7F7F);
+}
+
+// Neighbourhood of one pixel, edges clamped.
+//  A B C
+//  D E F
+//  G H I
+struct Neighbours
+{
+    uint32_t a, b, c, d, e, f, g, h, i;
+};
+
+inline Neighbours gather(
+    const uint32_t* up,
+    const uint32_t* row,
+    const uint32_t* down,
+    int x,
+    int width
+) noexcept
+{
+    int left = std::max(x - 1, 0);
+    int right = std::min(x + 1, width - 1);
+    return {
+        up[left], up[x], up[right],
+        row[left], row[x], row[right],
+        down[left], down[x], down[right],
+    };
+}
+
+
+
+//
+// Scalar kernels, used for edges and non-SSE2 builds
+//
+
+inline void scale2xPixel(
+    const Neighbours& n,
+    uint32_t* out0,
+    uint32_t* out1,
+    bool blend
+) noexcept
+{
+    uint32_t e0 = n.e, e1 = n.e, e2 = n.e, e3 = n.e;
+
+    if(n.b != n.h && n.d != n.f)
+    {
+        if(n.d == n.b) { e0 = blend ? average(n.d, n.e) : n.d; }
+        if(n.b == n.f) { e1 = blend ? average(n.f, n.e) : n.f; }
+        if(n.d == n.h) { e2 = blend ? average(n.d, n.e) : n.d; }
+        if(n.h == n.f) { e3 = blend ? average(n.f, n.e) : n.f; }
+    }
+
+    out0[0] = e0; out0[1] = e1;
+    out1[0] = e2; out1[1] = e3;
+}
+
+
+
+inline void scale3xPixel(
+    const Neighbours& n,
+    uint32_t* out0,
+    uint32_t* out1,
+    uint32_t* out2
+) noexcept
+{
+    uint32_t e[9] = { n.e, n.e, n.e, n.e, n.e, n.e, n.e, n.e, n.e };
+
+    if(n.b != n.h && n.d != n.f)
+    {
+        if(n.d == n.b) { e[0] = n.d; }
+        if((n.d == n.b && n.e != n.c) || (n.b == n.f && n.e != n.a))
+        {
+            e[1] = n.b;
+        }
+        if(n.b == n.f) { e[2] = n.f; }
+        if((n.d == n.b && n.e != n.g) || (n.d == n.h && n.e != n.a))
+        {
+            e[3] = n.d;
+        }
+        if((n.b == n.f && n.e != n.i) || (n.h == n.f && n.e != n.c))
+        {
+            e[5] = n.f;
+        }
+        if(n.d == n.h) { e[6] = n.d; }
+        if((n.d == n.h && n.e != n.i) || (n.h == n.f && n.e != n.g))
+        {
+            e[7] = n.h;
+        }
+        if(n.h == n.f) { e[8] = n.f; }
+    }
+
+    std::copy(e, e + 3, out0);
+    std::copy(e + 3, e + 6, out1);
+    std::copy(e + 6, e + 9, out2);
+}
+
+
+
+inline void lcdPixel(
+    uint32_t color,
+    uint32_t* out0,
+    uint32_t* out1,
+    uint32_t* out2
+) noexcept
+{
+    // Right column and bottom row are the gaps between LCD cells.
+    uint32_t gap = average(color, average(color, 0)) | ALPHA_MASK;
+    out0[0] = color; out0[1] = color; out0[2] = gap;
+    out1[0] = color; out1[1] = color; out1[2] = gap;
+    out2[0] = gap; out2[1] = gap; out2[2] = gap;
+}
+
+
+
+#ifdef IMGBE_FILTERS_SSE2
+
+inline __m128i load(const uint32_t* p) noexcept
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline void store(uint32_t* p, __m128i v) noexcept
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+inline __m128i select(__m128i mask, __m128i a, __m128i b) noexcept
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+inline __m128i notEqual(__m128i a, __m128i b) noexcept
+{
+    return _mm_xor_si128(_mm_cmpeq_epi32(a, b), _mm_set1_epi32(-1));
+}
+
+// Four pixels starting at x. Requires 1 <= x and x + 4 < width.
+inline void scale2xVector(
+    const uint32_t* up,
+    const uint32_t* row,
+    const uint32_t* down,
+    int x,
+    uint32_t* out0,
+    uint32_t* out1,
+    bool blend
+) noexcept
+{
+    __m128i b = load(up + x);
+    __m128i d = load(row + x - 1);
+    __m128i e = load(row + x);
+    __m128i f = load(row + x + 1);
+    __m128i h = load(down + x);
+
+    __m128i edge = _mm_and_si128(notEqual(b, h), notEqual(d, f));
+
+    __m128i from_d = blend ? _mm_avg_epu8(d, e) : d;
+    __m128i from_f = blend ? _mm_avg_epu8(f, e) : f;
+
+    __m128i e0 = select(_mm_and_si128(edge, _mm_cmpeq_epi32(d, b)), from_d, e);
+    __m128i e1 = select(_mm_and_si128(edge, _mm_cmpeq_epi32(b, f)), from_f, e);
+    __m128i e2 = select(_mm_and_si128(edge, _mm_cmpeq_epi32(d, h)), from_d, e);
+    __m128i e3 = select(_mm_and_si128(edge, _mm_cmpeq_epi32(h, f)), from_f, e);
+
+    store(out0, _mm_unpacklo_epi32(e0, e1));
+    store(out0 + 4, _mm_unpackhi_epi32(e0, e1));
+    store(out1, _mm_unpacklo_epi32(e2, e3));
+    store(out1 + 4, _mm_unpackhi_epi32(e2, e3));
+}
+
+
+
+// Four pixels starting at x. Requires 1 <= x and x + 4 < width.
+inline void scale3xVector(
+    const uint32_t* up,
+    const uint32_t* row,
+    const uint32_t* down,
+    int x,
+    uint32_t* out0,
+    uint32_t* out1,
+    uint32_t* out2
+) noexcept
+{
+    __m128i a = load(up + x - 1);
+    __m128i b = load(up + x);
+    __m128i c = load(up + x + 1);
+    __m128i d = load(row + x - 1);
+    __m128i e = load(row + x);
+    __m128i f = load(row + x + 1);
+    __m128i g = load(down + x - 1);
+    __m128i h = load(down + x);
+    __m128i i = load(down + x + 1);
+
+    __m128i edge = _mm_and_si128(notEqual(b, h), notEqual(d, f));
+    __m128i db = _mm_and_si128(edge, _mm_cmpeq_epi32(d, b));
+    __m128i bf = _mm_and_si128(edge, _mm_cmpeq_epi32(b, f));
+    __m128i dh = _mm_and_si128(edge, _mm_cmpeq_epi32(d, h));
+    __m128i hf = _mm_and_si128(edge, _mm_cmpeq_epi32(h, f));
+
+    alignas(16) uint32_t e_out[9][4];
+    store(e_out[0], select(db, d, e));
+    store(e_out[1], select(_mm_or_si128(
+        _mm_and_si128(db, notEqual(e, c)),
+        _mm_and_si128(bf, notEqual(e, a))), b, e));
+    store(e_out[2], select(bf, f, e));
+    store(e_out[3], select(_mm_or_si128(
+        _mm_and_si128(db, notEqual(e, g)),
+        _mm_and_si128(dh, notEqual(e, a))), d, e));
+    store(e_out[4], e);
+    store(e_out[5], select(_mm_or_si128(
+        _mm_and_si128(bf, notEqual(e, i)),
+        _mm_and_si128(hf, notEqual(e, c))), f, e));
+    store(e_out[6], select(dh, d, e));
+    store(e_out[7], select(_mm_or_si128(
+        _mm_and_si128(dh, notEqual(e, i)),
+        _mm_and_si128(hf, notEqual(e, g))), h, e));
+    store(e_out[8], select(hf, f, e));
+
+    // SSE2 has no cheap 3-way interleave, so scatter from the stack.
+    for(int p = 0; p < 4; p++)
+    {
+        for(int k = 0; k < 3; k++)
+        {
+            out0[(p * 3) + k] = e_out[k][p];
+            out1[(p * 3) + k] = e_out[3 + k][p];
+            out2[(p * 3) + k] = e_out[6 + k][p];
+        }
+    }
+}
+
+#endif // IMGBE_FILTERS_SSE2
+
+
+
+void scale2xFrame(
+    const uint32_t* source,
+    int width,
+    int height,
+    uint32_t* dest,
+    int dest_pitch,
+    bool blend
+) noexcept
+{
+    for(int y = 0; y < height; y++)
+    {
+        const uint32_t* up = source + (std::max(y - 1, 0) * width);
+        const uint32_t* row = source + (y * width);
+        const uint32_t* down = source + (std::min(y + 1, height - 1) * width);
+        uint32_t* out0 = rowAt(dest, dest_pitch, y * 2);
+        uint32_t* out1 = rowAt(dest, dest_pitch, (y * 2) + 1);
+
+        int x = 0;
+        scale2xPixel(gather(up, row, down, x, width), out0, out1, blend);
+        x++;
+
+        #ifdef IMGBE_FILTERS_SSE2
+        for(; x + 4 < width; x += 4)
+        {
+            scale2xVector(up, row, down, x, out0 + (x * 2), out1 + (x * 2),
+                          blend);
+        }
+        #endif
+
+        for(; x < width; x++)
+        {
+            scale2xPixel(gather(up, row, down, x, width),
+                         out0 + (x * 2), out1 + (x * 2), blend);
+        }
+    }
+}
+
+
+
+void scale3xFrame(
+    const uint32_t* source,
+    int width,
+    int height,
+    uint32_t* dest,
+    int dest_pitch
+) noexcept
+{
+    for(int y = 0; y < height; y++)
+    {
+        const uint32_t* up = source + (std::max(y - 1, 0) * width);
+        const uint32_t* row = source + (y * width);
+        const uint32_t* down = source + (std::min(y + 1, height - 1) * width);
+        uint32_t* out0 = rowAt(dest, dest_pitch, y * 3);
+        uint32_t* out1 = rowAt(dest, dest_pitch, (y * 3) + 1);
+        uint32_t* out2 = rowAt(dest, dest_pitch, (y * 3) + 2);
+
+        int x = 0;
+        scale3xPixel(gather(up, row, down, x, width), out0, out1, out2);
+        x++;
+
+        #ifdef IMGBE_FILTERS_SSE2
+        for(; x + 4 < width; x += 4)
+        {
+            scale3xVector(up, row, down, x,
+                          out0 + (x * 3), out1 + (x * 3), out2 + (x * 3));
+        }
+        #endif
+
+        for(; x < width; x++)
+        {
+            scale3xPixel(gather(up, row, down, x, width),
+                         out0 + (x * 3), out1 + (x * 3), out2 + (x * 3));
+        }
+    }
+}
+
+
+
+void lcdGridFrame(
+    const uint32_t* source,
+    int width,
+    int height,
+    uint32_t* dest,
+    int dest_pitch,
+    uint32_t* history
+) noexcept
+{
+    int pixel_count = width * height;
+    int i = 0;
+
+    // Ghosting: history = 3/4 current + 1/4 previous, like a slow LCD.
+    #ifdef IMGBE_FILTERS_SSE2
+    for(; i + 4 <= pixel_count; i += 4)
+    {
+        __m128i current = load(source + i);
+        __m128i previous = load(history + i);
+        store(history + i,
+              _mm_avg_epu8(current, _mm_avg_epu8(current, previous)));
+    }
+    #endif
+    for(; i < pixel_count; i++)
+    {
+        history[i] = average(source[i], average(source[i], history[i]));
+    }
+
+    for(int y = 0; y < height; y++)
+    {
+        const uint32_t* row = history + (y * width);
+        uint32_t* out0 = rowAt(dest, dest_pitch, y * 3);
+        uint32_t* out1 = rowAt(dest, dest_pitch, (y * 3) + 1);
+        uint32_t* out2 = rowAt(dest, dest_pitch, (y * 3) + 2);
+
+        int x = 0;
+
+        #ifdef IMGBE_FILTERS_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(ALPHA_MASK));
+        for(; x + 4 <= width; x += 4)
+        {
+            __m128i color = load(row + x);
+            __m128i gap = _mm_or_si128(
+                _mm_avg_epu8(color, _mm_avg_epu8(color, zero)), alpha
+            );
+
+            alignas(16) uint32_t colors[4];
+            alignas(16) uint32_t gaps[4];
+            store(colors, color);
+            store(gaps, gap);
+
+            for(int p = 0; p < 4; p++)
+            {
+                uint32_t* cell0 = out0 + ((x + p) * 3);
+                uint32_t* cell1 = out1 + ((x + p) * 3);
+                cell0[0] = colors[p]; cell0[1] = colors[p]; cell0[2] = gaps[p];
+                cell1[0] = colors[p]; cell1[1] = colors[p]; cell1[2] = gaps[p];
+            }
+
+            // The bottom gap row is the same gap color three times over.
+            __m128i g0 = _mm_shuffle_epi32(gap, _MM_SHUFFLE(1, 0, 0, 0));
+            __m128i g1 = _mm_shuffle_epi32(gap, _MM_SHUFFLE(2, 2, 1, 1));
+            __m128i g2 = _mm_shuffle_epi32(gap, _MM_SHUFFLE(3, 3, 3, 2));
+            store(out2 + (x * 3), g0);
+            store(out2 + (x * 3) + 4, g1);
+            store(out2 + (x * 3) + 8, g2);
+        }
+        #endif
+
+        for(; x < width; x++)
+        {
+            lcdPixel(row[x], out0 + (x * 3), out1 + (x * 3), out2 + (x * 3));
+        }
+    }
+}
+
+} // namespace
+
+
+
+/**
+ * @brief Returns the integer scale factor a filter outputs at.
+ * @param type
+ */
+int getFilterScale(FilterType type) noexcept
+{
+    switch(type)
+    {
+    case FILTER_SCALE2X: return 2;
+    case FILTER_SCALE3X: return 3;
+    case FILTER_XBR_LITE: return 2;
+    case FILTER_LCD_GRID: return 3;
+    default: return 1;
+    }
+}
+
+
+
+/**
+ * @brief Returns a human-readable filter name.
+ * @param type
+ */
+std::string getFilterName(FilterType type) noexcept
+{
+    switch(type)
+    {
+    case FILTER_SCALE2X: return "Scale2x";
+    case FILTER_SCALE3X: return "Scale3x";
+    case FILTER_XBR_LITE: return "xBR-lite";
+    case FILTER_LCD_GRID: return "LCD Grid";
+    default: return "None";
+    }
+}
+
+
+
+/**
+ * @brief Runs a filter over a frame.
+ * @param type
+ * @param source width * height ARGB8888 pixels
+ * @param width
+ * @param height
+ * @param dest Destination with room for (width * scale) * (height * scale)
+ * @param dest_pitch Bytes between destination rows
+ * @param history width * height pixels carried between frames (LCD ghosting).
+ * May be nullptr for other filters.
+ */
+void applyFilter(
+    FilterType type,
+    const uint32_t* source,
+    int width,
+    int height,
+    uint32_t* dest,
+    int dest_pitch,
+    uint32_t* history
+) noexcept
+{
+    switch(type)
+    {
+    case FILTER_SCALE2X:
+    {
+        scale2xFrame(source, width, height, dest, dest_pitch, false);
+        break;
+    }
+
+    case FILTER_SCALE3X:
+    {
+        scale3xFrame(source, width, height, dest, dest_pitch);
+        break;
+    }
+
+    case FILTER_XBR_LITE:
+    {
+        scale2xFrame(source, width, height, dest, dest_pitch, true);
+        break;
+    }
+
+    case FILTER_LCD_GRID:
+    {
+        if(history == nullptr) { break; }
+        lcdGridFrame(source, width, height, dest, dest_pitch, history);
+        break;
+    }
+
+    default:
+    {
+        for(int y = 0; y < height; y++)
+        {
+            std::copy(source + (y * width), source + ((y + 1) * width),
+                      rowAt(dest, dest_pitch, y));
+        }
+        break;
+    }
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * @file filters.hpp
+ * @brief Pixel-art upscaling filters for ARGB8888 frames
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+enum FilterType
+{
+    FILTER_NONE,
+    FILTER_SCALE2X,
+    FILTER_SCALE3X,
+    FILTER_XBR_LITE, // Scale2x edge rules with blended corners
+    FILTER_LCD_GRID, // 3x with darkened pixel gaps and ghosting
+
+    FILTER_COUNT,
+};
+
+/**
+ * @brief Returns the integer scale factor a filter outputs at.
+ * @param type
+ */
+int getFilterScale(FilterType type) noexcept;
+
+/**
+ * @brief Returns a human-readable filter name.
+ * @param type
+ */
+std::string getFilterName(FilterType type) noexcept;
+
+/**
+ * @brief Runs a filter over a frame.
+ * @param type
+ * @param source width * height ARGB8888 pixels
+ * @param width
+ * @param height
+ * @param dest Destination with room for (width * scale) * (height * scale)
+ * @param dest_pitch Bytes between destination rows
+ * @param history width * height pixels carried between frames (LCD ghosting).
+ * May be nullptr for other filters.
+ */
+void applyFilter(
+    FilterType type,
+    const uint32_t* source,
+    int width,
+    int height,
+    uint32_t* dest,
+    int dest_pitch,
+    uint32_t* history
+) noexcept;
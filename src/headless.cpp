@@ -0,0 +1,306 @@
+/**
+ * @file headless.cpp
+ * @brief Runs the emulator without a window, renderer, or event loop
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "headless.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <fmt/core.h>
+#include "audiofile.hpp"
+#include "logger.hpp"
+#include "emu/emusys.hpp"
+#include "emu/emulink.hpp"
+#include "linksocket.hpp"
+
+/**
+ * @brief Runs a ROM as fast as possible until a limit is hit or it stops.
+ * @param options
+ * @param result Filled in with what the run did. May be nullptr.
+ * @returns Process exit status. 0 on success.
+ */
+int runHeadless(
+    const HeadlessOptions& options,
+    HeadlessResult* result
+) noexcept
+{
+    HeadlessResult unused;
+    if(result == nullptr) { result = &unused; }
+
+    if(options.romPath.empty())
+    {
+        result->error = "Headless mode requires a ROM (-f=path).";
+        logMessage(result->error, LOG_ERRORS);
+        return 1;
+    }
+
+    if(!options.audioPath.empty()
+       && options.audioRate * options.audioDecimation > 192000)
+    {
+        result->error =
+            "Audio rate times decimation can't be over 192000 Hz.";
+        logMessage(result->error, LOG_ERRORS);
+        return 1;
+    }
+
+    bool limited = options.frames != 0 || options.cycles != 0;
+
+    try
+    {
+        std::filesystem::create_directories(options.outputDir);
+
+        EmuSys sys;
+        sys.loadROM(options.romPath);
+        sys.start();
+        sys.resume(); // start() leaves the system paused
+
+        if(!options.loadStatePath.empty())
+        {
+            sys.loadStateFile(options.loadStatePath);
+        }
+
+        // Input comes from the file alone, so replays are frame-exact.
+        InputStream input;
+        if(!options.inputPath.empty())
+        {
+            input.loadFile(options.inputPath);
+            sys.setInputSource(&input);
+        }
+
+        InputStream recorder;
+        if(!options.recordPath.empty()) { sys.setInputRecorder(&recorder); }
+
+        // The linked system is only there to talk to, so it never renders
+        // or synthesizes audio.
+        std::unique_ptr<EmuSys> linked_sys;
+        std::unique_ptr<EmuLink> link;
+        if(!options.linkROMPath.empty())
+        {
+            linked_sys = std::make_unique<EmuSys>();
+            linked_sys->loadROM(options.linkROMPath);
+            linked_sys->start();
+            linked_sys->resume();
+            linked_sys->setRenderInterval(0);
+            linked_sys->setAudioEnabled(false);
+            link = std::make_unique<EmuLink>(&sys, linked_sys.get());
+        }
+
+#ifdef IMGBE_LINK_SOCKET
+        std::unique_ptr<LinkSocket> link_socket;
+        if(!options.linkSocketPath.empty())
+        {
+            link_socket = std::make_unique<LinkSocket>(&sys);
+            link_socket->setBudget(options.linkBudget);
+            if(options.linkListen)
+            {
+                link_socket->listen(options.linkSocketPath);
+            } else
+            {
+                link_socket->connect(options.linkSocketPath);
+            }
+        }
+#endif
+
+        // Only compose frames that will actually be written.
+        sys.setRenderInterval(options.dumpInterval);
+
+        // Same for audio: without a capture file, skip synthesis entirely.
+        std::unique_ptr<AudioFileWriter> audio_writer;
+        if(!options.audioPath.empty())
+        {
+            sys.setAudioSampleRate(
+                options.audioRate * static_cast<int>(options.audioDecimation)
+            );
+            audio_writer = std::make_unique<AudioFileWriter>(
+                options.outputDir / options.audioPath,
+                options.audioRate,
+                options.audioDecimation
+            );
+        } else
+        {
+            sys.setAudioEnabled(false);
+        }
+
+        constexpr size_t AUDIO_CHUNK_FRAMES = 4096;
+        std::vector<int16_t> audio_chunk(AUDIO_CHUNK_FRAMES * 2);
+
+        logMessage("Starting headless run...", LOG_INFO);
+        auto start_time = std::chrono::steady_clock::now();
+
+        // Frames are counted by the PPU, since a cycle budget or a state
+        // loaded mid-frame doesn't end loop iterations on frame boundaries.
+        uint64_t start_frame = sys.getFrameCount();
+        uint64_t frames_run = 0;
+        uint64_t next_dump = 1;
+
+        while(sys.isRunning())
+        {
+            if(options.frames != 0 && frames_run >= options.frames) { break; }
+            if(options.cycles != 0 && sys.getCycleCount() >= options.cycles)
+            {
+                break;
+            }
+
+            if(sys.isPaused())
+            {
+                logMessage("System paused during headless run.", LOG_ERRORS);
+                break;
+            }
+
+            // The final frame is always written, so compose the last couple.
+            bool near_frame_limit = options.frames != 0
+                && options.frames - frames_run <= 2;
+            bool near_cycle_limit = options.cycles != 0
+                && options.cycles - sys.getCycleCount()
+                    <= 2 * EMU_CYCLES_PER_FRAME;
+            if(near_frame_limit || near_cycle_limit)
+            {
+                sys.setRenderInterval(1);
+            }
+
+            if(link != nullptr)
+            {
+                link->runFrame();
+            }
+#ifdef IMGBE_LINK_SOCKET
+            else if(link_socket != nullptr)
+            {
+                link_socket->runFrame();
+            }
+#endif
+            else if(options.cycles != 0)
+            {
+                sys.runCycles(std::min<uint64_t>(
+                    options.cycles - sys.getCycleCount(),
+                    EMU_CYCLES_PER_FRAME
+                ));
+            } else
+            {
+                sys.runFrame();
+            }
+
+            if(audio_writer != nullptr)
+            {
+                size_t frames;
+                while((frames = sys.readAudio(
+                    audio_chunk.data(), AUDIO_CHUNK_FRAMES
+                )) != 0)
+                {
+                    audio_writer->write(audio_chunk.data(), frames);
+                }
+            }
+
+            frames_run = sys.getFrameCount() - start_frame;
+            if(options.dumpInterval != 0 && frames_run >= next_dump)
+            {
+                writeFramePGM(
+                    options.outputDir
+                        / fmt::format("frame_{:08d}.pgm", frames_run),
+                    sys.getFrameBuffer()
+                );
+                while(next_dump <= frames_run)
+                {
+                    next_dump += options.dumpInterval;
+                }
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start_time
+        ).count();
+        result->frames = frames_run;
+        result->cycles = sys.getCycleCount();
+        result->seconds = seconds;
+
+        if(!options.recordPath.empty())
+        {
+            recorder.saveFile(options.recordPath);
+            logMessage(fmt::format(
+                "Wrote input recording to {}.", options.recordPath.string()
+            ), LOG_INFO);
+        }
+
+        if(!options.saveStatePath.empty())
+        {
+            sys.saveStateFile(options.saveStatePath);
+            logMessage(fmt::format(
+                "Wrote save state to {}.", options.saveStatePath.string()
+            ), LOG_INFO);
+        }
+
+        if(limited || options.dumpInterval != 0)
+        {
+            writeFramePGM(options.outputDir / "final.pgm",
+                          sys.getFrameBuffer());
+        }
+
+        if(audio_writer != nullptr)
+        {
+            audio_writer->close();
+            logMessage(fmt::format(
+                "Wrote {} audio frames at {} Hz to {}.",
+                audio_writer->getFramesWritten(), options.audioRate,
+                (options.outputDir / options.audioPath).string()
+            ), LOG_INFO);
+        }
+
+        logMessage(fmt::format(
+            "Headless run finished. Frames: {} - Cycles: {} - "
+            "Time: {:.3f}s - Emulated FPS: {:.1f}",
+            frames_run, sys.getCycleCount(), seconds,
+            (seconds > 0) ? frames_run / seconds : 0.0
+        ),
+            LOG_INFO
+        );
+    } catch(std::exception& ex)
+    {
+        result->error = ex.what();
+        logMessage(fmt::format(
+            "Headless run failed. Error: {}", ex.what()
+        ),
+            LOG_ERRORS
+        );
+        return 1;
+    }
+
+    return 0;
+}
+
+
+
+/**
+ * @brief Writes a frame of shades (0-3) as a binary PGM image.
+ * @param file_path
+ * @param shades 160 * 144 bytes, row-major.
+ * @throws std::ios_base::failure on file error.
+ */
+void writeFramePGM(
+    const std::filesystem::path& file_path,
+    const uint8_t* shades
+)
+{
+    constexpr uint8_t SHADE_GRAYS[4] = { 0xFF, 0xAA, 0x55, 0x00 };
+
+    std::ofstream file(file_path, std::ios_base::out | std::ios_base::binary);
+    if(!file.is_open())
+    {
+        throw std::ios_base::failure(fmt::format(
+            "Cannot open file {}!", file_path.string()
+        ));
+    }
+
+    std::string header = fmt::format("P5\n{} {}\n255\n", LCD_WIDTH, LCD_HEIGHT);
+    file.write(header.data(), header.size());
+
+    char pixels[LCD_WIDTH * LCD_HEIGHT];
+    for(int i = 0; i < LCD_WIDTH * LCD_HEIGHT; i++)
+    {
+        pixels[i] = static_cast<char>(SHADE_GRAYS[shades[i] & 0b11]);
+    }
+    file.write(pixels, sizeof(pixels));
+}
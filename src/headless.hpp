@@ -0,0 +1,86 @@
+/**
+ * @file headless.hpp
+ * @brief Runs the emulator without a window, renderer, or event loop
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+struct HeadlessOptions
+{
+    std::filesystem::path romPath = "";
+    std::filesystem::path outputDir = ".";
+
+    // Zero means no limit. Runs until the system stops if both are zero.
+    uint64_t frames = 0;
+    uint64_t cycles = 0;
+
+    // Writes every Nth frame to the output directory. Zero disables.
+    unsigned int dumpInterval = 0;
+
+    // Captures audio to a .wav file, or raw PCM for other extensions.
+    // Relative paths are under outputDir. Empty disables audio entirely.
+    std::filesystem::path audioPath = "";
+    int audioRate = 48000;
+    // Synthesizes at audioRate * N and filters down. 1 disables.
+    unsigned int audioDecimation = 1;
+
+    // Replays joypad input from a file. Empty means no buttons are held.
+    std::filesystem::path inputPath = "";
+    // Records the input the system reads, written when the run ends.
+    // Empty disables.
+    std::filesystem::path recordPath = "";
+
+    // Starts from a save state instead of power-on, and saves the state
+    // the run ends in. Empty disables.
+    std::filesystem::path loadStatePath = "";
+    std::filesystem::path saveStatePath = "";
+
+    // Runs a second ROM on a link cable to the first. Only the first
+    // system's frames and audio are written. Empty disables.
+    std::filesystem::path linkROMPath = "";
+
+    // Links to an emulator in another process over a Unix socket, by
+    // listening on or connecting to a path. Empty disables.
+    std::filesystem::path linkSocketPath = "";
+    bool linkListen = false;
+    // Cycles this side may run ahead of the other before waiting
+    uint64_t linkBudget = 70224;
+};
+
+// What a run did, for callers running many
+struct HeadlessResult
+{
+    uint64_t frames = 0;
+    uint64_t cycles = 0;
+    double seconds = 0.0;
+    // Why the run failed, empty on success
+    std::string error = "";
+};
+
+/**
+ * @brief Runs a ROM as fast as possible until a limit is hit or it stops.
+ * @param options
+ * @param result Filled in with what the run did. May be nullptr.
+ * @returns Process exit status. 0 on success.
+ */
+int runHeadless(
+    const HeadlessOptions& options,
+    HeadlessResult* result = nullptr
+) noexcept;
+
+/**
+ * @brief Writes a frame of shades (0-3) as a binary PGM image.
+ * @param file_path
+ * @param shades 160 * 144 bytes, row-major.
+ * @throws std::ios_base::failure on file error.
+ */
+void writeFramePGM(
+    const std::filesystem::path& file_path,
+    const uint8_t* shades
+);
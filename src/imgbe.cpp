@@ -0,0 +1,399 @@
+/**
+ * @file imgbe.cpp
+ * @brief C interface to the emulation core
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "imgbe.h"
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "logger.hpp"
+#include "emu/emubatch.hpp"
+#include "emu/emusys.hpp"
+
+static_assert(IMGBE_SCREEN_WIDTH == LCD_WIDTH, "LCD width mismatch");
+static_assert(IMGBE_SCREEN_HEIGHT == LCD_HEIGHT, "LCD height mismatch");
+
+struct imgbe_sys
+{
+    EmuSys sys;
+    HeldInput input;
+    std::string lastError;
+};
+
+struct imgbe_batch
+{
+    EmuBatch batch;
+    std::string lastError;
+
+    explicit imgbe_batch(unsigned int threads) : batch(threads) {}
+};
+
+/**
+ * @brief Runs a call into the core, turning anything it throws into an
+ * error status.
+ */
+template <typename Handle, typename Call>
+static int guard(Handle* handle, Call call) noexcept
+{
+    if(handle == nullptr) { return IMGBE_ERROR; }
+
+    try
+    {
+        call();
+        return IMGBE_OK;
+    } catch(const std::exception& e)
+    {
+        try { handle->lastError = e.what(); } catch(...) {}
+    } catch(...)
+    {
+        try { handle->lastError = "Unknown error!"; } catch(...) {}
+    }
+
+    return IMGBE_ERROR;
+}
+
+/**
+ * @brief Puts a loaded system in a state to run.
+ */
+static void startSystem(imgbe_sys* sys)
+{
+    sys->sys.start();
+    sys->sys.resume();
+    sys->sys.setInputSource(&sys->input);
+}
+
+
+
+imgbe_sys* imgbe_create(void)
+{
+    try
+    {
+        return new imgbe_sys();
+    } catch(...)
+    {
+        return nullptr;
+    }
+}
+
+
+
+void imgbe_destroy(imgbe_sys* sys)
+{
+    delete sys;
+}
+
+
+
+int imgbe_load_rom_file(imgbe_sys* sys, const char* path)
+{
+    return guard(sys, [&]()
+    {
+        if(path == nullptr)
+        {
+            throw std::runtime_error("No ROM path given!");
+        }
+
+        sys->sys.stop();
+        sys->sys.loadROM(std::filesystem::path(path));
+        startSystem(sys);
+    });
+}
+
+
+
+int imgbe_load_rom_memory(imgbe_sys* sys, const uint8_t* data, size_t size)
+{
+    return guard(sys, [&]()
+    {
+        if(data == nullptr)
+        {
+            throw std::runtime_error("No ROM data given!");
+        }
+
+        sys->sys.stop();
+        sys->sys.loadROM(data, size);
+        startSystem(sys);
+    });
+}
+
+
+
+int imgbe_run_frame(imgbe_sys* sys)
+{
+    return guard(sys, [&]()
+    {
+        sys->sys.discardAudio();
+        sys->sys.runFrame();
+    });
+}
+
+
+
+int imgbe_run_cycles(imgbe_sys* sys, uint64_t cycles)
+{
+    return guard(sys, [&]()
+    {
+        sys->sys.discardAudio();
+        sys->sys.runCycles(cycles);
+    });
+}
+
+
+
+void imgbe_set_buttons(imgbe_sys* sys, uint8_t buttons)
+{
+    if(sys == nullptr) { return; }
+    sys->input.setButtons(buttons);
+}
+
+
+
+void imgbe_get_registers(const imgbe_sys* sys, imgbe_registers* regs)
+{
+    if(sys == nullptr || regs == nullptr) { return; }
+
+    EmuCPU::State state = sys->sys.getCPUState();
+    regs->pc = state.cpu.pc;
+    regs->sp = state.cpu.sp;
+    regs->af = state.cpu.af;
+    regs->bc = state.cpu.bc;
+    regs->de = state.cpu.de;
+    regs->hl = state.cpu.hl;
+    regs->ime = state.imaster;
+}
+
+
+
+uint8_t imgbe_read_memory(const imgbe_sys* sys, uint16_t address)
+{
+    if(sys == nullptr) { return 0xFF; }
+    return sys->sys.readMemory(address);
+}
+
+
+
+const uint8_t* imgbe_framebuffer(const imgbe_sys* sys)
+{
+    if(sys == nullptr) { return nullptr; }
+    return sys->sys.getFrameBuffer();
+}
+
+
+
+const uint8_t* imgbe_memory(const imgbe_sys* sys, int region, size_t* size)
+{
+    uint16_t start;
+    size_t region_size;
+
+    switch(region)
+    {
+    case IMGBE_REGION_VRAM:
+        start = VRAM_START;
+        region_size = VRAM_SIZE;
+        break;
+    case IMGBE_REGION_ERAM:
+        start = ERAM_START;
+        region_size = ERAM_SIZE;
+        break;
+    case IMGBE_REGION_WRAM0:
+        start = WRAM0_START;
+        region_size = WRAM0_SIZE;
+        break;
+    case IMGBE_REGION_WRAM1:
+        start = WRAM1_START;
+        region_size = WRAM1_SIZE;
+        break;
+    case IMGBE_REGION_OAM:
+        start = OAM_START;
+        region_size = OAM_SIZE;
+        break;
+    case IMGBE_REGION_HRAM:
+        start = HRAM_START;
+        region_size = HRAM_SIZE;
+        break;
+    default:
+        if(size != nullptr) { *size = 0; }
+        return nullptr;
+    }
+
+    const uint8_t* data = (sys != nullptr)
+        ? sys->sys.getMemoryPtr(start)
+        : nullptr;
+
+    if(size != nullptr) { *size = (data != nullptr) ? region_size : 0; }
+    return data;
+}
+
+
+
+const int16_t* imgbe_audio(const imgbe_sys* sys, size_t* frames)
+{
+    if(sys == nullptr)
+    {
+        if(frames != nullptr) { *frames = 0; }
+        return nullptr;
+    }
+
+    if(frames != nullptr) { *frames = sys->sys.getAudioFramesAvailable(); }
+    return sys->sys.getAudio();
+}
+
+
+
+uint64_t imgbe_frame_count(const imgbe_sys* sys)
+{
+    if(sys == nullptr) { return 0; }
+    return sys->sys.getInputFrame();
+}
+
+
+
+const char* imgbe_last_error(const imgbe_sys* sys)
+{
+    if(sys == nullptr) { return ""; }
+    return sys->lastError.c_str();
+}
+
+
+
+imgbe_batch* imgbe_batch_create(
+    imgbe_sys* const* systems,
+    size_t count,
+    unsigned int threads
+)
+{
+    if(systems == nullptr && count != 0) { return nullptr; }
+
+    try
+    {
+        std::vector<EmuSys*> members(count);
+        for(size_t i = 0; i < count; i++)
+        {
+            if(systems[i] == nullptr) { return nullptr; }
+            members[i] = &systems[i]->sys;
+        }
+
+        imgbe_batch* batch = new imgbe_batch(threads);
+        batch->batch.setSystems(members);
+        return batch;
+    } catch(...)
+    {
+        return nullptr;
+    }
+}
+
+
+
+void imgbe_batch_destroy(imgbe_batch* batch)
+{
+    delete batch;
+}
+
+
+
+int imgbe_batch_set_observation(
+    imgbe_batch* batch,
+    int width,
+    int height,
+    int format,
+    unsigned int stack_depth,
+    int max_pool
+)
+{
+    return guard(batch, [&]()
+    {
+        if(format != IMGBE_OBSERVATION_SHADES
+           && format != IMGBE_OBSERVATION_GRAYSCALE)
+        {
+            throw std::invalid_argument("Unknown observation format!");
+        }
+
+        batch->batch.setObservation(
+            width, height,
+            (format == IMGBE_OBSERVATION_SHADES)
+                ? OBSERVATION_SHADES
+                : OBSERVATION_GRAYSCALE,
+            stack_depth, max_pool != 0
+        );
+    });
+}
+
+
+
+void imgbe_batch_reset_observation(imgbe_batch* batch, size_t index)
+{
+    if(batch == nullptr) { return; }
+    batch->batch.resetObservation(index);
+}
+
+
+
+size_t imgbe_batch_observation_size(const imgbe_batch* batch)
+{
+    if(batch == nullptr) { return 0; }
+    return batch->batch.getObservationSize();
+}
+
+
+
+int imgbe_batch_step(
+    imgbe_batch* batch,
+    const uint8_t* buttons,
+    unsigned int frames,
+    uint8_t* observations
+)
+{
+    return guard(batch, [&]()
+    {
+        if(buttons == nullptr)
+        {
+            throw std::runtime_error("No buttons given!");
+        }
+
+        batch->batch.step(buttons, frames, observations);
+    });
+}
+
+
+
+const char* imgbe_batch_last_error(const imgbe_batch* batch)
+{
+    if(batch == nullptr) { return ""; }
+    return batch->lastError.c_str();
+}
+
+
+
+void imgbe_set_log_callback(
+    imgbe_log_callback callback,
+    void* user,
+    int level
+)
+{
+    try
+    {
+        if(callback != nullptr)
+        {
+            setLogSink([=](const std::string& msg, LOG_LEVELS msg_level)
+            {
+                callback(user, msg_level, msg.c_str());
+            });
+        } else
+        {
+            setLogSink(nullptr);
+        }
+    } catch(...)
+    {
+        return;
+    }
+
+    setLogLevel(static_cast<LOG_LEVELS>(std::clamp(
+        level, static_cast<int>(LOG_NOTHING), static_cast<int>(LOG_DEBUG)
+    )));
+}
@@ -0,0 +1,289 @@
+/**
+ * @file imgbe.h
+ * @brief C interface to the emulation core
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ *
+ * Systems are opaque handles. Functions that can fail return IMGBE_OK or
+ * IMGBE_ERROR, and imgbe_last_error() says why. Nothing throws across the
+ * interface. Systems share no state, so each can run on its own thread.
+ *
+ * Observations are read in place: the framebuffer, memory, and audio
+ * pointers point into the running system, so reading them copies nothing
+ * and no call allocates once the system is running. The framebuffer
+ * pointer never changes for the life of a system. Memory pointers change
+ * when the game switches banks, and audio pointers on every run, so fetch
+ * those after each run.
+ */
+
+#ifndef IMGBE_H
+#define IMGBE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMGBE_SCREEN_WIDTH 160
+#define IMGBE_SCREEN_HEIGHT 144
+
+typedef struct imgbe_sys imgbe_sys;
+typedef struct imgbe_batch imgbe_batch;
+
+enum imgbe_status
+{
+    IMGBE_OK = 0,
+    IMGBE_ERROR = -1,
+};
+
+/* Joypad buttons, ORed together */
+enum imgbe_button
+{
+    IMGBE_BUTTON_RIGHT = 1 << 0,
+    IMGBE_BUTTON_LEFT = 1 << 1,
+    IMGBE_BUTTON_UP = 1 << 2,
+    IMGBE_BUTTON_DOWN = 1 << 3,
+    IMGBE_BUTTON_A = 1 << 4,
+    IMGBE_BUTTON_B = 1 << 5,
+    IMGBE_BUTTON_SELECT = 1 << 6,
+    IMGBE_BUTTON_START = 1 << 7,
+};
+
+/* RAM that can be read in place. Banked regions give the bank mapped now. */
+enum imgbe_region
+{
+    IMGBE_REGION_VRAM,
+    IMGBE_REGION_ERAM,
+    IMGBE_REGION_WRAM0,
+    IMGBE_REGION_WRAM1,
+    IMGBE_REGION_OAM,
+    IMGBE_REGION_HRAM,
+};
+
+/* Observations written by batch steps */
+enum imgbe_observation_format
+{
+    IMGBE_OBSERVATION_SHADES, /* 0-3, sampled at pixel centres */
+    IMGBE_OBSERVATION_GRAYSCALE, /* 0-255, white at 255, area averaged */
+};
+
+/**
+ * @brief Receives a log message from the core.
+ * @param user
+ * @param level 1 for errors, 2 for info, 3 for debug.
+ * @param message
+ */
+typedef void (*imgbe_log_callback)(void* user, int level, const char* message);
+
+typedef struct imgbe_registers
+{
+    uint16_t pc;
+    uint16_t sp;
+    uint16_t af;
+    uint16_t bc;
+    uint16_t de;
+    uint16_t hl;
+    uint8_t ime;
+} imgbe_registers;
+
+/**
+ * @brief Creates a system with no ROM loaded.
+ * @returns NULL if out of memory.
+ */
+imgbe_sys* imgbe_create(void);
+
+/**
+ * @brief Destroys a system. NULL is ignored.
+ */
+void imgbe_destroy(imgbe_sys* sys);
+
+/**
+ * @brief Loads a ROM file and starts the system.
+ * @param sys
+ * @param path
+ */
+int imgbe_load_rom_file(imgbe_sys* sys, const char* path);
+
+/**
+ * @brief Loads a ROM image from memory and starts the system. Battery-backed
+ * RAM isn't saved.
+ * @param sys
+ * @param data Copied, so it needn't outlive the call.
+ * @param size
+ */
+int imgbe_load_rom_memory(imgbe_sys* sys, const uint8_t* data, size_t size);
+
+/**
+ * @brief Runs one frame. Audio from the previous run is dropped.
+ * @param sys
+ */
+int imgbe_run_frame(imgbe_sys* sys);
+
+/**
+ * @brief Runs at least a number of cycles, across frames if need be. Audio
+ * from the previous run is dropped.
+ * @param sys
+ * @param cycles 4194304 per second.
+ */
+int imgbe_run_cycles(imgbe_sys* sys, uint64_t cycles);
+
+/**
+ * @brief Sets the buttons held from the next frame on.
+ * @param sys
+ * @param buttons imgbe_button bitmask.
+ */
+void imgbe_set_buttons(imgbe_sys* sys, uint8_t buttons);
+
+/**
+ * @brief Reads the CPU's registers.
+ * @param sys
+ * @param regs
+ */
+void imgbe_get_registers(const imgbe_sys* sys, imgbe_registers* regs);
+
+/**
+ * @brief Reads a byte as the CPU would, without side effects.
+ * @param sys
+ * @param address
+ */
+uint8_t imgbe_read_memory(const imgbe_sys* sys, uint16_t address);
+
+/**
+ * @brief Returns the last completed frame as IMGBE_SCREEN_WIDTH *
+ * IMGBE_SCREEN_HEIGHT shades (0-3), row-major. The pointer never changes
+ * for the life of the system.
+ * @param sys
+ */
+const uint8_t* imgbe_framebuffer(const imgbe_sys* sys);
+
+/**
+ * @brief Returns a RAM region in place. Valid until the game switches the
+ * region's bank.
+ * @param sys
+ * @param region imgbe_region
+ * @param size Set to the region's size in bytes. May be NULL.
+ * @returns NULL if the region isn't mapped, e.g. a cartridge without RAM.
+ */
+const uint8_t* imgbe_memory(const imgbe_sys* sys, int region, size_t* size);
+
+/**
+ * @brief Returns the audio produced by the last run, as interleaved 16-bit
+ * stereo frames. Valid until the next run.
+ * @param sys
+ * @param frames Set to the number of stereo frames. May be NULL.
+ */
+const int16_t* imgbe_audio(const imgbe_sys* sys, size_t* frames);
+
+/**
+ * @brief Returns the number of frames run since the ROM was loaded.
+ * @param sys
+ */
+uint64_t imgbe_frame_count(const imgbe_sys* sys);
+
+/**
+ * @brief Returns why the last failing call failed, or "" if none has.
+ * Valid until the next failing call.
+ * @param sys
+ */
+const char* imgbe_last_error(const imgbe_sys* sys);
+
+/**
+ * @brief Creates a pool that steps many systems together. Each thread
+ * always steps the same systems. While the batch exists, the systems'
+ * buttons are set through it, not imgbe_set_buttons().
+ * @param systems Loaded systems, which must outlive the batch.
+ * @param count
+ * @param threads Threads to step on, counting the caller's. 0 for one per
+ * core.
+ * @returns NULL on failure.
+ */
+imgbe_batch* imgbe_batch_create(
+    imgbe_sys* const* systems,
+    size_t count,
+    unsigned int threads
+);
+
+/**
+ * @brief Stops a batch's threads. NULL is ignored.
+ */
+void imgbe_batch_destroy(imgbe_batch* batch);
+
+/**
+ * @brief Makes a batch's steps write a downsampled stack of frames per
+ * system instead of the whole frame, oldest first. Stacks start empty,
+ * and the first frame after that fills them.
+ * @param batch
+ * @param width At most IMGBE_SCREEN_WIDTH.
+ * @param height At most IMGBE_SCREEN_HEIGHT.
+ * @param format imgbe_observation_format
+ * @param stack_depth Frames stacked, at least 1.
+ * @param max_pool Non-zero to take the darker of each pixel over the last
+ * two frames of a step, so objects that flicker aren't lost.
+ */
+int imgbe_batch_set_observation(
+    imgbe_batch* batch,
+    int width,
+    int height,
+    int format,
+    unsigned int stack_depth,
+    int max_pool
+);
+
+/**
+ * @brief Empties one system's stack, e.g. when its episode restarts.
+ * @param batch
+ * @param index
+ */
+void imgbe_batch_reset_observation(imgbe_batch* batch, size_t index);
+
+/**
+ * @brief Returns the bytes a step writes per system. Whole frames, of
+ * IMGBE_SCREEN_WIDTH * IMGBE_SCREEN_HEIGHT shades, unless an observation
+ * is set.
+ * @param batch
+ */
+size_t imgbe_batch_observation_size(const imgbe_batch* batch);
+
+/**
+ * @brief Runs every system in a batch for a number of frames, then writes
+ * what they show into one buffer. Audio works as in a run call.
+ * @param batch
+ * @param buttons One imgbe_button bitmask per system.
+ * @param frames
+ * @param observations Room for count * imgbe_batch_observation_size()
+ * bytes, in system order. May be NULL.
+ */
+int imgbe_batch_step(
+    imgbe_batch* batch,
+    const uint8_t* buttons,
+    unsigned int frames,
+    uint8_t* observations
+);
+
+/**
+ * @brief Returns why the last failing step failed, or "" if none has.
+ * @param batch
+ */
+const char* imgbe_batch_last_error(const imgbe_batch* batch);
+
+/**
+ * @brief Sends the core's log messages to a function instead of stdout and
+ * stderr, for the whole process. By default, errors go to stderr.
+ * @param callback Called from whichever thread logs, one message at a
+ * time. NULL for the default outputs.
+ * @param user Passed to callback.
+ * @param level Most detailed level logged: 0 for nothing up to 3 for debug.
+ */
+void imgbe_set_log_callback(
+    imgbe_log_callback callback,
+    void* user,
+    int level
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IMGBE_H */
@@ -0,0 +1,44 @@
+/**
+ * @file input.cpp
+ * @brief Reads joypad input from the keyboard
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "input.hpp"
+#include <SDL2/SDL.h>
+
+struct KeyBinding
+{
+    SDL_Scancode scancode;
+    uint8_t button;
+};
+
+constexpr KeyBinding KEY_BINDINGS[] =
+{
+    { SDL_SCANCODE_RIGHT, JOYPAD_RIGHT },
+    { SDL_SCANCODE_LEFT, JOYPAD_LEFT },
+    { SDL_SCANCODE_UP, JOYPAD_UP },
+    { SDL_SCANCODE_DOWN, JOYPAD_DOWN },
+    { SDL_SCANCODE_Z, JOYPAD_A },
+    { SDL_SCANCODE_X, JOYPAD_B },
+    { SDL_SCANCODE_BACKSPACE, JOYPAD_SELECT },
+    { SDL_SCANCODE_RETURN, JOYPAD_START },
+};
+
+
+
+uint8_t KeyboardInput::getButtons(uint64_t frame) noexcept
+{
+    // Events are pumped by the main loop, so this is current as of the
+    // start of the frame.
+    const Uint8* keys = SDL_GetKeyboardState(nullptr);
+
+    uint8_t buttons = 0;
+    for(const KeyBinding& binding : KEY_BINDINGS)
+    {
+        if(keys[binding.scancode]) { buttons |= binding.button; }
+    }
+
+    return buttons;
+}
@@ -0,0 +1,21 @@
+/**
+ * @file input.hpp
+ * @brief Reads joypad input from the keyboard
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "emu/emuinput.hpp"
+
+/**
+ * @brief Reads the held buttons from SDL's keyboard state.
+ * Arrows: D-pad, Z: A, X: B, Backspace: Select, Enter: Start.
+ */
+class KeyboardInput : public InputSource
+{
+public:
+    uint8_t getButtons(uint64_t frame) noexcept override;
+};
@@ -0,0 +1,530 @@
+/**
+ * @file linksocket.cpp
+ * @brief Connects the serial port to another process over a Unix socket
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "linksocket.hpp"
+
+#ifdef IMGBE_LINK_SOCKET
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fmt/core.h>
+#include "logger.hpp"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+constexpr uint64_t LINK_PROTOCOL_VERSION = 1;
+// Waiting longer than this on the other side counts as a disconnect.
+constexpr int LINK_TIMEOUT_MS = 10000;
+// A side waiting for the other to clock a transfer stays this close behind
+// it, so a transfer lands at most this late. One serial bit.
+constexpr uint64_t LINK_WAITING_SLACK = 512;
+// Type, byte, and a little-endian 64-bit cycle
+constexpr size_t LINK_MESSAGE_SIZE = 10;
+
+enum LinkMessageType : uint8_t
+{
+    LINK_HELLO,      // cycle is the protocol version
+    LINK_SYNC,       // sender has reached cycle
+    LINK_READY,      // sender would shift out byte from cycle on
+    LINK_IDLE,       // sender isn't waiting for a transfer from cycle on
+    LINK_TRANSFER,   // sender clocked a transfer of byte at cycle
+};
+
+
+
+/**
+ * @brief Creates an unconnected link for a system. The system must outlive
+ * the link.
+ * @param sys
+ */
+LinkSocket::LinkSocket(EmuSys* sys) :
+    sys(sys)
+{}
+
+/**
+ * @brief Disconnects, and detaches from the system's serial port.
+ */
+LinkSocket::~LinkSocket()
+{
+    if(socketFD >= 0) { close(socketFD); }
+    sys->setSerialPeer(nullptr);
+}
+
+
+
+/**
+ * @brief Creates a socket and waits for the other side to connect.
+ * @param socket_path
+ * @throws std::runtime_error on socket error.
+ */
+void LinkSocket::listen(const std::filesystem::path& socket_path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if(socket_path.string().size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error(fmt::format(
+            "Link socket path {} is too long!", socket_path.string()
+        ));
+    }
+    std::strcpy(address.sun_path, socket_path.c_str());
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(server < 0)
+    {
+        throw std::runtime_error(fmt::format(
+            "Cannot create link socket! Error: {}", std::strerror(errno)
+        ));
+    }
+
+    // A socket file left over from an earlier run would block bind().
+    unlink(socket_path.c_str());
+
+    if(bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address))
+       != 0 || ::listen(server, 1) != 0)
+    {
+        std::string error = std::strerror(errno);
+        close(server);
+        throw std::runtime_error(fmt::format(
+            "Cannot listen on link socket {}! Error: {}",
+            socket_path.string(), error
+        ));
+    }
+
+    logMessage(fmt::format(
+        "Waiting for link peer on {}...", socket_path.string()
+    ), LOG_INFO);
+
+    socketFD = accept(server, nullptr, nullptr);
+    std::string error = std::strerror(errno);
+    close(server);
+    unlink(socket_path.c_str());
+
+    if(socketFD < 0)
+    {
+        throw std::runtime_error(fmt::format(
+            "Cannot accept link peer! Error: {}", error
+        ));
+    }
+
+    handshake();
+}
+
+
+
+/**
+ * @brief Connects to a socket the other side is listening on.
+ * @param socket_path
+ * @throws std::runtime_error on socket error.
+ */
+void LinkSocket::connect(const std::filesystem::path& socket_path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if(socket_path.string().size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error(fmt::format(
+            "Link socket path {} is too long!", socket_path.string()
+        ));
+    }
+    std::strcpy(address.sun_path, socket_path.c_str());
+
+    socketFD = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(socketFD < 0
+       || ::connect(
+           socketFD, reinterpret_cast<sockaddr*>(&address), sizeof(address)
+       ) != 0)
+    {
+        std::string error = std::strerror(errno);
+        if(socketFD >= 0) { close(socketFD); }
+        socketFD = -1;
+        throw std::runtime_error(fmt::format(
+            "Cannot connect to link socket {}! Error: {}",
+            socket_path.string(), error
+        ));
+    }
+
+    handshake();
+}
+
+
+
+bool LinkSocket::isConnected(void) const noexcept
+{
+    return socketFD >= 0;
+}
+
+
+
+/**
+ * @brief Sets how many cycles this side may run past the other.
+ * @param cycles Clamped to at least 1.
+ */
+void LinkSocket::setBudget(uint64_t cycles) noexcept
+{
+    budget = std::max<uint64_t>(cycles, 1);
+}
+
+
+
+uint64_t LinkSocket::getBudget(void) const noexcept
+{
+    return budget;
+}
+
+
+
+/**
+ * @brief Runs the system through one frame, staying within the budget of
+ * the other side. Runs the frame unlinked if disconnected.
+ * @throws std::runtime_error on system not running.
+ */
+void LinkSocket::runFrame(void)
+{
+    // Report progress a few times per budget, so the other side rarely has
+    // to wait for a report.
+    uint64_t quantum = std::clamp<uint64_t>(
+        budget / 4, 1, EMU_CYCLES_PER_FRAME
+    );
+
+    bool done = false;
+    while(!done)
+    {
+        if(!isConnected())
+        {
+            sys->runFrameSlice(UINT64_MAX);
+            return;
+        }
+
+        if(!sys->isRunning() || sys->isPaused()) { return; }
+
+        receiveMessages(false);
+
+        // Waiting on the other side's clock, it could send a transfer at
+        // any cycle, so keep close behind it.
+        uint64_t limit = remoteCycle
+            + (sentWaiting ? LINK_WAITING_SLACK : budget);
+        while(isConnected() && getLocalCycle() >= limit)
+        {
+            receiveMessages(true);
+            limit = remoteCycle + (sentWaiting ? LINK_WAITING_SLACK : budget);
+        }
+
+        applyPendingTransfer();
+
+        uint64_t slice = std::min(quantum, limit - getLocalCycle());
+
+        // Stop at a pending transfer's cycle so it lands on time.
+        if(transferPending && pendingTransfer.cycle > getLocalCycle())
+        {
+            slice = std::min(slice, pendingTransfer.cycle - getLocalCycle());
+        }
+
+        done = sys->runFrameSlice(slice);
+
+        applyPendingTransfer();
+        sendMessage(LINK_SYNC, 0, getLocalCycle());
+    }
+}
+
+
+
+/**
+ * @brief Answers a transfer this side clocked. If the other side last
+ * reported it was waiting, answers straight away. Otherwise it may still
+ * start waiting before this cycle, so waits until it gets here.
+ */
+uint8_t LinkSocket::exchange(uint8_t byte) noexcept
+{
+    if(!isConnected()) { return 0xFF; }
+
+    uint64_t cycle = getLocalCycle();
+
+    // The other side may be waiting on this side's progress too.
+    sendMessage(LINK_SYNC, 0, cycle);
+
+    updateRemoteState(cycle);
+    while(isConnected() && !remote.waiting && remoteCycle < cycle)
+    {
+        receiveMessages(true);
+        updateRemoteState(cycle);
+    }
+
+    if(!isConnected() || !remote.waiting) { return 0xFF; }
+
+    // The other side reports idle once it has applied the transfer.
+    remote.waiting = false;
+    sendMessage(LINK_TRANSFER, byte, cycle);
+    return remote.byte;
+}
+
+
+
+/**
+ * @brief Reports what this side would shift out, if it changed.
+ */
+void LinkSocket::notifyReady(uint8_t byte, bool waiting) noexcept
+{
+    if(!isConnected()) { return; }
+    if(waiting == sentWaiting && (!waiting || byte == sentByte)) { return; }
+
+    // Starting to wait means staying close behind the other side, which
+    // the running slice may already be well past.
+    if(waiting && !sentWaiting) { sys->endSlice(); }
+
+    sentByte = byte;
+    sentWaiting = waiting;
+    sendMessage(waiting ? LINK_READY : LINK_IDLE, byte, getLocalCycle());
+}
+
+
+
+/**
+ * @brief Swaps protocol versions, and starts counting cycles from now.
+ * @throws std::runtime_error on a failed handshake.
+ */
+void LinkSocket::handshake(void)
+{
+    baseCycle = sys->getCycleCount();
+    remoteCycle = 0;
+    remoteStates.clear();
+    remote = RemoteState{ 0, 0xFF, false };
+    sentByte = 0xFF;
+    sentWaiting = false;
+    transferPending = false;
+    receiveBuffer.clear();
+    helloReceived = false;
+
+    sendMessage(LINK_HELLO, 0, LINK_PROTOCOL_VERSION);
+
+    while(isConnected() && !helloReceived)
+    {
+        receiveMessages(true);
+    }
+
+    if(!isConnected())
+    {
+        throw std::runtime_error("Link peer didn't complete the handshake!");
+    }
+
+    sys->setSerialPeer(this);
+    logMessage("Link peer connected.", LOG_INFO);
+}
+
+
+
+void LinkSocket::disconnect(const std::string& reason) noexcept
+{
+    if(socketFD < 0) { return; }
+
+    close(socketFD);
+    socketFD = -1;
+    transferPending = false;
+
+    logMessage(fmt::format("Link disconnected: {}", reason), LOG_ERRORS);
+}
+
+
+
+uint64_t LinkSocket::getLocalCycle(void) const noexcept
+{
+    return sys->getCycleCount() - baseCycle;
+}
+
+
+
+void LinkSocket::sendMessage(
+    uint8_t type,
+    uint8_t byte,
+    uint64_t cycle
+) noexcept
+{
+    if(!isConnected()) { return; }
+
+    uint8_t data[LINK_MESSAGE_SIZE];
+    data[0] = type;
+    data[1] = byte;
+    for(int i = 0; i < 8; i++)
+    {
+        data[2 + i] = static_cast<uint8_t>(cycle >> (i * 8));
+    }
+
+    size_t sent = 0;
+    while(sent < sizeof(data))
+    {
+        ssize_t result = send(
+            socketFD, data + sent, sizeof(data) - sent, MSG_NOSIGNAL
+        );
+
+        if(result < 0 && errno == EINTR) { continue; }
+        if(result <= 0)
+        {
+            disconnect(std::strerror(errno));
+            return;
+        }
+
+        sent += result;
+    }
+}
+
+
+
+/**
+ * @brief Reads and handles whatever messages have arrived.
+ * @param wait Block until at least some data arrives.
+ * @returns false if disconnected.
+ */
+bool LinkSocket::receiveMessages(bool wait) noexcept
+{
+    if(!isConnected()) { return false; }
+
+    if(wait)
+    {
+        pollfd poll_fd{ socketFD, POLLIN, 0 };
+        int ready = poll(&poll_fd, 1, LINK_TIMEOUT_MS);
+        if(ready == 0)
+        {
+            disconnect("Timed out waiting for peer.");
+            return false;
+        }
+    }
+
+    uint8_t chunk[4096];
+    ssize_t received = recv(
+        socketFD, chunk, sizeof(chunk), wait ? 0 : MSG_DONTWAIT
+    );
+
+    if(received == 0)
+    {
+        disconnect("Peer closed the connection.");
+        return false;
+    }
+
+    if(received < 0)
+    {
+        if(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        {
+            return true;
+        }
+        disconnect(std::strerror(errno));
+        return false;
+    }
+
+    receiveBuffer.insert(receiveBuffer.end(), chunk, chunk + received);
+
+    size_t pos = 0;
+    while(receiveBuffer.size() - pos >= LINK_MESSAGE_SIZE && isConnected())
+    {
+        Message message{ receiveBuffer[pos], receiveBuffer[pos + 1], 0 };
+        for(int i = 0; i < 8; i++)
+        {
+            message.cycle |=
+                static_cast<uint64_t>(receiveBuffer[pos + 2 + i]) << (i * 8);
+        }
+
+        handleMessage(message);
+        pos += LINK_MESSAGE_SIZE;
+    }
+
+    receiveBuffer.erase(receiveBuffer.begin(), receiveBuffer.begin() + pos);
+    return isConnected();
+}
+
+
+
+void LinkSocket::handleMessage(const Message& message) noexcept
+{
+    switch(message.type)
+    {
+    case LINK_HELLO:
+    {
+        if(message.cycle != LINK_PROTOCOL_VERSION)
+        {
+            disconnect(fmt::format(
+                "Peer uses protocol version {}, expected {}.",
+                message.cycle, LINK_PROTOCOL_VERSION
+            ));
+        }
+        helloReceived = true;
+        break;
+    }
+
+    case LINK_SYNC:
+    {
+        remoteCycle = std::max(remoteCycle, message.cycle);
+        break;
+    }
+
+    case LINK_READY:
+    case LINK_IDLE:
+    {
+        // Takes effect here once this side reaches the same cycle.
+        remoteStates.push_back({
+            message.cycle, message.byte, message.type == LINK_READY
+        });
+        remoteCycle = std::max(remoteCycle, message.cycle);
+        break;
+    }
+
+    case LINK_TRANSFER:
+    {
+        transferPending = true;
+        pendingTransfer = message;
+        remoteCycle = std::max(remoteCycle, message.cycle);
+        applyPendingTransfer();
+        break;
+    }
+
+    default:
+    {
+        disconnect(fmt::format("Unknown message type {}.", message.type));
+        break;
+    }
+    }
+}
+
+
+
+/**
+ * @brief Applies a transfer the other side clocked, once this side has
+ * reached its cycle.
+ */
+void LinkSocket::applyPendingTransfer(void) noexcept
+{
+    if(!transferPending || getLocalCycle() < pendingTransfer.cycle)
+    {
+        return;
+    }
+
+    transferPending = false;
+    sys->receiveSerial(pendingTransfer.byte);
+}
+
+
+
+/**
+ * @brief Moves everything the other side reported up to a cycle into
+ * effect.
+ */
+void LinkSocket::updateRemoteState(uint64_t cycle) noexcept
+{
+    while(!remoteStates.empty() && remoteStates.front().cycle <= cycle)
+    {
+        remote = remoteStates.front();
+        remoteStates.pop_front();
+    }
+}
+
+#endif
@@ -0,0 +1,139 @@
+/**
+ * @file linksocket.hpp
+ * @brief Connects the serial port to another process over a Unix socket
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+#define IMGBE_LINK_SOCKET 1
+#endif
+
+#ifdef IMGBE_LINK_SOCKET
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <vector>
+#include "emu/emuserial.hpp"
+#include "emu/emusys.hpp"
+
+// How far either side may run past the other's last reported cycle.
+constexpr uint64_t LINK_DEFAULT_BUDGET = EMU_CYCLES_PER_FRAME;
+
+/**
+ * @brief A link cable to an emulator in another process, over a Unix
+ * domain socket.
+ *
+ * Each side reports its cycle count, and what it would shift out if the
+ * other side clocked a transfer. A side may run up to the budget past the
+ * other before it waits, so neither stalls on a round trip per byte. A side
+ * waiting for the other to clock a transfer stays close behind it instead,
+ * so the transfer lands on time. When a transfer this side clocks
+ * finishes, it answers from what was reported, only waiting if the other
+ * side may still start waiting before that cycle.
+ */
+class LinkSocket : public SerialPeer
+{
+public:
+    /**
+     * @brief Creates an unconnected link for a system. The system must
+     * outlive the link.
+     * @param sys
+     */
+    LinkSocket(EmuSys* sys);
+
+    /**
+     * @brief Disconnects, and detaches from the system's serial port.
+     */
+    ~LinkSocket();
+
+    LinkSocket(const LinkSocket&) = delete;
+    LinkSocket& operator=(const LinkSocket&) = delete;
+
+    /**
+     * @brief Creates a socket and waits for the other side to connect.
+     * @param socket_path
+     * @throws std::runtime_error on socket error.
+     */
+    void listen(const std::filesystem::path& socket_path);
+
+    /**
+     * @brief Connects to a socket the other side is listening on.
+     * @param socket_path
+     * @throws std::runtime_error on socket error.
+     */
+    void connect(const std::filesystem::path& socket_path);
+
+    bool isConnected(void) const noexcept;
+
+    /**
+     * @brief Sets how many cycles this side may run past the other.
+     * @param cycles Clamped to at least 1.
+     */
+    void setBudget(uint64_t cycles) noexcept;
+
+    uint64_t getBudget(void) const noexcept;
+
+    /**
+     * @brief Runs the system through one frame, staying within the budget
+     * of the other side. Runs the frame unlinked if disconnected.
+     * @throws std::runtime_error on system not running.
+     */
+    void runFrame(void);
+
+    uint8_t exchange(uint8_t byte) noexcept override;
+    void notifyReady(uint8_t byte, bool waiting) noexcept override;
+
+private:
+    struct Message
+    {
+        uint8_t type;
+        uint8_t byte;
+        uint64_t cycle;
+    };
+
+    struct RemoteState
+    {
+        uint64_t cycle;
+        uint8_t byte;
+        bool waiting;
+    };
+
+    EmuSys* sys;
+    int socketFD = -1;
+    bool helloReceived = false;
+    uint64_t budget = LINK_DEFAULT_BUDGET;
+
+    // Cycles are counted from when the connection was made.
+    uint64_t baseCycle = 0;
+    uint64_t remoteCycle = 0;
+
+    // Reported by the other side, oldest first, not yet in effect here
+    std::deque<RemoteState> remoteStates;
+    RemoteState remote{ 0, 0xFF, false };
+
+    // Last reported to the other side
+    uint8_t sentByte = 0xFF;
+    bool sentWaiting = false;
+
+    // A transfer the other side clocked, applied at its cycle
+    bool transferPending = false;
+    Message pendingTransfer{};
+
+    std::vector<uint8_t> receiveBuffer;
+
+    void handshake(void);
+    void disconnect(const std::string& reason) noexcept;
+    uint64_t getLocalCycle(void) const noexcept;
+
+    void sendMessage(uint8_t type, uint8_t byte, uint64_t cycle) noexcept;
+    bool receiveMessages(bool wait) noexcept;
+    void handleMessage(const Message& message) noexcept;
+    void applyPendingTransfer(void) noexcept;
+    void updateRemoteState(uint64_t cycle) noexcept;
+};
+
+#endif
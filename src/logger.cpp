@@ -6,53 +6,54 @@
  */
 
 #include "logger.hpp"
+#include <atomic>
 #include <fstream>
+#include <mutex>
 #include <stdexcept>
 #include <filesystem>
 #include <ctime>
-#include <SDL2/SDL.h>
 #include <fmt/core.h>
 
+namespace
+{
 
-
-bool isInitialized = false;
-LOG_LEVELS logLevel;
-bool logToFile;
-bool logToCout;
+// Outputs are only touched under logMutex. Switches read on every message
+// are atomic, so messages that won't be logged don't take the lock.
+std::mutex logMutex;
+std::atomic<LOG_LEVELS> logLevel{ LOG_ERRORS };
+std::atomic<bool> logToFile{ false };
+std::atomic<bool> logToCout{ true };
 std::filesystem::path logFilePath = "";
 std::ofstream logFile;
+LogSink logSink;
+
+} // namespace
 
 
 
 /**
  * @brief Initializes the logger with given settings, or defaults
  * @param log_level default=LOG_ERRORS
- * @param log_to_file default=true, Does not attempt to open a file when false.
+ * @param log_file_path default="", Does not attempt to open a file when
+ * empty.
  * @param log_to_cout default=true
  * @throws std::runtime_error If log file cannot be opened.
  */
 void loggerInit(
     LOG_LEVELS log_level,
-    bool log_to_file,
+    const std::filesystem::path& log_file_path,
     bool log_to_cout
 )
 {
+    std::lock_guard<std::mutex> lock(logMutex);
+
     logLevel = log_level;
     logToCout = log_to_cout;
-    logToFile = log_to_file;
+    logToFile = !log_file_path.empty();
+    logFilePath = log_file_path;
 
-    if(log_to_file)
+    if(logToFile)
     {
-        // SDL handles creating the directory
-        logFilePath = SDL_GetPrefPath("ImpendingMoon", "IMGBE");
-        // Returns NULL if failed, so try using current path.
-        if(logFilePath.empty())
-        {
-            logFilePath = std::filesystem::current_path();
-        }
-
-        logFilePath += "imgbe.log";
-
         logFile.open(logFilePath, std::istream::out);
 
         if(!logFile.is_open())
@@ -63,8 +64,6 @@ void loggerInit(
             );
         }
     }
-
-    isInitialized = true;
 }
 
 
@@ -74,29 +73,37 @@ void loggerInit(
  */
 void loggerExit(void) noexcept
 {
+    std::lock_guard<std::mutex> lock(logMutex);
+
     if(logFile.is_open()) { logFile.close(); }
-    isInitialized = false;
+    logToFile = false;
 }
 
 
 
 /**
- * @brief Logs a message
+ * @brief Sends messages to a function instead of cout and the logfile,
+ * e.g. a host program's own log.
+ * @param sink Called with each message logged, from whichever thread logs
+ * it, one at a time. Empty to go back to cout and the logfile.
+ */
+void setLogSink(LogSink sink)
+{
+    std::lock_guard<std::mutex> lock(logMutex);
+    logSink = std::move(sink);
+}
+
+
+
+/**
+ * @brief Logs a message. Safe from any thread. Before loggerInit, errors
+ * go to cerr and everything else is dropped.
  * @param msg
- * @param level default=LOG_INFO
- * @throws std::runtime_error If run before loggerInit.
+ * @param level
  */
 void logMessage(const std::string& msg, LOG_LEVELS level)
 {
-    if(!isInitialized)
-    {
-        throw std::runtime_error("Logger must be initialized!");
-    }
-
-    if(logLevel == LOG_NOTHING || level == LOG_NOTHING)
-    {
-        return;
-    }
+    if(!isLogLevelEnabled(level)) { return; }
 
     std::string fmt_message = fmt::format(
         "[{}] {}\n",
@@ -104,6 +111,14 @@ void logMessage(const std::string& msg, LOG_LEVELS level)
         msg
         );
 
+    std::lock_guard<std::mutex> lock(logMutex);
+
+    if(logSink)
+    {
+        logSink(msg, level);
+        return;
+    }
+
     if(logToCout)
     {
         if(level == LOG_ERRORS)
@@ -123,6 +138,18 @@ void logMessage(const std::string& msg, LOG_LEVELS level)
 
 
 
+/**
+ * @brief Returns true if messages at a level would be logged. Lets callers
+ * skip formatting messages that would be thrown away.
+ * @param level
+ */
+bool isLogLevelEnabled(LOG_LEVELS level) noexcept
+{
+    return level != LOG_NOTHING && level <= logLevel;
+}
+
+
+
 void setLogLevel(LOG_LEVELS level) noexcept
 {
     logLevel = level;
@@ -139,7 +166,7 @@ void setLogToCout(bool value) noexcept
 
 void setLogToFile(bool value) noexcept
 {
-    logToCout = value;
+    logToFile = value;
 }
 
 
@@ -8,8 +8,12 @@
 #pragma once
 
 #include <iostream>
+#include <filesystem>
+#include <functional>
+#include <string>
 
-// Logged messages must be >= log level to be printed.
+// Logged messages must be >= log level to be printed. Everything here is
+// safe to call from any thread.
 enum LOG_LEVELS
 {
     LOG_NOTHING,
@@ -21,13 +25,14 @@ enum LOG_LEVELS
 /**
  * @brief Initializes the logger with given settings, or defaults
  * @param log_level default=LOG_ERRORS
- * @param log_to_file default=true, Does not attempt to open a file when false.
+ * @param log_file_path default="", Does not attempt to open a file when
+ * empty.
  * @param log_to_cout default=true
  * @throws std::runtime_error If log file cannot be opened.
  */
 void loggerInit(
     LOG_LEVELS log_level = LOG_ERRORS,
-    bool log_to_file = true,
+    const std::filesystem::path& log_file_path = "",
     bool log_to_cout = true
 );
 
@@ -36,14 +41,31 @@ void loggerInit(
  */
 void loggerExit(void) noexcept;
 
+using LogSink = std::function<void(const std::string& msg, LOG_LEVELS level)>;
+
+/**
+ * @brief Sends messages to a function instead of cout and the logfile,
+ * e.g. a host program's own log.
+ * @param sink Called with each message logged, from whichever thread logs
+ * it, one at a time. Empty to go back to cout and the logfile.
+ */
+void setLogSink(LogSink sink);
+
 /**
- * @brief Logs a message
+ * @brief Logs a message. Safe from any thread. Before loggerInit, errors
+ * go to cerr and everything else is dropped.
  * @param msg
  * @param level
- * @throws std::runtime_error if run before loggerInit.
  */
 void logMessage(const std::string& msg, LOG_LEVELS level);
 
+/**
+ * @brief Returns true if messages at a level would be logged. Lets callers
+ * skip formatting messages that would be thrown away.
+ * @param level
+ */
+bool isLogLevelEnabled(LOG_LEVELS level) noexcept;
+
 void setLogLevel(LOG_LEVELS level) noexcept;
 
 void setLogToCout(bool value) noexcept;
@@ -6,6 +6,7 @@
  */
 
 #include "main.hpp"
+#include <cstdint>
 #include <stdexcept>
 #include <filesystem>
 #include <SDL2/SDL.h>
@@ -13,10 +14,17 @@
 #include "logger.hpp"
 #include "program.hpp"
 #include "window.hpp"
+#include "headless.hpp"
+#include "linksocket.hpp"
 
 void throwInvalidArgument(const std::string& argument);
+void handleLongArgument(const std::string& argument);
+uint64_t parseCount(const std::string& argument);
+std::filesystem::path getLogFilePath(void) noexcept;
 
 bool isMainInitialized = false;
+bool isHeadless = false;
+HeadlessOptions headlessOptions;
 #ifdef SDL_main
 int SDL_main(int argc, char** argv)
 #else
@@ -39,6 +47,13 @@ int main(int argc, char** argv)
         std::cerr << ex.what();
         exit(1);
     }
+
+    if(isHeadless)
+    {
+        int status = runHeadless(headlessOptions);
+        mainExit();
+        return status;
+    }
     
     runMainLoop();
     mainExit();
@@ -48,7 +63,8 @@ int main(int argc, char** argv)
 
 
 /**
- * @brief Initializes SDL, Logger, and the Window.
+ * @brief Initializes SDL, Logger, and the Window. Headless runs only get the
+ * Logger.
  * @throws std::runtime_error on SDL failure.
  */
 void mainInit(void)
@@ -57,9 +73,11 @@ void mainInit(void)
 
     int err;
     err = SDL_Init(
-        0
-        | SDL_INIT_VIDEO
-        | SDL_INIT_EVENTS
+        isHeadless
+        ? 0
+        : (0
+           | SDL_INIT_VIDEO
+           | SDL_INIT_EVENTS)
     );
 
     if(err != 0)
@@ -72,15 +90,15 @@ void mainInit(void)
 
     try
     {
-        loggerInit(LOG_DEBUG, true, true);
-    } catch(std::invalid_argument& ex)
+        loggerInit(LOG_DEBUG, getLogFilePath(), true);
+    } catch(std::runtime_error& ex)
     {
         std::cerr << "Couldn't initialize logger! " << ex.what() << std::endl;
         std::cerr << "Starting logger without logfile..." << std::endl;
-        loggerInit(LOG_DEBUG, false, true);
+        loggerInit(LOG_DEBUG, "", true);
     }
 
-    windowInit("IMGBE", 160, 144);
+    if(!isHeadless) { windowInit("IMGBE", 160, 144); }
 
     isMainInitialized = true;
 }
@@ -100,6 +118,33 @@ void mainExit(void) noexcept
 
 
 
+/**
+ * @brief Returns where to write the log, in the user's preferences
+ * directory if SDL can find one, otherwise the working directory.
+ */
+std::filesystem::path getLogFilePath(void) noexcept
+{
+    std::filesystem::path log_file_path;
+
+    // SDL handles creating the directory
+    char* pref_path = SDL_GetPrefPath("ImpendingMoon", "IMGBE");
+    if(pref_path != nullptr)
+    {
+        log_file_path = pref_path;
+        SDL_free(pref_path);
+    } else
+    {
+        std::error_code error;
+        log_file_path = std::filesystem::current_path(error);
+        log_file_path += std::filesystem::path::preferred_separator;
+    }
+
+    log_file_path += "imgbe.log";
+    return log_file_path;
+}
+
+
+
 /**
  * @brief Handles provided arguments. Throws exceptions for invalid arguments.
  * @param argc
@@ -110,6 +155,12 @@ void handleArguments(int argc, char** argv)
 {
     if(argc <= 1) { return; }
 
+    // Headless changes how everything else initializes, so find it first.
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::string(argv[i]) == "--headless") { isHeadless = true; }
+    }
+
     for(int i = 1; i < argc; i++)
     {
         std::string argument = argv[i];
@@ -167,6 +218,12 @@ void handleArguments(int argc, char** argv)
             break;
         }
 
+        case 't': // Threaded rendering
+        {
+            setRenderThreadEnabled(true);
+            break;
+        }
+
         case 'f': // File
         {
             if(argument.find('=') == std::string::npos)
@@ -177,14 +234,212 @@ void handleArguments(int argc, char** argv)
             std::filesystem::path file_path = getValue(argument, '=');
             
             mainInit();
-            loadEmuSystem(file_path);
+            if(isHeadless)
+            {
+                headlessOptions.romPath = file_path;
+            } else
+            {
+                loadEmuSystem(file_path);
+            }
+            break;
+        }
+
+        case '-': // Long options
+        {
+            handleLongArgument(argument);
+            break;
+        }
+
+        default:
+        {
+            throwInvalidArgument(argument);
+        }
+        }
+    }
+}
+
+
+
+/**
+ * @brief Handles --name[=value] arguments.
+ * @param argument
+ * @throws std::invalid_argument if program argument is invalid.
+ */
+void handleLongArgument(const std::string& argument)
+{
+    bool has_value = argument.find('=') != std::string::npos;
+    std::string name = has_value ? getKey(argument, '=') : argument;
+
+    if(name == "--headless")
+    {
+        return; // Handled before other arguments
+    }
+
+    if(name == "--mute")
+    {
+        setAudioEnabled(false);
+        return;
+    }
+
+    if(!has_value) { throwInvalidArgument(argument); }
+
+    if(name == "--frames")
+    {
+        headlessOptions.frames = parseCount(argument);
+    } else if(name == "--cycles")
+    {
+        headlessOptions.cycles = parseCount(argument);
+    } else if(name == "--dump-interval")
+    {
+        uint64_t interval = parseCount(argument);
+        if(interval > UINT32_MAX) { throwInvalidArgument(argument); }
+        headlessOptions.dumpInterval = static_cast<unsigned int>(interval);
+    } else if(name == "--output")
+    {
+        headlessOptions.outputDir = getValue(argument, '=');
+    } else if(name == "--audio-out")
+    {
+        headlessOptions.audioPath = getValue(argument, '=');
+    } else if(name == "--audio-rate")
+    {
+        uint64_t rate = parseCount(argument);
+        if(rate < 8000 || rate > 192000) { throwInvalidArgument(argument); }
+        headlessOptions.audioRate = static_cast<int>(rate);
+    } else if(name == "--audio-decimate")
+    {
+        uint64_t factor = parseCount(argument);
+        if(factor < 1 || factor > 8) { throwInvalidArgument(argument); }
+        headlessOptions.audioDecimation = static_cast<unsigned int>(factor);
+    } else if(name == "--input")
+    {
+        if(isHeadless)
+        {
+            headlessOptions.inputPath = getValue(argument, '=');
+        } else
+        {
+            mainInit();
+            setInputFile(getValue(argument, '='));
+        }
+    } else if(name == "--load-state")
+    {
+        if(isHeadless)
+        {
+            headlessOptions.loadStatePath = getValue(argument, '=');
+        } else
+        {
+            setStartState(getValue(argument, '='));
+        }
+    } else if(name == "--save-state")
+    {
+        if(isHeadless)
+        {
+            headlessOptions.saveStatePath = getValue(argument, '=');
+        } else
+        {
+            setExitState(getValue(argument, '='));
+        }
+    } else if(name == "--link-rom")
+    {
+        headlessOptions.linkROMPath = getValue(argument, '=');
+    } else if(name == "--link-listen" || name == "--link-connect")
+    {
+#ifdef IMGBE_LINK_SOCKET
+        std::filesystem::path socket_path = getValue(argument, '=');
+        bool listen = name == "--link-listen";
+        if(isHeadless)
+        {
+            headlessOptions.linkSocketPath = socket_path;
+            headlessOptions.linkListen = listen;
+        } else
+        {
+            setLinkSocket(socket_path, listen);
+        }
+#else
+        throwInvalidArgument(argument); // No Unix sockets
+#endif
+    } else if(name == "--link-budget")
+    {
+        uint64_t budget = parseCount(argument);
+        if(budget == 0) { throwInvalidArgument(argument); }
+        headlessOptions.linkBudget = budget;
+        setLinkBudget(budget);
+    } else if(name == "--run-ahead")
+    {
+        uint64_t frames = parseCount(argument);
+        if(frames > IMGBE_MAX_RUN_AHEAD) { throwInvalidArgument(argument); }
+        setRunAhead(static_cast<unsigned int>(frames));
+    } else if(name == "--rewind")
+    {
+        // In MiB, 0 to disable
+        uint64_t mebibytes = parseCount(argument);
+        if(mebibytes > (SIZE_MAX >> 20)) { throwInvalidArgument(argument); }
+        setRewindBudget(static_cast<size_t>(mebibytes) << 20);
+    } else if(name == "--rewind-interval")
+    {
+        uint64_t frames = parseCount(argument);
+        if(frames == 0) { throwInvalidArgument(argument); }
+        setRewindInterval(frames);
+    } else if(name == "--record")
+    {
+        if(isHeadless)
+        {
+            headlessOptions.recordPath = getValue(argument, '=');
+        } else
+        {
+            setRecordFile(getValue(argument, '='));
         }
+    } else if(name == "--latency")
+    {
+        uint64_t latency_ms = parseCount(argument);
+        if(latency_ms < 10 || latency_ms > 500)
+        {
+            throwInvalidArgument(argument);
         }
+        setAudioLatency(static_cast<int>(latency_ms));
+    } else if(name == "--speed")
+    {
+        try
+        {
+            setEmulationSpeed(std::stod(getValue(argument, '=')));
+        } catch(std::logic_error&)
+        {
+            throwInvalidArgument(argument);
+        }
+    } else
+    {
+        throwInvalidArgument(argument);
     }
 }
 
 
 
+/**
+ * @brief Parses the value of a key/value argument as an unsigned count.
+ * @param argument
+ * @throws std::invalid_argument if the value isn't a number.
+ */
+uint64_t parseCount(const std::string& argument)
+{
+    std::string value = getValue(argument, '=');
+    if(value.empty()
+       || value.find_first_not_of("0123456789") != std::string::npos)
+    {
+        throwInvalidArgument(argument);
+    }
+
+    try
+    {
+        return std::stoull(value);
+    } catch(std::logic_error&) // Too large
+    {
+        throwInvalidArgument(argument);
+    }
+
+    return 0;
+}
+
+
+
 /**
  * @brief Throws an invalid_argument exception with a formatted message
  * @param argument Argument string.
@@ -0,0 +1,278 @@
+/**
+ * @file pacer.cpp
+ * @brief Paces the main loop against the emulated frame rate
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "pacer.hpp"
+#include <algorithm>
+#include <SDL2/SDL.h>
+
+// Sleeps overshoot by up to a couple of milliseconds, so spin the rest.
+constexpr double SPIN_SECONDS = 0.002;
+// Further behind than this, give up catching up and restart pacing.
+constexpr double MAX_LAG_FRAMES = 4;
+// Largest resample ratio change dynamic rate control may apply. 0.5% is
+// well below what's audible as a pitch change.
+constexpr double MAX_RATE_ADJUST = 0.005;
+
+PacingMode pacingMode = PACING_REALTIME;
+double speedMultiplier = 1.0;
+
+AudioClockSource* audioClock = nullptr;
+double rateAdjust = 1.0;
+
+uint64_t nextDeadline = 0;
+uint64_t ticksPerSecond = 0;
+
+PacerStats stats;
+uint64_t statsWindowStart = 0;
+uint64_t statsWindowFrames = 0;
+bool newStats = false;
+
+double getFrameTicks(void) noexcept;
+void waitForDeadline(void) noexcept;
+void waitForAudio(void) noexcept;
+void updateAudioStats(void) noexcept;
+
+
+
+/**
+ * @brief Sets the pacing mode. Resets the frame deadline.
+ * @param mode
+ * @param multiplier Speed for PACING_MULTIPLIER, ignored otherwise.
+ */
+void pacerSetMode(PacingMode mode, double multiplier) noexcept
+{
+    pacingMode = mode;
+    speedMultiplier = (mode == PACING_MULTIPLIER && multiplier > 0)
+        ? multiplier
+        : 1.0;
+
+    stats.targetFPS = IMGBE_TARGET_FPS * pacerGetSpeed();
+    pacerReset();
+}
+
+
+
+PacingMode pacerGetMode(void) noexcept
+{
+    return pacingMode;
+}
+
+
+
+/**
+ * @brief Returns the current speed relative to real time, 0 if uncapped.
+ */
+double pacerGetSpeed(void) noexcept
+{
+    return (pacingMode == PACING_UNCAPPED) ? 0 : speedMultiplier;
+}
+
+
+
+/**
+ * @brief Restarts pacing from the current time, e.g. after a pause.
+ */
+void pacerReset(void) noexcept
+{
+    ticksPerSecond = SDL_GetPerformanceFrequency();
+    nextDeadline = SDL_GetPerformanceCounter()
+        + static_cast<uint64_t>(getFrameTicks());
+    statsWindowStart = SDL_GetPerformanceCounter();
+    statsWindowFrames = 0;
+}
+
+
+
+/**
+ * @brief Waits until the next frame deadline. Sleeps for most of the wait
+ * and spins for the last stretch.
+ * @param frame_emulated Whether a frame was emulated since the last call.
+ */
+void pacerWaitForNextFrame(bool frame_emulated) noexcept
+{
+    if(ticksPerSecond == 0) { pacerReset(); }
+
+    uint64_t now = SDL_GetPerformanceCounter();
+
+    if(frame_emulated)
+    {
+        stats.framesTotal++;
+        statsWindowFrames++;
+    }
+
+    if(now - statsWindowStart >= ticksPerSecond)
+    {
+        updateAudioStats();
+        double seconds = static_cast<double>(now - statsWindowStart)
+            / ticksPerSecond;
+        stats.achievedFPS = statsWindowFrames / seconds;
+        statsWindowStart = now;
+        statsWindowFrames = 0;
+        newStats = true;
+    }
+
+    if(pacingMode == PACING_UNCAPPED) { return; }
+
+    if(pacingMode == PACING_AUDIO && audioClock != nullptr)
+    {
+        waitForAudio();
+        return;
+    }
+
+    waitForDeadline();
+}
+
+
+
+/**
+ * @brief Attaches the audio output used by PACING_AUDIO. Without one, that
+ * mode falls back to real-time wall clock pacing.
+ * @param source Audio clock, or nullptr to detach.
+ */
+void pacerSetAudioClock(AudioClockSource* source) noexcept
+{
+    audioClock = source;
+    rateAdjust = 1.0;
+    updateAudioStats();
+    pacerReset();
+}
+
+
+
+/**
+ * @brief Returns the resample ratio adjustment for dynamic rate control.
+ * Above 1 means produce slightly more samples per emulated second.
+ */
+double pacerGetRateAdjust(void) noexcept
+{
+    return rateAdjust;
+}
+
+
+
+/**
+ * @brief Returns true about once per second when new stats are available.
+ */
+bool pacerHasNewStats(void) noexcept
+{
+    bool value = newStats;
+    newStats = false;
+    return value;
+}
+
+
+
+PacerStats pacerGetStats(void) noexcept
+{
+    return stats;
+}
+
+
+
+/**
+ * @brief Returns performance counter ticks per emulated frame at the
+ * current speed.
+ */
+double getFrameTicks(void) noexcept
+{
+    double speed = (pacingMode == PACING_UNCAPPED) ? 1.0 : speedMultiplier;
+    return ticksPerSecond / (IMGBE_TARGET_FPS * speed);
+}
+
+
+
+/**
+ * @brief Sleeps and spins until the next wall clock frame deadline.
+ */
+void waitForDeadline(void) noexcept
+{
+    uint64_t now = SDL_GetPerformanceCounter();
+    double frame_ticks = getFrameTicks();
+
+    // Deadlines are absolute, so sleep error never accumulates.
+    if(now > nextDeadline)
+    {
+        if(now - nextDeadline > frame_ticks) { stats.lateFrames++; }
+
+        if(now - nextDeadline > frame_ticks * MAX_LAG_FRAMES)
+        {
+            nextDeadline = now;
+        }
+    } else
+    {
+        uint64_t spin_ticks = static_cast<uint64_t>(
+            SPIN_SECONDS * ticksPerSecond
+        );
+        uint64_t remaining = nextDeadline - now;
+
+        if(remaining > spin_ticks)
+        {
+            SDL_Delay(static_cast<uint32_t>(
+                ((remaining - spin_ticks) * 1000) / ticksPerSecond
+            ));
+        }
+
+        while(SDL_GetPerformanceCounter() < nextDeadline) {}
+    }
+
+    nextDeadline += static_cast<uint64_t>(frame_ticks);
+}
+
+
+
+/**
+ * @brief Paces off the audio buffer. Emulation runs while the buffer is at
+ * or below target, and sleeps off any excess. The sound card's clock
+ * decides the speed, and dynamic rate control nudges the resample ratio so
+ * the fill level settles on target instead of drifting.
+ */
+void waitForAudio(void) noexcept
+{
+    size_t target = audioClock->getTargetFrames();
+    size_t buffered = audioClock->getBufferedFrames();
+    int sample_rate = audioClock->getSampleRate();
+
+    if(target == 0 || sample_rate <= 0) { return; }
+
+    // Low buffer: generate a little more per frame. High: a little less.
+    double error = (static_cast<double>(target) - buffered) / target;
+    error = std::clamp(error, -1.0, 1.0);
+    rateAdjust = 1.0 + (error * MAX_RATE_ADJUST);
+
+    // A whole frame of audio above target means we're running fast; sleep
+    // until the card has played the excess. Nothing is spun here.
+    size_t frame_samples = static_cast<size_t>(sample_rate / IMGBE_TARGET_FPS);
+    if(buffered > target + frame_samples)
+    {
+        size_t excess = buffered - target;
+        SDL_Delay(static_cast<uint32_t>((excess * 1000) / sample_rate));
+    }
+}
+
+
+
+void updateAudioStats(void) noexcept
+{
+    stats.audioClock = audioClock != nullptr;
+    stats.rateAdjust = rateAdjust;
+
+    if(audioClock == nullptr)
+    {
+        stats.audioBufferedFrames = 0;
+        stats.audioLatencyMs = 0;
+        stats.audioUnderruns = 0;
+        return;
+    }
+
+    stats.audioBufferedFrames = audioClock->getBufferedFrames();
+    stats.audioUnderruns = audioClock->getUnderruns();
+
+    int sample_rate = audioClock->getSampleRate();
+    stats.audioLatencyMs = (sample_rate > 0)
+        ? (stats.audioBufferedFrames * 1000.0) / sample_rate
+        : 0;
+}
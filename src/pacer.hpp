@@ -0,0 +1,100 @@
+/**
+ * @file pacer.hpp
+ * @brief Paces the main loop against the emulated frame rate
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 4194304 Hz / 70224 cycles per frame
+constexpr double IMGBE_TARGET_FPS = 4194304.0 / 70224.0;
+
+enum PacingMode
+{
+    PACING_REALTIME,   // 1x speed
+    PACING_MULTIPLIER, // Nx speed
+    PACING_UNCAPPED,   // As fast as the host allows
+    PACING_AUDIO,      // Audio buffer fill level is the master clock
+};
+
+/**
+ * @brief Audio output that can drive pacing. Implemented by the audio
+ * backend; every method must be safe to call from the main thread.
+ */
+class AudioClockSource
+{
+public:
+    virtual ~AudioClockSource() = default;
+
+    // Stereo frames queued but not yet played
+    virtual size_t getBufferedFrames(void) const noexcept = 0;
+    // Fill level the pacer aims to hold
+    virtual size_t getTargetFrames(void) const noexcept = 0;
+    virtual int getSampleRate(void) const noexcept = 0;
+    virtual uint64_t getUnderruns(void) const noexcept = 0;
+};
+
+struct PacerStats
+{
+    double targetFPS = IMGBE_TARGET_FPS;
+    double achievedFPS = 0;
+    uint64_t framesTotal = 0;
+    uint64_t lateFrames = 0; // Deadlines missed by more than a frame
+
+    // Only filled in while an audio clock is attached
+    bool audioClock = false;
+    size_t audioBufferedFrames = 0;
+    double audioLatencyMs = 0;
+    uint64_t audioUnderruns = 0;
+    double rateAdjust = 1.0;
+};
+
+/**
+ * @brief Sets the pacing mode. Resets the frame deadline.
+ * @param mode
+ * @param multiplier Speed for PACING_MULTIPLIER, ignored otherwise.
+ */
+void pacerSetMode(PacingMode mode, double multiplier = 1.0) noexcept;
+
+PacingMode pacerGetMode(void) noexcept;
+
+/**
+ * @brief Returns the current speed relative to real time, 0 if uncapped.
+ */
+double pacerGetSpeed(void) noexcept;
+
+/**
+ * @brief Attaches the audio output used by PACING_AUDIO. Without one, that
+ * mode falls back to real-time wall clock pacing.
+ * @param source Audio clock, or nullptr to detach.
+ */
+void pacerSetAudioClock(AudioClockSource* source) noexcept;
+
+/**
+ * @brief Returns the resample ratio adjustment for dynamic rate control.
+ * Above 1 means produce slightly more samples per emulated second.
+ */
+double pacerGetRateAdjust(void) noexcept;
+
+/**
+ * @brief Restarts pacing from the current time, e.g. after a pause.
+ */
+void pacerReset(void) noexcept;
+
+/**
+ * @brief Waits until the next frame deadline. Sleeps for most of the wait
+ * and spins for the last stretch.
+ * @param frame_emulated Whether a frame was emulated since the last call.
+ */
+void pacerWaitForNextFrame(bool frame_emulated) noexcept;
+
+/**
+ * @brief Returns true about once per second when new stats are available.
+ */
+bool pacerHasNewStats(void) noexcept;
+
+PacerStats pacerGetStats(void) noexcept;
@@ -6,21 +6,87 @@
  */
 
 #include "program.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include <filesystem>
 #include <cstdint>
+#include <memory>
 #include <fmt/core.h>
 #include <SDL2/SDL.h>
 #include "logger.hpp"
 #include "window.hpp"
+#include "pacer.hpp"
+#include "audio.hpp"
+#include "input.hpp"
+#include "linksocket.hpp"
 #include "main.hpp"
 #include "emu/emusys.hpp"
+#include "emu/emurewind.hpp"
 
 bool exitRequested = false;
-double frameRate = 60;
+bool renderThreadEnabled = false;
+
+// Set by events that invalidate what's on screen, e.g. expose or resize.
+bool redrawRequested = true;
+
+// While idle, wake at least this often even with no events.
+constexpr int IDLE_WAIT_TIMEOUT_MS = 500;
+
+// Speed selected with --speed, restored when fast-forward is toggled off.
+double baseSpeed = 1.0;
+// Speed the pacer is running at, which systems match frame skipping to.
+double currentSpeed = 1.0;
+
+bool audioEnabled = true;
+int audioLatencyMs = IMGBE_DEFAULT_AUDIO_LATENCY_MS;
+
+KeyboardInput keyboardInput;
+InputStream replayInput;
+bool replaying = false;
+InputStream recordedInput;
+std::filesystem::path recordFilePath = "";
+
+// Quick save slot, next to the ROM
+std::filesystem::path stateFilePath = "";
+
+// From the command line. The first ROM to run starts from one, and the
+// other is written on exit.
+std::filesystem::path startStatePath = "";
+std::filesystem::path exitStatePath = "";
+
+std::filesystem::path linkSocketPath = "";
+bool linkListen = false;
+uint64_t linkBudget = EMU_CYCLES_PER_FRAME;
+#ifdef IMGBE_LINK_SOCKET
+std::unique_ptr<LinkSocket> linkSocket;
+#endif
+
+// ROMs loaded before the main loop starts wait for it to set them up.
+bool mainLoopStarted = false;
+
+// Hold R to run backwards.
+EmuRewind rewindHistory;
+bool rewindEnabled = true;
+
+unsigned int runAheadFrames = 0;
 
 void handleEvents(void) noexcept;
+void waitForEvents(int timeout_ms) noexcept;
+void handleEvent(const SDL_Event& event) noexcept;
 void handleKeyboard(SDL_KeyboardEvent key);
+void applySpeed(double speed) noexcept;
+void applyRenderInterval(void) noexcept;
+void applyAudioSettings(void) noexcept;
+void applyInputSettings(void) noexcept;
+void saveRecording(void) noexcept;
+void saveEmuState(const std::filesystem::path& file_path) noexcept;
+void loadEmuState(const std::filesystem::path& file_path) noexcept;
+void loadStartState(void) noexcept;
+void openLinkSocket(void) noexcept;
+void runEmuFrame(void);
+void rewindEmuFrame(void);
+void pumpAudio(void) noexcept;
+void reportStats(void) noexcept;
 
 EmuSys* emuSystem = nullptr;
 
@@ -31,43 +97,121 @@ void runMainLoop(void) noexcept
 {
     logMessage("Starting main loop...", LOG_INFO);
 
+    uint64_t uploaded_frame = UINT64_MAX;
+    uint64_t last_present = 0;
+    uint64_t present_interval =
+        static_cast<uint64_t>(SDL_GetPerformanceFrequency() / IMGBE_TARGET_FPS);
+
+    if(audioEnabled)
+    {
+        audioInit(APU_DEFAULT_SAMPLE_RATE, audioLatencyMs);
+    }
+
+    applySpeed(baseSpeed);
+    mainLoopStarted = true;
+    loadStartState();
+    openLinkSocket();
+
+    bool was_idle = true;
+    bool was_playing = false;
+
     while(!exitRequested)
     {
-        uint64_t start_time = SDL_GetPerformanceCounter();
+        // Nothing to emulate: block on events instead of spinning at 60 Hz.
+        bool idle = emuSystem == nullptr || !emuSystem->isRunning()
+            || emuSystem->isPaused();
 
-        handleEvents();
+        if(idle)
+        {
+            waitForEvents(IDLE_WAIT_TIMEOUT_MS);
+        } else
+        {
+            handleEvents();
+        }
+
+        // Don't try to catch up on the time spent idle.
+        if(was_idle && !idle) { pacerReset(); }
+        was_idle = idle;
+
+        // Sound only plays at real time, fast-forward is silent.
+        bool playing = !idle && pacerGetMode() == PACING_AUDIO;
+        if(playing != was_playing) { audioSetPaused(!playing); }
+        was_playing = playing;
+
+        if(idle)
+        {
+            bool new_frame = emuSystem != nullptr
+                && emuSystem->getReadyFrame() != uploaded_frame;
 
+            if(redrawRequested || new_frame)
+            {
+                // Re-upload on redraws too, a filter change recreates the
+                // texture.
+                if(emuSystem != nullptr)
+                {
+                    uploaded_frame = emuSystem->getReadyFrame();
+                    windowUploadFrame(emuSystem->getFrameBuffer());
+                }
+
+                windowClear();
+                if(emuSystem != nullptr) { windowDrawFrame(); }
+                windowUpdate();
+                redrawRequested = false;
+            }
+            continue;
+        }
+
+        bool frame_emulated = false;
         if(emuSystem != nullptr && emuSystem->isRunning())
         {
+            frame_emulated = !emuSystem->isPaused();
+
             try
             {
-                emuSystem->runFrame();
+                runEmuFrame();
             } catch(std::exception& ex)
             {
                 logMessage(ex.what(), LOG_DEBUG);
             }
+
+            pumpAudio();
         }
 
-        windowClear();
-        windowUpdate();
-
-        uint64_t end_time = SDL_GetPerformanceCounter();
-        double seconds_elapsed =
-            (end_time - start_time)
-            / static_cast<double>(SDL_GetPerformanceFrequency());
-
-        SDL_Delay(
-            (seconds_elapsed < (1 / frameRate))
-            ?
-            static_cast<uint32_t>(
-            floor((1000 / frameRate) - seconds_elapsed))
-            :
-            0
-        );
+        // Faster than real time, only present at about the display rate.
+        uint64_t now = SDL_GetPerformanceCounter();
+        if(pacerGetSpeed() == 1.0 || now - last_present >= present_interval)
+        {
+            last_present = now;
+
+            // Only re-upload once a new frame is complete. The number is
+            // read before the buffer, so the buffer is at least that new.
+            if(emuSystem != nullptr
+               && emuSystem->getReadyFrame() != uploaded_frame)
+            {
+                uploaded_frame = emuSystem->getReadyFrame();
+                windowUploadFrame(emuSystem->getFrameBuffer());
+            }
+
+            windowClear();
+            if(emuSystem != nullptr) { windowDrawFrame(); }
+            windowUpdate();
+        }
+
+        pacerWaitForNextFrame(frame_emulated);
+
+        if(pacerHasNewStats()) { reportStats(); }
     }
 
+    audioExit();
+    saveRecording();
+
+#ifdef IMGBE_LINK_SOCKET
+    linkSocket.reset();
+#endif
+
     if(emuSystem != nullptr)
     {
+        if(!exitStatePath.empty()) { saveEmuState(exitStatePath); }
         emuSystem->dumpSystem();
         delete emuSystem;
     }
@@ -97,27 +241,68 @@ void handleEvents(void) noexcept
 
     while(SDL_PollEvent(&event))
     {
-        switch(event.type)
-        {
-        case SDL_QUIT:
-        {
-            requestExit();
-            break;
-        }
+        handleEvent(event);
+    }
+}
 
-        case SDL_DROPFILE:
-        {
-            std::filesystem::path file_path = event.drop.file;
-            loadEmuSystem(file_path);
-            break;
-        }
 
-        case SDL_KEYDOWN:
+
+/**
+ * @brief Sleeps until an event arrives or the timeout passes, then handles
+ * everything in the SDL Queue
+ * @param timeout_ms
+ */
+void waitForEvents(int timeout_ms) noexcept
+{
+    SDL_Event event;
+
+    if(SDL_WaitEventTimeout(&event, timeout_ms))
+    {
+        handleEvent(event);
+        handleEvents();
+    }
+}
+
+
+
+/**
+ * @brief Handles a single SDL_Event
+ * @param event
+ */
+void handleEvent(const SDL_Event& event) noexcept
+{
+    switch(event.type)
+    {
+    case SDL_QUIT:
+    {
+        requestExit();
+        break;
+    }
+
+    case SDL_WINDOWEVENT:
+    {
+        if(event.window.event == SDL_WINDOWEVENT_EXPOSED
+           || event.window.event == SDL_WINDOWEVENT_RESIZED
+           || event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
         {
-            handleKeyboard(event.key);
-            break;
-        }
+            redrawRequested = true;
         }
+        break;
+    }
+
+    case SDL_DROPFILE:
+    {
+        std::filesystem::path file_path = event.drop.file;
+        loadEmuSystem(file_path);
+        redrawRequested = true;
+        break;
+    }
+
+    case SDL_KEYDOWN:
+    {
+        handleKeyboard(event.key);
+        break;
+    }
     }
 }
 
@@ -168,6 +353,7 @@ void handleKeyboard(SDL_KeyboardEvent key)
                 emuSystem->resume();
                 emuSystem->runFrame();
                 emuSystem->pause();
+                if(rewindEnabled) { rewindHistory.capture(*emuSystem); }
             } catch(std::exception& ex)
             {
                 logMessage(ex.what(), LOG_ERRORS);
@@ -176,6 +362,43 @@ void handleKeyboard(SDL_KeyboardEvent key)
         break;
     }
 
+    // F6, quick save
+    case SDL_SCANCODE_F6:
+    {
+        saveEmuState(stateFilePath);
+        break;
+    }
+
+    // F7, quick load
+    case SDL_SCANCODE_F7:
+    {
+        loadEmuState(stateFilePath);
+        break;
+    }
+
+    // Tab, toggle uncapped fast-forward
+    case SDL_SCANCODE_TAB:
+    {
+        if(pacerGetMode() == PACING_UNCAPPED && baseSpeed != 0)
+        {
+            applySpeed(baseSpeed);
+        } else
+        {
+            applySpeed(0);
+        }
+        break;
+    }
+
+    // F8, cycle upscaling filter
+    case SDL_SCANCODE_F8:
+    {
+        windowSetFilter(static_cast<FilterType>(
+            (windowGetFilter() + 1) % FILTER_COUNT
+        ));
+        redrawRequested = true;
+        break;
+    }
+
     // F9, resume
     case SDL_SCANCODE_F9:
     {
@@ -192,6 +415,341 @@ void handleKeyboard(SDL_KeyboardEvent key)
 
 
 
+/**
+ * @brief Sets the emulation speed used by the main loop.
+ * @param speed 1 for real time, N for Nx, 0 for uncapped.
+ */
+void setEmulationSpeed(double speed) noexcept
+{
+    baseSpeed = (speed < 0) ? 1.0 : speed;
+    currentSpeed = baseSpeed;
+    applyRenderInterval();
+}
+
+
+
+/**
+ * @brief Switches the pacer to a speed, and matches frame skipping to it.
+ * @param speed 1 for real time, N for Nx, 0 for uncapped.
+ */
+void applySpeed(double speed) noexcept
+{
+    if(speed == 0)
+    {
+        pacerSetMode(PACING_UNCAPPED);
+        logMessage("Speed set to uncapped.", LOG_INFO);
+    } else if(speed == 1.0)
+    {
+        // The sound card's clock paces real time when there is one.
+        pacerSetMode(audioIsOpen() ? PACING_AUDIO : PACING_REALTIME);
+        logMessage("Speed set to real time.", LOG_INFO);
+    } else
+    {
+        pacerSetMode(PACING_MULTIPLIER, speed);
+        logMessage(fmt::format("Speed set to {}x.", speed), LOG_INFO);
+    }
+
+    currentSpeed = speed;
+    applyRenderInterval();
+    applyAudioSettings();
+}
+
+
+
+/**
+ * @brief Matches the emulated system's frame skipping to the current speed.
+ * Uncapped speed is matched as it is measured.
+ */
+void applyRenderInterval(void) noexcept
+{
+    if(emuSystem == nullptr) { return; }
+
+    emuSystem->setRenderInterval(
+        (currentSpeed > 1.0) ? static_cast<unsigned int>(currentSpeed) : 1
+    );
+}
+
+
+
+/**
+ * @brief Matches the emulated system's audio output to the audio device.
+ * Synthesis is skipped entirely when nothing will be played.
+ */
+void applyAudioSettings(void) noexcept
+{
+    if(emuSystem == nullptr) { return; }
+
+    bool playing = audioIsOpen() && pacerGetMode() == PACING_AUDIO;
+    if(playing && emuSystem->getAudioSampleRate() != audioGetSampleRate())
+    {
+        emuSystem->setAudioSampleRate(audioGetSampleRate());
+    }
+    emuSystem->setAudioEnabled(playing);
+}
+
+
+
+/**
+ * @brief Points the emulated system at the keyboard or a replay, and at the
+ * recording if there is one.
+ */
+void applyInputSettings(void) noexcept
+{
+    if(emuSystem == nullptr) { return; }
+
+    emuSystem->setInputSource(
+        replaying
+        ? static_cast<InputSource*>(&replayInput)
+        : static_cast<InputSource*>(&keyboardInput)
+    );
+    emuSystem->setInputRecorder(
+        recordFilePath.empty() ? nullptr : &recordedInput
+    );
+}
+
+
+
+/**
+ * @brief Writes recorded input to the record file, if recording.
+ */
+void saveRecording(void) noexcept
+{
+    if(recordFilePath.empty()) { return; }
+
+    try
+    {
+        recordedInput.saveFile(recordFilePath);
+        logMessage(fmt::format(
+            "Wrote input recording to {}.", recordFilePath.string()
+        ), LOG_INFO);
+    } catch(std::exception& ex)
+    {
+        logMessage(fmt::format(
+            "Couldn't write input recording. Error: {}", ex.what()
+        ), LOG_ERRORS);
+    }
+}
+
+
+
+/**
+ * @brief Saves the emulated system to a file, e.g. the quick save slot.
+ * @param file_path
+ */
+void saveEmuState(const std::filesystem::path& file_path) noexcept
+{
+    if(emuSystem == nullptr || !emuSystem->isRunning()) { return; }
+
+    try
+    {
+        emuSystem->saveStateFile(file_path);
+        logMessage(fmt::format(
+            "Saved state to {}.", file_path.string()
+        ), LOG_INFO);
+    } catch(std::exception& ex)
+    {
+        logMessage(fmt::format(
+            "Couldn't save state. Error: {}", ex.what()
+        ), LOG_ERRORS);
+    }
+}
+
+
+
+/**
+ * @brief Restores the emulated system from a file, e.g. the quick save
+ * slot. Recording carries on from the loaded frame, replacing what came
+ * after it.
+ * @param file_path
+ */
+void loadEmuState(const std::filesystem::path& file_path) noexcept
+{
+    if(emuSystem == nullptr || !emuSystem->isRunning()) { return; }
+
+    try
+    {
+        emuSystem->loadStateFile(file_path);
+        rewindHistory.clear();
+        redrawRequested = true;
+        logMessage(fmt::format(
+            "Loaded state from {}.", file_path.string()
+        ), LOG_INFO);
+    } catch(std::exception& ex)
+    {
+        logMessage(fmt::format(
+            "Couldn't load state. Error: {}", ex.what()
+        ), LOG_ERRORS);
+    }
+}
+
+
+
+/**
+ * @brief Restores the first ROM to run from the start state, if one was
+ * asked for. Later ROMs start fresh.
+ */
+void loadStartState(void) noexcept
+{
+    if(startStatePath.empty()) { return; }
+    if(emuSystem == nullptr || !emuSystem->isRunning()) { return; }
+
+    loadEmuState(startStatePath);
+    startStatePath.clear();
+}
+
+
+
+/**
+ * @brief Connects the socket link, if one was asked for and a ROM is
+ * running. Blocks until the other side is there.
+ */
+void openLinkSocket(void) noexcept
+{
+#ifdef IMGBE_LINK_SOCKET
+    if(linkSocketPath.empty() || linkSocket != nullptr) { return; }
+    if(emuSystem == nullptr || !emuSystem->isRunning()) { return; }
+
+    try
+    {
+        linkSocket = std::make_unique<LinkSocket>(emuSystem);
+        linkSocket->setBudget(linkBudget);
+
+        if(linkListen)
+        {
+            linkSocket->listen(linkSocketPath);
+        } else
+        {
+            linkSocket->connect(linkSocketPath);
+        }
+    } catch(std::exception& ex)
+    {
+        linkSocket.reset();
+        logMessage(ex.what(), LOG_ERRORS);
+    }
+#endif
+}
+
+
+
+/**
+ * @brief Runs a frame of the emulated system, through the link if there is
+ * one, or goes back a frame while rewinding.
+ * @throws std::runtime_error on system not running.
+ */
+void runEmuFrame(void)
+{
+#ifdef IMGBE_LINK_SOCKET
+    // The other side can't be rewound with us.
+    if(linkSocket != nullptr)
+    {
+        linkSocket->runFrame();
+        return;
+    }
+#endif
+
+    const uint8_t* keys = SDL_GetKeyboardState(nullptr);
+    if(rewindEnabled && keys[SDL_SCANCODE_R] && !emuSystem->isPaused())
+    {
+        rewindEmuFrame();
+        return;
+    }
+
+    emuSystem->runFrameAhead(runAheadFrames);
+    if(rewindEnabled) { rewindHistory.capture(*emuSystem); }
+}
+
+
+
+/**
+ * @brief Puts the emulated system back a frame, if there's history left.
+ * @throws std::runtime_error on system not running.
+ */
+void rewindEmuFrame(void)
+{
+    uint64_t frame = emuSystem->getInputFrame();
+    if(frame <= rewindHistory.getOldestFrame()) { return; }
+
+    rewindHistory.rewindTo(*emuSystem, frame - 1);
+}
+
+
+
+/**
+ * @brief Moves the last frame's audio from the emulated system to the
+ * audio device, and passes on the pacer's rate adjustment.
+ */
+void pumpAudio(void) noexcept
+{
+    if(!audioIsOpen() || pacerGetMode() != PACING_AUDIO) { return; }
+
+    constexpr size_t CHUNK_FRAMES = 1024;
+    int16_t samples[CHUNK_FRAMES * 2];
+
+    emuSystem->setAudioRateAdjust(pacerGetRateAdjust());
+
+    size_t frames;
+    while((frames = emuSystem->readAudio(samples, CHUNK_FRAMES)) != 0)
+    {
+        audioQueueFrames(samples, frames);
+    }
+}
+
+
+
+/**
+ * @brief Shows achieved vs. target frame rate, and keeps uncapped frame
+ * skipping in line with the achieved speed.
+ */
+void reportStats(void) noexcept
+{
+    PacerStats stats = pacerGetStats();
+    double speed = stats.achievedFPS / IMGBE_TARGET_FPS;
+
+    std::string title = (stats.targetFPS > 0)
+        ? fmt::format(
+            "IMGBE - {:.1f}/{:.1f} FPS ({:.0f}%)",
+            stats.achievedFPS, stats.targetFPS, speed * 100
+        )
+        : fmt::format(
+            "IMGBE - {:.1f} FPS ({:.0f}%, uncapped)",
+            stats.achievedFPS, speed * 100
+        );
+
+    if(stats.audioClock && stats.audioUnderruns != 0)
+    {
+        title += fmt::format(" - {} underruns", stats.audioUnderruns);
+    }
+
+    windowSetTitle(title);
+
+    if(isLogLevelEnabled(LOG_DEBUG))
+    {
+        logMessage(fmt::format(
+            "{} - Late frames: {}", title, stats.lateFrames
+        ), LOG_DEBUG);
+
+        if(stats.audioClock)
+        {
+            logMessage(fmt::format(
+                "Audio buffer: {} frames ({:.1f}ms) - Underruns: {} - "
+                "Rate adjust: {:.4f}",
+                stats.audioBufferedFrames, stats.audioLatencyMs,
+                stats.audioUnderruns, stats.rateAdjust
+            ), LOG_DEBUG);
+        }
+    }
+
+    // Only frames that get presented need composing.
+    if(emuSystem != nullptr && pacerGetMode() == PACING_UNCAPPED)
+    {
+        emuSystem->setRenderInterval(
+            (speed > 1.0) ? static_cast<unsigned int>(speed) : 1
+        );
+    }
+}
+
+
+
 /**
  * @brief Gets the key in a key/value pair
  * @param pair Key/Value pair
@@ -249,7 +807,178 @@ std::string getValue(const std::string& pair, char delimiter)
  */
 void createEmuSystem(void) noexcept
 {
-    if(emuSystem == nullptr) { emuSystem = new EmuSys(); }
+    if(emuSystem != nullptr) { return; }
+
+    emuSystem = new EmuSys();
+    applyRenderInterval();
+    applyAudioSettings();
+    applyInputSettings();
+
+    try
+    {
+        emuSystem->setThreadedRendering(renderThreadEnabled);
+    } catch(std::exception& ex)
+    {
+        logMessage(fmt::format(
+            "Couldn't start render thread. Error: {}", ex.what()
+        ),
+            LOG_ERRORS
+        );
+    }
+}
+
+
+
+/**
+ * @brief Sets whether new emulated systems compose frames on a render thread.
+ * @param value
+ */
+void setRenderThreadEnabled(bool value) noexcept
+{
+    renderThreadEnabled = value;
+}
+
+
+
+/**
+ * @brief Sets whether the main loop opens an audio device. Must be called
+ * before runMainLoop.
+ * @param value
+ */
+void setAudioEnabled(bool value) noexcept
+{
+    audioEnabled = value;
+}
+
+
+
+/**
+ * @brief Sets the audio latency to aim for. Must be called before
+ * runMainLoop.
+ * @param latency_ms
+ */
+void setAudioLatency(int latency_ms) noexcept
+{
+    audioLatencyMs = std::clamp(latency_ms, 10, 500);
+}
+
+
+
+/**
+ * @brief Replays joypad input from a file instead of reading the keyboard.
+ * @param file_path
+ */
+void setInputFile(const std::filesystem::path& file_path) noexcept
+{
+    try
+    {
+        replayInput.loadFile(file_path);
+        replaying = true;
+    } catch(std::exception& ex)
+    {
+        logMessage(fmt::format(
+            "Couldn't load input file. Error: {}", ex.what()
+        ), LOG_ERRORS);
+    }
+
+    applyInputSettings();
+}
+
+
+
+/**
+ * @brief Records joypad input, written to a file on exit.
+ * @param file_path
+ */
+void setRecordFile(const std::filesystem::path& file_path) noexcept
+{
+    recordFilePath = file_path;
+    applyInputSettings();
+}
+
+
+
+/**
+ * @brief Links the emulated system to another process over a Unix socket
+ * once the main loop has started and a ROM is running, whether the ROM
+ * is given at startup or loaded later.
+ * @param socket_path
+ * @param listen Listen on the path if true, connect to it if false.
+ */
+void setLinkSocket(const std::filesystem::path& socket_path, bool listen)
+    noexcept
+{
+    linkSocketPath = socket_path;
+    linkListen = listen;
+}
+
+
+
+/**
+ * @brief Restores the emulated system from a save state once the main loop
+ * has started and a ROM is running. Only the first ROM to run uses it.
+ * @param file_path
+ */
+void setStartState(const std::filesystem::path& file_path) noexcept
+{
+    startStatePath = file_path;
+}
+
+
+
+/**
+ * @brief Saves the emulated system to a file when the main loop exits.
+ * @param file_path
+ */
+void setExitState(const std::filesystem::path& file_path) noexcept
+{
+    exitStatePath = file_path;
+}
+
+
+
+/**
+ * @brief Sets how many cycles a socket link may run ahead of its peer.
+ * @param cycles
+ */
+void setLinkBudget(uint64_t cycles) noexcept
+{
+    linkBudget = cycles;
+}
+
+
+
+/**
+ * @brief Sets how much memory rewind history may use.
+ * @param bytes 0 disables rewinding.
+ */
+void setRewindBudget(size_t bytes) noexcept
+{
+    rewindEnabled = bytes != 0;
+    rewindHistory.setBudget(bytes);
+}
+
+
+
+/**
+ * @brief Sets how many frames ahead of the emulated system to show, to hide
+ * input latency. Turns off threaded rendering.
+ * @param frames 0 disables running ahead.
+ */
+void setRunAhead(unsigned int frames) noexcept
+{
+    runAheadFrames = frames;
+}
+
+
+
+/**
+ * @brief Sets how many frames apart rewind snapshots are.
+ * @param frames
+ */
+void setRewindInterval(uint64_t frames) noexcept
+{
+    rewindHistory.setInterval(frames);
 }
 
 
@@ -274,6 +1003,17 @@ void loadEmuSystem(const std::filesystem::path file_path) noexcept
         emuSystem->stop();
         emuSystem->loadROM(file_path);
         emuSystem->start();
+        rewindHistory.clear();
+        stateFilePath = std::filesystem::path(file_path)
+            .replace_extension(".state");
+
+        // A start state or link asked for before any ROM was running
+        // applies to this one.
+        if(mainLoopStarted)
+        {
+            loadStartState();
+            openLinkSocket();
+        }
     } catch(std::exception& ex)
     {
         logMessage(fmt::format(
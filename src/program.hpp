@@ -8,9 +8,13 @@
 #pragma once
 
 constexpr const char* IMGBE_VERSION_STRING = "0.2.1-devel";
+// Each frame ahead costs a whole frame of emulation.
+constexpr unsigned int IMGBE_MAX_RUN_AHEAD = 8;
 
 #include <iostream>
 #include <filesystem>
+#include <cstddef>
+#include <cstdint>
 
 /**
  * @brief Runs the main program loop until an exit is requested
@@ -22,6 +26,12 @@ void runMainLoop(void) noexcept;
  */
 void requestExit(void) noexcept;
 
+/**
+ * @brief Sets the emulation speed used by the main loop.
+ * @param speed 1 for real time, N for Nx, 0 for uncapped.
+ */
+void setEmulationSpeed(double speed) noexcept;
+
 /**
  * @brief Gets the key in a key/value pair
  * @param pair Key/Value pair
@@ -43,6 +53,86 @@ std::string getValue(const std::string& pair, char delimiter);
  */
 void createEmuSystem(void) noexcept;
 
+/**
+ * @brief Sets whether new emulated systems compose frames on a render thread.
+ * @param value
+ */
+void setRenderThreadEnabled(bool value) noexcept;
+
+/**
+ * @brief Sets whether the main loop opens an audio device. Must be called
+ * before runMainLoop.
+ * @param value
+ */
+void setAudioEnabled(bool value) noexcept;
+
+/**
+ * @brief Sets the audio latency to aim for. Must be called before
+ * runMainLoop.
+ * @param latency_ms
+ */
+void setAudioLatency(int latency_ms) noexcept;
+
+/**
+ * @brief Replays joypad input from a file instead of reading the keyboard.
+ * @param file_path
+ */
+void setInputFile(const std::filesystem::path& file_path) noexcept;
+
+/**
+ * @brief Records joypad input, written to a file on exit.
+ * @param file_path
+ */
+void setRecordFile(const std::filesystem::path& file_path) noexcept;
+
+/**
+ * @brief Links the emulated system to another process over a Unix socket
+ * once the main loop has started and a ROM is running, whether the ROM
+ * is given at startup or loaded later.
+ * @param socket_path
+ * @param listen Listen on the path if true, connect to it if false.
+ */
+void setLinkSocket(const std::filesystem::path& socket_path, bool listen)
+    noexcept;
+
+/**
+ * @brief Restores the emulated system from a save state once the main loop
+ * has started and a ROM is running. Only the first ROM to run uses it.
+ * @param file_path
+ */
+void setStartState(const std::filesystem::path& file_path) noexcept;
+
+/**
+ * @brief Saves the emulated system to a file when the main loop exits.
+ * @param file_path
+ */
+void setExitState(const std::filesystem::path& file_path) noexcept;
+
+/**
+ * @brief Sets how many cycles a socket link may run ahead of its peer.
+ * @param cycles
+ */
+void setLinkBudget(uint64_t cycles) noexcept;
+
+/**
+ * @brief Sets how much memory rewind history may use.
+ * @param bytes 0 disables rewinding.
+ */
+void setRewindBudget(size_t bytes) noexcept;
+
+/**
+ * @brief Sets how many frames ahead of the emulated system to show, to hide
+ * input latency. Turns off threaded rendering.
+ * @param frames 0 disables running ahead.
+ */
+void setRunAhead(unsigned int frames) noexcept;
+
+/**
+ * @brief Sets how many frames apart rewind snapshots are.
+ * @param frames
+ */
+void setRewindInterval(uint64_t frames) noexcept;
+
 /**
  * @brief Attempts to open a ROM in the emulated system.
  * @param file_path
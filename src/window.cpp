@@ -6,12 +6,34 @@
  */
 
 #include "window.hpp"
+#include <algorithm>
+#include <vector>
 #include <SDL2/SDL.h>
 #include "fmt/core.h"
 #include "logger.hpp"
 
 SDL_Window* window = nullptr;
 SDL_Renderer* renderer = nullptr;
+SDL_Texture* frameTexture = nullptr;
+// Frame texture size, a multiple of the LCD size when filtered
+int frameWidth = IMGBE_LCD_WIDTH;
+int frameHeight = IMGBE_LCD_HEIGHT;
+
+FilterType activeFilter = FILTER_NONE;
+// Palette-mapped frame, only used as filter input.
+std::vector<uint32_t> filterSource(IMGBE_LCD_WIDTH * IMGBE_LCD_HEIGHT);
+std::vector<uint32_t> filterHistory(IMGBE_LCD_WIDTH * IMGBE_LCD_HEIGHT);
+
+void createFrameTexture(int scale);
+
+// ARGB8888 colors for shades 0-3
+constexpr uint32_t SHADE_COLORS[4] =
+{
+    0xFFFFFFFF,
+    0xFFAAAAAA,
+    0xFF555555,
+    0xFF000000,
+};
 
 /**
  * @brief Creates the window and renderer.
@@ -64,6 +86,43 @@ void windowInit(
         IMGBE_WIN_MIN_WIDTH,
         IMGBE_WIN_MIN_HEIGHT
     );
+
+    // Nearest-neighbour scaling. windowDrawFrame locks the frame to whole
+    // multiples of its size and letterboxes whatever space is left over.
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+
+    createFrameTexture(getFilterScale(activeFilter));
+}
+
+
+
+/**
+ * @brief (Re)creates the streaming frame texture at a multiple of LCD size.
+ * The old texture is kept if it throws.
+ * @param scale
+ * @throws std::runtime_error on SDL failure.
+ */
+void createFrameTexture(int scale)
+{
+    SDL_Texture* texture = SDL_CreateTexture(
+        renderer,
+        SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_STREAMING,
+        IMGBE_LCD_WIDTH * scale,
+        IMGBE_LCD_HEIGHT * scale
+    );
+
+    if(texture == nullptr)
+    {
+        throw std::runtime_error(fmt::format(
+            "Cannot create frame texture! Error: {}", SDL_GetError()
+        ));
+    }
+
+    if(frameTexture != nullptr) { SDL_DestroyTexture(frameTexture); }
+    frameTexture = texture;
+    frameWidth = IMGBE_LCD_WIDTH * scale;
+    frameHeight = IMGBE_LCD_HEIGHT * scale;
 }
 
 
@@ -73,6 +132,7 @@ void windowInit(
  */
 void windowExit(void) noexcept
 {
+    if(frameTexture != nullptr) { SDL_DestroyTexture(frameTexture); }
     if(window != nullptr) { SDL_DestroyWindow(window); }
     if(renderer != nullptr) { SDL_DestroyRenderer(renderer); }
 }
@@ -90,6 +150,146 @@ void windowClear(void) noexcept
 
 
 
+/**
+ * @brief Uploads a frame of shades (0-3) to the frame texture.
+ * @param shades IMGBE_LCD_WIDTH * IMGBE_LCD_HEIGHT bytes, row-major.
+ */
+void windowUploadFrame(const uint8_t* shades) noexcept
+{
+    void* pixels;
+    int pitch;
+
+    if(activeFilter != FILTER_NONE)
+    {
+        for(size_t i = 0; i < filterSource.size(); i++)
+        {
+            filterSource[i] = SHADE_COLORS[shades[i] & 0b11];
+        }
+    }
+
+    if(SDL_LockTexture(frameTexture, nullptr, &pixels, &pitch) != 0)
+    {
+        return;
+    }
+
+    // Filters write their output straight into texture memory.
+    if(activeFilter != FILTER_NONE)
+    {
+        applyFilter(
+            activeFilter,
+            filterSource.data(),
+            IMGBE_LCD_WIDTH,
+            IMGBE_LCD_HEIGHT,
+            static_cast<uint32_t*>(pixels),
+            pitch,
+            filterHistory.data()
+        );
+
+        SDL_UnlockTexture(frameTexture);
+        return;
+    }
+
+    // Unfiltered, the palette lookup is the only pass over the frame.
+    for(int y = 0; y < IMGBE_LCD_HEIGHT; y++)
+    {
+        uint32_t* row = reinterpret_cast<uint32_t*>(
+            static_cast<uint8_t*>(pixels) + (y * pitch)
+        );
+        const uint8_t* source = shades + (y * IMGBE_LCD_WIDTH);
+
+        for(int x = 0; x < IMGBE_LCD_WIDTH; x++)
+        {
+            row[x] = SHADE_COLORS[source[x] & 0b11];
+        }
+    }
+
+    SDL_UnlockTexture(frameTexture);
+}
+
+
+
+/**
+ * @brief Selects the upscaling filter applied to uploaded frames.
+ * @param type
+ */
+void windowSetFilter(FilterType type) noexcept
+{
+    if(type == activeFilter) { return; }
+
+    try
+    {
+        createFrameTexture(getFilterScale(type));
+    } catch(std::runtime_error& ex)
+    {
+        logMessage(ex.what(), LOG_ERRORS);
+        return;
+    }
+
+    activeFilter = type;
+    std::fill(filterHistory.begin(), filterHistory.end(), SHADE_COLORS[0]);
+    logMessage(fmt::format(
+        "Filter set to {}.", getFilterName(type)
+    ), LOG_INFO);
+}
+
+
+
+FilterType windowGetFilter(void) noexcept
+{
+    return activeFilter;
+}
+
+
+
+/**
+ * @brief Draws the frame texture at the largest whole multiple of its size
+ * that fits the window, centered. Windows too small for a filtered frame
+ * get whole multiples of the LCD size instead.
+ */
+void windowDrawFrame(void) noexcept
+{
+    int output_width, output_height;
+    if(SDL_GetRendererOutputSize(renderer, &output_width, &output_height) != 0)
+    {
+        return;
+    }
+
+    // Filtered pixels are only kept if nothing resamples them.
+    int scale = std::min(
+        output_width / frameWidth, output_height / frameHeight
+    );
+    int width = frameWidth * scale;
+    int height = frameHeight * scale;
+
+    if(scale == 0)
+    {
+        scale = std::max(1, std::min(
+            output_width / IMGBE_LCD_WIDTH, output_height / IMGBE_LCD_HEIGHT
+        ));
+        width = IMGBE_LCD_WIDTH * scale;
+        height = IMGBE_LCD_HEIGHT * scale;
+    }
+
+    SDL_Rect destination = {
+        (output_width - width) / 2, (output_height - height) / 2,
+        width, height
+    };
+    SDL_RenderCopy(renderer, frameTexture, nullptr, &destination);
+}
+
+
+
+/**
+ * @brief Sets the window title.
+ * @param title
+ */
+void windowSetTitle(const std::string& title) noexcept
+{
+    if(window != nullptr) { SDL_SetWindowTitle(window, title.c_str()); }
+}
+
+
+
 /**
  * @brief Updates the window with any changes.
  */
@@ -8,10 +8,15 @@
 #pragma once
 
 #include <iostream>
+#include <cstdint>
+#include "filters.hpp"
 
 constexpr int IMGBE_WIN_MIN_WIDTH = 160;
 constexpr int IMGBE_WIN_MIN_HEIGHT = 144;
 
+constexpr int IMGBE_LCD_WIDTH = 160;
+constexpr int IMGBE_LCD_HEIGHT = 144;
+
 /**
  * @brief Creates the window and renderer.
  * @param title Window title
@@ -36,6 +41,31 @@ void windowExit(void) noexcept;
  */
 void windowClear(void) noexcept;
 
+/**
+ * @brief Uploads a frame of shades (0-3) to the frame texture.
+ * @param shades IMGBE_LCD_WIDTH * IMGBE_LCD_HEIGHT bytes, row-major.
+ */
+void windowUploadFrame(const uint8_t* shades) noexcept;
+
+/**
+ * @brief Selects the upscaling filter applied to uploaded frames.
+ * @param type
+ */
+void windowSetFilter(FilterType type) noexcept;
+
+FilterType windowGetFilter(void) noexcept;
+
+/**
+ * @brief Draws the frame texture, scaled to the window.
+ */
+void windowDrawFrame(void) noexcept;
+
+/**
+ * @brief Sets the window title.
+ * @param title
+ */
+void windowSetTitle(const std::string& title) noexcept;
+
 /**
  * @brief Updates the window with any changes.
  */
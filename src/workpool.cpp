@@ -0,0 +1,143 @@
+/**
+ * @file workpool.cpp
+ * @brief Runs a set of independent tasks on a work-stealing thread pool
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#include "workpool.hpp"
+#include <algorithm>
+#include <system_error>
+#include <thread>
+
+/**
+ * @param thread_count Threads to run on, counting the caller's. 0 for one
+ * per core.
+ */
+WorkPool::WorkPool(unsigned int thread_count)
+{
+    if(thread_count == 0)
+    {
+        thread_count = std::thread::hardware_concurrency();
+    }
+    threadCount = std::max(thread_count, 1u);
+
+    for(unsigned int thread = 0; thread < threadCount; thread++)
+    {
+        queues.push_back(std::make_unique<Queue>());
+    }
+}
+
+WorkPool::~WorkPool()
+{}
+
+
+
+unsigned int WorkPool::getThreadCount(void) const noexcept
+{
+    return threadCount;
+}
+
+
+
+/**
+ * @brief Runs task(i) for every i below count, and returns once all have.
+ * Lower indices start first, so give the longest tasks the lowest.
+ * @param count
+ * @param task Called from any of the pool's threads.
+ * @throws Whatever the first task to throw threw, once the rest finish.
+ */
+void WorkPool::run(size_t count, const Task& task)
+{
+    error = nullptr;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        queues[i % threadCount]->tasks.push_back(i);
+    }
+
+    // No more threads than tasks, or the extras would only steal.
+    unsigned int thread_count = static_cast<unsigned int>(
+        std::min<size_t>(threadCount, std::max<size_t>(count, 1))
+    );
+
+    std::vector<std::thread> threads;
+    try
+    {
+        threads.reserve(thread_count - 1);
+        for(unsigned int thread = 1; thread < thread_count; thread++)
+        {
+            threads.emplace_back(
+                &WorkPool::work, this, thread, std::cref(task)
+            );
+        }
+    } catch(std::system_error&)
+    {
+        // Run on the threads that did start. They steal the queues that
+        // have no thread of their own.
+    }
+
+    work(0, task);
+
+    for(std::thread& thread : threads) { thread.join(); }
+
+    if(error != nullptr) { std::rethrow_exception(error); }
+}
+
+
+
+/**
+ * @brief Takes the next task from the front of a thread's own queue.
+ */
+bool WorkPool::take(unsigned int thread, size_t& index) noexcept
+{
+    Queue& queue = *queues[thread];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if(queue.tasks.empty()) { return false; }
+    index = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+
+
+/**
+ * @brief Takes a task from the back of another thread's queue, trying each
+ * in turn from the next thread on. Tasks are never added during a run, so
+ * finding every queue empty means there's nothing left to start.
+ */
+bool WorkPool::steal(unsigned int thread, size_t& index) noexcept
+{
+    for(unsigned int offset = 1; offset < threadCount; offset++)
+    {
+        Queue& queue = *queues[(thread + offset) % threadCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if(queue.tasks.empty()) { continue; }
+        index = queue.tasks.back();
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    return false;
+}
+
+
+
+void WorkPool::work(unsigned int thread, const Task& task) noexcept
+{
+    size_t index;
+
+    while(take(thread, index) || steal(thread, index))
+    {
+        try
+        {
+            task(index);
+        } catch(...)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if(error == nullptr) { error = std::current_exception(); }
+        }
+    }
+}
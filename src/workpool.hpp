@@ -0,0 +1,70 @@
+/**
+ * @file workpool.hpp
+ * @brief Runs a set of independent tasks on a work-stealing thread pool
+ * @author ImpendingMoon
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Runs a fixed set of tasks that take very different times, e.g.
+ * whole emulator runs, across threads.
+ *
+ * Tasks are dealt round robin to one queue per thread. Each thread takes
+ * from the front of its own queue, and one that runs dry steals from the
+ * back of another's, so no thread sits idle while work is left. Queues are
+ * only shared when stealing, so threads rarely wait on each other.
+ */
+class WorkPool
+{
+public:
+    using Task = std::function<void(size_t index)>;
+
+    /**
+     * @param thread_count Threads to run on, counting the caller's. 0 for
+     * one per core.
+     */
+    explicit WorkPool(unsigned int thread_count = 0);
+    ~WorkPool();
+
+    WorkPool(const WorkPool&) = delete;
+    WorkPool& operator=(const WorkPool&) = delete;
+
+    unsigned int getThreadCount(void) const noexcept;
+
+    /**
+     * @brief Runs task(i) for every i below count, and returns once all
+     * have. Lower indices start first, so give the longest tasks the
+     * lowest.
+     * @param count
+     * @param task Called from any of the pool's threads.
+     * @throws Whatever the first task to throw threw, once the rest finish.
+     */
+    void run(size_t count, const Task& task);
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    unsigned int threadCount;
+    std::vector<std::unique_ptr<Queue>> queues;
+
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    bool take(unsigned int thread, size_t& index) noexcept;
+    bool steal(unsigned int thread, size_t& index) noexcept;
+    void work(unsigned int thread, const Task& task) noexcept;
+};